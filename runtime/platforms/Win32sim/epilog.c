@@ -7,8 +7,14 @@
 
 void initActors()
 {
+#ifdef PCR_STATIC_ACTOR_GRAPH
+  //Actor instances and end points are initialized at compile time.
+  pcr_setEndPointTable(_gen_endPoints, sizeof(_gen_endPoints) / sizeof(_gen_endPoints[0]));
+  _Main_init(&_gen_mainActor);
+#else
   static _Main	mainActor;
 
   _Main_constructor(&mainActor, NULL);
+#endif
 }
 
@@ -6,13 +6,54 @@
  */
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Constant data ('static const' objects) is declared with 'PCR_CONST_DATA', which
+ * flash based platforms may define to place it in ROM. For example:
+ *   #define PCR_CONST_DATA __attribute__((section(".rodata")))
+ * The simulator keeps the compiler default.
+ */
+#define PCR_CONST_DATA
+
+typedef unsigned short MessageSlot;
+
+typedef struct {
+  void* inputPtr;
+  int   priority;
+  int   pendingOffset;
+}PcrInputInfo;
 
 typedef struct {
   void *actorPtr;
   void *inputPtr;
-}MessageSlot;
+  int  priority;
+  int  *pendingIdx;
+}PcrEndPoint;
+
+typedef struct {
+  const void* address;
+  const char* name;
+}PcrTraceSymbol;
+
+typedef struct {
+  const char*         name;
+  unsigned            calls;
+  unsigned long long  totalCycles;
+  unsigned long long  maxCycles;
+}PcrProfileEntry;
 
-void postMessage (const MessageSlot* address, const void* params, size_t paramsSize);
+MessageSlot pcr_registerActor (void* actorPtr, const PcrInputInfo* inputs, int count);
+void pcr_setEndPointTable (const PcrEndPoint* table, int count);
+void postMessage (MessageSlot endPoint, const void* params, size_t paramsSize);
+void* pcr_reserveBlockMessage (MessageSlot endPoint, size_t paramsSize);
+void pcr_commitBlockMessage (MessageSlot endPoint, void* params);
+void* pcr_reserveMessage (MessageSlot endPoint, size_t paramsSize);
+void pcr_commitMessage (void* params);
+void pcr_indexOutOfRange (int index, int size);
+void pcr_profileExit (PcrProfileEntry* table, int index, unsigned long long start);
+unsigned long long system_cycles ();
 void initPcr ();
 void runScheduler ();
 
@@ -8,8 +8,20 @@
 extern "C" {
 #endif
 
+    /// <summary>
+    /// Creates and initializes the actors of a simulated device. The simulator may run
+    /// several device instances in a process, so it is called once per instance, and
+    /// shall create new actor instances on each call.
+    /// </summary>
     void initActors();
 
+    /// <summary>
+    /// Maximum number of device instances the code supports in one process. Code which
+    /// allocates its actors in 'initActors', and keeps no other state, supports any 
+    /// number. Code which keeps its state in static variables shall return 1.
+    /// </summary>
+    int maxSimInstances();
+
 #ifdef __cplusplus
 }
 #endif
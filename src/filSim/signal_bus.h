@@ -0,0 +1,60 @@
+/// <summary>
+/// Layout of the shared memory signal bus of the simulator.
+/// External test rigs map the same file to drive the input signals and read the
+/// output signals, without text parsing or pipe overhead.
+/// </summary>
+/// <remarks>
+/// The bus is enabled with 'FILS_SIGNAL_BUS=<file>' environment variable. On Linux,
+/// a file in '/dev/shm' gives a pure shared memory region.
+/// Protocol:
+///	- To change an input, the rig pushes a 'SignalChange' into 'inputChanges' ring.
+///	- On each output write, the simulator updates 'outputs' and pushes a 'SignalChange'
+///	  into 'outputChanges' ring. If the ring is full, the notification is lost (the value
+///	  in 'outputs' is still updated) and 'outputOverruns' is incremented.
+/// Rings are single producer / single consumer. Indexes are free running counters: the
+/// ring is empty if 'head == tail', and full if 'tail - head == SIGNAL_BUS_RING_SIZE'.
+/// The producer writes the event before publishing 'tail' (release), and the consumer
+/// reads 'tail' (acquire) before reading the events.
+/// </remarks>
+#pragma once
+
+#define SIGNAL_BUS_MAGIC		0x53424C46		//'FLBS'
+#define SIGNAL_BUS_VERSION		2
+#define SIGNAL_BUS_PINS			4096
+#define SIGNAL_BUS_RING_SIZE	4096			//Must be a power of 2.
+
+/// <summary>
+/// Signal value change notification.
+/// </summary>
+typedef struct
+{
+    int		address;
+    int		value;
+}SignalChange;
+
+/// <summary>
+/// Single producer / single consumer ring of signal changes.
+/// </summary>
+typedef struct
+{
+    volatile unsigned	head;		//Written by the consumer.
+    volatile unsigned	tail;		//Written by the producer.
+    SignalChange		events[SIGNAL_BUS_RING_SIZE];
+}SignalRing;
+
+/// <summary>
+/// Shared memory region contents.
+/// </summary>
+typedef struct
+{
+    volatile unsigned	magic;			//Written last, once the region is initialized.
+    unsigned			version;
+    unsigned			pinCount;
+    unsigned			ringSize;
+    volatile unsigned	outputOverruns;
+
+    volatile int		outputs[SIGNAL_BUS_PINS];		//Written by the simulator.
+
+    SignalRing			inputChanges;		//Rig -> simulator.
+    SignalRing			outputChanges;		//Simulator -> rig.
+}SignalBus;
@@ -50,6 +50,7 @@ extern "C" {
     void scheduleTimer(TimerInfo* timer);
     void postMessage(const SystemMsgHeader* msg);
     void outputSignalWrite(int address, int value);
+    void inputSignalConnect(int signalIndex, ActorInputAddress endPoint, int conflate);
 
 
 #ifdef __cplusplus
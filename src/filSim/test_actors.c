@@ -3,6 +3,7 @@
 //***
 
 #include <stdio.h>
+#include <stdlib.h>
 typedef unsigned char bool;
 static const bool true = 1;
 static const bool false = 0;
@@ -101,12 +102,19 @@ static void MainActor_constructor(MainActor* _gen_actor) {
 
 //************ Epilog
 
-MainActor mainActor;
-
 //ADDED***
+//'initActors' is called once per simulated device instance.
 void initActors()
 {
-    MainActor_constructor(&mainActor);
+    MainActor* mainActor = (MainActor*)calloc(1, sizeof(MainActor));
+
+    MainActor_constructor(mainActor);
+}
+
+//Actors are allocated by 'initActors', and have no static state.
+int maxSimInstances()
+{
+    return 1000000;
 }
 //***
 
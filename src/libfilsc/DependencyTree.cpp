@@ -155,6 +155,18 @@ std::string ModuleNode::getCFilePath()const
     return result.u8string();
 }
 
+/// <summary>
+/// Gets the path where to store the memory layout report.
+/// </summary>
+/// <returns></returns>
+std::string ModuleNode::getLayoutReportPath()const
+{
+    fs::path	base(getIntermediateDir());
+    auto		result = base / (this->name() + ".layout.txt");
+
+    return result.u8string();
+}
+
 /// <summary>
 /// Gets the path where intermeadiate products of the compilation process
 /// are stored.
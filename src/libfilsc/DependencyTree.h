@@ -46,6 +46,7 @@ public:
     const std::string&	path()const { return m_path; }
     std::string			getCompiledPath()const;
     std::string			getCFilePath()const;
+    std::string			getLayoutReportPath()const;
     std::string			getIntermediateDir()const;
     std::string			getBinDir()const;
 
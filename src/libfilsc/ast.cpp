@@ -256,6 +256,34 @@ Ref<AstNode> astCreateIf(ScriptPosition pos,
     return result;
 }
 
+/// <summary>
+/// Creates a 'select' expression node. Cases are added later as children.
+/// </summary>
+Ref<AstNode> astCreateSelect(ScriptPosition pos, Ref<AstNode> selector)
+{
+    auto result = AstNode::create(AST_SELECT, pos, "", "");
+
+    result->addChild(selector);
+    return result;
+}
+
+/// <summary>
+/// Creates a case of a 'select' expression.
+/// </summary>
+/// <param name="pos"></param>
+/// <param name="values">List of case values. A null reference for the default ('else') case.</param>
+/// <param name="body"></param>
+/// <returns></returns>
+Ref<AstNode> astCreateCase(ScriptPosition pos, Ref<AstNode> values, Ref<AstNode> body)
+{
+    auto result = AstNode::create(AST_CASE, pos, "", "");
+
+    result->addChild(values);
+    result->addChild(body);
+
+    return result;
+}
+
 Ref<AstNode> astCreateFor(ScriptPosition pos,
     Ref<AstNode> initSt,
     Ref<AstNode> condition,
@@ -272,6 +300,13 @@ Ref<AstNode> astCreateFor(ScriptPosition pos,
     return result;
 }
 
+/// <summary>
+/// Creates a 'for each' loop node.
+/// </summary>
+/// <remarks>
+/// The sequence expression is the first child, so it is type checked before the item
+/// declaration, which takes its type from it.
+/// </remarks>
 Ref<AstNode> astCreateForEach(ScriptPosition pos,
     Ref<AstNode> itemDeclaration,
     Ref<AstNode> sequenceExpr,
@@ -279,8 +314,8 @@ Ref<AstNode> astCreateForEach(ScriptPosition pos,
 {
     auto result = AstNode::create(AST_FOR_EACH, pos, "", "");
 
-    result->addChild(itemDeclaration);
     result->addChild(sequenceExpr);
+    result->addChild(itemDeclaration);
     result->addChild(body);
 
     return result;
@@ -376,9 +411,9 @@ Ref<AstNode> astCreateActor(ScriptPosition pos, const std::string& name)
     return AstNode::create(AST_ACTOR, pos, name);
 }
 
-Ref<AstNode> astCreateInputMsg(ScriptPosition pos, const std::string& name)
+Ref<AstNode> astCreateInputMsg(ScriptPosition pos, const std::string& name, int priority)
 {
-    return AstNode::create(AST_INPUT, pos, name);
+    return AstNode::create(AST_INPUT, pos, name, to_string(priority));
 }
 
 
@@ -488,6 +523,52 @@ Ref<AstNode> astCreateGetAddress(ScriptPosition pos, Ref<AstNode> rExpr)
     return result;
 }
 
+/// <summary>
+/// Creates a generic (template) definition node.
+/// </summary>
+/// <param name="pos"></param>
+/// <param name="name">Template name. Is also the name of the wrapped definition.</param>
+/// <param name="params">List of compile time parameters (declaration nodes). Type
+/// parameters have no type descriptor.</param>
+/// <param name="definition">Function or actor definition.</param>
+/// <returns></returns>
+Ref<AstNode> astCreateGeneric(ScriptPosition pos,
+    const std::string& name,
+    Ref<AstNode> params,
+    Ref<AstNode> definition)
+{
+    auto result = AstNode::create(AST_GENERIC, pos, name, "");
+
+    result->addChild(params);
+    result->addChild(definition);
+    result->addChild(AstNode::create(AST_LIST, pos));      //Instances.
+    result->addChild(AstNode::create(AST_LIST, pos));      //Instance keys.
+    return result;
+}
+
+/// <summary>
+/// Performs a deep copy of an AST subtree.
+/// Data types and references are not copied, so it is only useful before semantic analysis.
+/// </summary>
+/// <param name="node"></param>
+/// <returns></returns>
+Ref<AstNode> astClone(Ref<AstNode> node)
+{
+    if (node.isNull())
+        return node;
+
+    auto result = AstNode::create(node->getType(),
+        node->position(),
+        node->getName(),
+        node->getValue(),
+        node->getFlags());
+
+    for (auto child : node->children())
+        result->addChild(astClone(child));
+
+    return result;
+}
+
 /// <summary>
 /// Gathers all nodes referenced from the AST tree.
 /// </summary>
@@ -502,10 +583,10 @@ static void astGatherAll(AstNode* root, set<AstNode*>& nodes)
         //Visit its data type.
         astGatherAll(root->getDataType(), nodes);
 
-        //Visit children
+        //Visit children. Generic definitions are only reached through their instances.
         for (auto child : root->children())
         {
-            if (child.notNull())
+            if (child.notNull() && child->getType() != AST_GENERIC)
                 astGatherAll(child.getPointer(), nodes);
         }
     }
@@ -679,6 +760,9 @@ std::string astTypeToString(AstNodeTypes type)
         types[AST_IMPORT] = "AST_IMPORT";
         types[AST_GET_ADDRESS] = "AST_GET_ADDRESS";
         types[AST_ARRAY_DECL] = "AST_ARRAY_DECL";
+        types[AST_GENERIC] = "AST_GENERIC";
+        types[AST_SELECT] = "AST_SELECT";
+        types[AST_CASE] = "AST_CASE";
         //types[AST_TYPES_COUNT] = "AST_TYPES_COUNT";
 
         assert(types.size() == AST_TYPES_COUNT);
@@ -743,6 +827,9 @@ AstNodeTypes astTypeFromString(const std::string& str)
         types["AST_IMPORT"] = AST_IMPORT;
         types["AST_GET_ADDRESS"] = AST_GET_ADDRESS;
         types["AST_ARRAY_DECL"] = AST_ARRAY_DECL;
+        types["AST_GENERIC"] = AST_GENERIC;
+        types["AST_SELECT"] = AST_SELECT;
+        types["AST_CASE"] = AST_CASE;
         //types[AST_TYPES_COUNT"] = AST_TYPES_COUNT";
 
         assert(types.size() == AST_TYPES_COUNT);
@@ -787,6 +874,48 @@ AstNode* astGetCPointer()
     return node.getPointer();
 }
 
+/// <summary>
+/// Gets the names of the default types. Integer types have a C counterpart in 'stdint.h'.
+/// 'int32' is a synonym of 'int'.
+/// </summary>
+const std::vector<std::string>& astGetDefaultTypeNames()
+{
+    static const vector<string> names = {
+        "int", "bool", "Cpointer",
+        "int8", "int16", "int32", "uint8", "uint16", "uint32"
+    };
+
+    return names;
+}
+
+/// <summary>
+/// Gets a default type by its name.
+/// </summary>
+/// <returns>The type node, or 'nullptr' if it is not a default type name.</returns>
+AstNode* astGetDefaultType(const std::string& name)
+{
+    static map<string, Ref<AstNode>> sizedInts;
+
+    if (name == "int" || name == "int32")
+        return astGetInt();
+    else if (name == "bool")
+        return astGetBool();
+    else if (name == "Cpointer")
+        return astGetCPointer();
+
+    auto& names = astGetDefaultTypeNames();
+
+    if (find(names.begin(), names.end(), name) == names.end())
+        return nullptr;
+
+    auto& node = sizedInts[name];
+
+    if (node.isNull())
+        node = AstNode::create(AST_DEFAULT_TYPE, ScriptPosition(), name);
+
+    return node.getPointer();
+}
+
 //String representation of a tuple type, for debug purposes
 static string astTupleTypeToString(AstNode* node)
 {
@@ -850,6 +979,9 @@ std::string astTypeToString(AstNode* node)
     case AST_OUTPUT:
         return "output" + astTypeToString(astGetParameters(node));
 
+    case AST_ARRAY_DECL:
+        return astTypeToString(astGetArrayItemType(node)) + "[" + node->child(1)->getValue() + "]";
+
     default:
         return "";
     }
@@ -928,6 +1060,20 @@ AstNode* astGetFunctionBody(AstNode* node)
     }
 }
 
+/// <summary>
+/// Gets the dispatch priority of an input message. 
+/// Unnamed inputs, and inputs without a priority mark, have priority zero (the lowest).
+/// </summary>
+/// <param name="node"></param>
+/// <returns></returns>
+int astGetInputPriority(const AstNode* node)
+{
+    if (node->getType() != AST_INPUT || node->getValue().empty())
+        return 0;
+    else
+        return stoi(node->getValue());
+}
+
 /// <summary>
 /// Checks if the node represents a tuple data type.
 /// </summary>
@@ -962,10 +1108,37 @@ bool astIsBoolType(const AstNode* type)
     return type->getType() == AST_DEFAULT_TYPE && type->getName() == "bool";
 }
 
-/// <summary>Checks if a type is integer</summary>
+/// <summary>Checks if a type is integer, of any size</summary>
 bool astIsIntType(const AstNode* type)
 {
-    return type->getType() == AST_DEFAULT_TYPE && type->getName() == "int";
+    return astGetIntBits(type) > 0;
+}
+
+/// <summary>Checks if a type is an unsigned integer</summary>
+bool astIsUnsignedType(const AstNode* type)
+{
+    return astIsIntType(type) && type->getName()[0] == 'u';
+}
+
+/// <summary>
+/// Gets the size, in bits, of an integer type.
+/// </summary>
+/// <returns>Size in bits, or zero if it is not an integer type.</returns>
+int astGetIntBits(const AstNode* type)
+{
+    if (type->getType() != AST_DEFAULT_TYPE)
+        return 0;
+
+    const string& name = type->getName();
+
+    if (name == "int" || name == "int32" || name == "uint32")
+        return 32;
+    else if (name == "int16" || name == "uint16")
+        return 16;
+    else if (name == "int8" || name == "uint8")
+        return 8;
+    else
+        return 0;
 }
 
 /// <summary>Checks if a type is a 'C' pointer</summary>
@@ -974,6 +1147,28 @@ bool astIsCpointer(const AstNode* type)
     return type->getType() == AST_DEFAULT_TYPE && type->getName() == "Cpointer";
 }
 
+/// <summary>Checks if a type is an array</summary>
+bool astIsArrayType(const AstNode* type)
+{
+    return type->getType() == AST_ARRAY_DECL;
+}
+
+/// <summary>
+/// Gets the number of elements of an array type.
+/// </summary>
+int astGetArraySize(const AstNode* type)
+{
+    assert(astIsArrayType(type));
+    return (int)stoll(type->child(1)->getValue(), nullptr, 0);
+}
+
+/// <summary>Gets the data type of the elements of an array type.</summary>
+AstNode* astGetArrayItemType(const AstNode* type)
+{
+    assert(astIsArrayType(type));
+    return type->child(0)->getDataType();
+}
+
 
 /// <summary>Checks if a type is boolean</summary>
 bool astIsVoidType(const AstNode* type)
@@ -55,6 +55,9 @@ enum AstNodeTypes
     , AST_IMPORT
     , AST_GET_ADDRESS
     , AST_ARRAY_DECL
+    , AST_GENERIC
+    , AST_SELECT
+    , AST_CASE
 
     //Remember to add new entries to 'astTypeToString' and 'astTypeFromString' functions!
 
@@ -73,8 +76,15 @@ enum AstFlags
     ASTF_ACTOR_MEMBER = 8,
     ASTF_EXTERN_C = 16,
     ASTF_TYPECHECKED = 32,
+    ASTF_CONFLATE = 64,
 };
 
+/// <summary>
+/// Highest priority which can be assigned to an input message.
+/// The runtime must provide one message queue for each level, from 0 to this value.
+/// </summary>
+const int AST_MAX_INPUT_PRIORITY = 3;
+
 class AstNode;
 typedef std::vector <Ref<AstNode> >				AstNodeList;
 typedef std::map<std::string, Ref<AstNode>>		AstStr2NodesMap;
@@ -86,17 +96,25 @@ AstNode*		astGetVoid();
 AstNode*		astGetBool();
 AstNode*		astGetInt();
 AstNode*		astGetCPointer();
+AstNode*		astGetDefaultType(const std::string& name);
+const std::vector<std::string>& astGetDefaultTypeNames();
 
 std::string		astTypeToString(AstNode* typeNode);
 AstNode*		astGetParameters(AstNode* node);
 AstNode*		astGetReturnType(AstNode* node);
 AstNode*		astGetFunctionBody(AstNode* node);
+int				astGetInputPriority(const AstNode* node);
 
 bool			astIsTupleType(const AstNode* node);
 bool			astCanBeCalled(const AstNode* node);
 bool			astIsBoolType(const AstNode* type);
 bool			astIsIntType(const AstNode* type);
+bool			astIsUnsignedType(const AstNode* type);
+int				astGetIntBits(const AstNode* type);
 bool			astIsCpointer(const AstNode* type);
+bool			astIsArrayType(const AstNode* type);
+int				astGetArraySize(const AstNode* type);
+AstNode*		astGetArrayItemType(const AstNode* type);
 bool			astIsVoidType(const AstNode* type);
 bool            astIsDataType(const AstNode* node);
 
@@ -136,6 +154,8 @@ Ref<AstNode> astCreateIf(ScriptPosition pos,
     Ref<AstNode> condition,
     Ref<AstNode> thenSt,
     Ref<AstNode> elseSt);
+Ref<AstNode> astCreateSelect(ScriptPosition pos, Ref<AstNode> selector);
+Ref<AstNode> astCreateCase(ScriptPosition pos, Ref<AstNode> values, Ref<AstNode> body);
 Ref<AstNode> astCreateFor(ScriptPosition pos,
     Ref<AstNode> initSt,
     Ref<AstNode> condition,
@@ -162,7 +182,7 @@ Ref<AstNode> astCreateMemberAccess(ScriptPosition pos,
 
 Ref<AstNode> astCreateActor(ScriptPosition pos, const std::string& name);
 
-Ref<AstNode> astCreateInputMsg(ScriptPosition pos, const std::string& name);
+Ref<AstNode> astCreateInputMsg(ScriptPosition pos, const std::string& name, int priority = 0);
 Ref<AstNode> astCreateMessageType(ScriptPosition pos, Ref<AstNode> params);
 Ref<AstNode> astCreateOutputMsg(ScriptPosition pos, const std::string& name);
 Ref<AstNode> astCreateLiteral(LexToken token);
@@ -174,6 +194,12 @@ Ref<AstNode> astCreateUnnamedInput(ScriptPosition pos,
 Ref<AstNode> astCreateImport(ScriptPosition pos, const std::string& value, int flags);
 
 Ref<AstNode> astCreateGetAddress(ScriptPosition pos, Ref<AstNode> rExpr);
+Ref<AstNode> astCreateGeneric(ScriptPosition pos,
+    const std::string& name,
+    Ref<AstNode> params,
+    Ref<AstNode> definition);
+
+Ref<AstNode> astClone(Ref<AstNode> node);
 
 
 std::vector<AstNode*> astGatherTypes(Ref<AstNode> root);
@@ -222,6 +248,12 @@ public:
         m_children.insert(m_children.begin(), child);
     }
 
+    void insertChild(size_t index, Ref<AstNode> child)
+    {
+        assert(index <= m_children.size());
+        m_children.insert(m_children.begin() + index, child);
+    }
+
     void setChild(unsigned index, Ref<AstNode> node)
     {
         assert(index < m_children.size());
@@ -133,10 +133,8 @@ AstNode* AstDeserializeContext::getDataType(AstNode* node)
 
     if (typeId.empty())
         return astGetVoid();
-    else if (typeId == "int")
-        return astGetInt();
-    else if (typeId == "bool")
-        return astGetBool();
+    else if (astGetDefaultType(typeId) != nullptr)
+        return astGetDefaultType(typeId);
 
     auto	it = m_id2Node.find(typeId);
 
@@ -111,6 +111,12 @@ OperationResult<BuilderConfig> checkConfig(const BuilderConfig& cfg)
         newCfg.LibPaths.push_back(newCfg.PlatformPath);
     }
 
+    if (newCfg.StackBudget == 0)
+        newCfg.StackBudget = getSystemBudget("FILS_STACK_BUDGET");
+
+    if (newCfg.RamBudget == 0)
+        newCfg.RamBudget = getSystemBudget("FILS_RAM_BUDGET");
+
     return ResultType(move(newCfg));
 }
 
@@ -130,6 +136,20 @@ StrList getSystemLibPaths()
     return paths;
 }
 
+/// <summary>
+/// Reads a memory budget, in bytes, from an environment variable.
+/// </summary>
+/// <returns>Zero (no limit) if the variable is not defined.</returns>
+size_t getSystemBudget(const char* varName)
+{
+    const char* varContent = getenv(varName);
+
+    if (varContent == nullptr)
+        return 0;
+    else
+        return (size_t)strtoul(varContent, nullptr, 10);
+}
+
 
 /// <summary>
 /// Obtains the dependency tree of a module.
@@ -543,6 +563,7 @@ CodeGeneratorConfig configureCodeGenerator(const BuilderConfig& cfg)
 
     result.epilog = readTextFile(joinPaths(cfg.PlatformPath, "epilog.c"));
     result.prolog = readTextFile(joinPaths(cfg.PlatformPath, "prolog.c"));
+    result.instrument = cfg.Instrument;
 
     return result;
 }
@@ -559,9 +580,12 @@ BuildResult buildExecutable(ModuleNode* module, const BuilderConfig& cfg)
 
     try
     {
-        string code = generateCode(module->getAST(), configureCodeGenerator(cfg));
+        MemoryUsage	usage;
+        string		code = generateCode(module->getAST(), configureCodeGenerator(cfg), usage);
 
         writeCCodeFile(code, module);
+        writeLayoutReport(module, usage);
+        checkMemoryBudgets(usage, cfg);
         _flushall();	//To ensure all generated files are written to the disk.
 
         auto deps = getCLibrariesDependencies(module, cfg);
@@ -594,6 +618,58 @@ void writeCCodeFile(const std::string& code, ModuleNode* module)
     }
 }
 
+/// <summary>
+/// Writes the report of the RAM used by actors, with and without layout optimization,
+/// and of the stack and static RAM usage.
+/// </summary>
+/// <param name="module">Module information</param>
+/// <param name="usage">Memory usage estimated by the code generator.</param>
+void writeLayoutReport(ModuleNode* module, const MemoryUsage& usage)
+{
+    string report = generateLayoutReport(module->getAST()) + "\n" + generateMemoryReport(usage);
+
+    if (!writeTextFile(module->getLayoutReportPath(), report))
+    {
+        throw CompileError::create(ScriptPosition(),
+            ETYPE_WRITING_RESULT_FILE_2,
+            module->getLayoutReportPath().c_str(),
+            "Cannot write to file"
+        );
+    }
+}
+
+/// <summary>
+/// Checks the estimated memory usage against the configured budgets.
+/// Throws a 'CompileError' if some of them is exceeded.
+/// </summary>
+void checkMemoryBudgets(const MemoryUsage& usage, const BuilderConfig& cfg)
+{
+    if (cfg.StackBudget > 0)
+    {
+        for (auto& handler : usage.handlers)
+        {
+            if (!handler.bounded || handler.worst > cfg.StackBudget)
+            {
+                string worst = handler.bounded ? to_string(handler.worst) : string("unbounded");
+
+                throw CompileError::create(ScriptPosition(),
+                    ETYPE_STACK_BUDGET_EXCEEDED_3,
+                    handler.name.c_str(),
+                    worst.c_str(),
+                    (int)cfg.StackBudget);
+            }
+        }
+    }
+
+    if (cfg.RamBudget > 0 && usage.totalRam() > cfg.RamBudget)
+    {
+        throw CompileError::create(ScriptPosition(),
+            ETYPE_RAM_BUDGET_EXCEEDED_2,
+            (int)usage.totalRam(),
+            (int)cfg.RamBudget);
+    }
+}
+
 /// <summary>
 /// Compiles 'C' code, invoking an external compiler.
 /// </summary>
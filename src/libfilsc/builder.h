@@ -18,6 +18,14 @@ struct BuilderConfig
     std::string     PlatformPath;
 
     std::vector<std::string>    LibPaths;
+
+    //Maximum stack usage of an actor input, and maximum static RAM usage, in bytes.
+    //The build fails if the estimated usage exceeds them. Zero means no limit.
+    size_t          StackBudget = 0;
+    size_t          RamBudget = 0;
+
+    //Generates code which profiles functions and actor inputs ('filsc --instrument').
+    bool            Instrument = false;
 };
 
 typedef OperationResult<bool> BuildResult;
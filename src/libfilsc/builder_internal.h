@@ -6,6 +6,7 @@
 #pragma once
 #include "builder.h"
 #include "DependencyTree.h"
+#include "c_codeGenerator.h"
 #include <filesystem>
 
 
@@ -25,6 +26,7 @@ typedef std::map<std::string, NodeSet>                  ModuleRefsMap;
 
 OperationResult<BuilderConfig>  checkConfig(const BuilderConfig& cfg);
 StrList						    getSystemLibPaths();
+size_t						    getSystemBudget(const char* varName);
 
 DependenciesResult			getDependencies(
     const std::string& modulePath, 
@@ -54,6 +56,8 @@ bool						containsEntryPoint(Ref<AstNode> ast);
 
 BuildResult					buildExecutable(ModuleNode* module, const BuilderConfig& cfg);
 void						writeCCodeFile(const std::string& code, ModuleNode* module);
+void						writeLayoutReport(ModuleNode* module, const MemoryUsage& usage);
+void						checkMemoryBudgets(const MemoryUsage& usage, const BuilderConfig& cfg);
 BuildResult					compileC(ModuleNode* module, const StrMap& cLibraries, const BuilderConfig& cfg);
 
 OperationResult<StrMap>     getCLibrariesDependencies(ModuleNode* module, const BuilderConfig& cfg);
@@ -11,6 +11,8 @@
 #include "compileError.h"
 #include "utils.h"
 #include "codeGeneratorState.h"
+#include "rangeAnalysis.h"
+#include "typeCheckPass.h"
 
 using namespace std;
 
@@ -34,10 +36,32 @@ string generateCode(Ref<AstNode> node)
 /// <param name="config">Code generator configuration</param>
 /// <returns></returns>
 string generateCode(Ref<AstNode> node, const CodeGeneratorConfig& config)
+{
+    MemoryUsage	usage;
+
+    return generateCode(node, config, usage);
+}
+
+/// <summary>
+/// 'C' code generation entry point. Also estimates the memory usage of the program.
+/// </summary>
+/// <param name="node">AST root</param>
+/// <param name="config">Code generator configuration</param>
+/// <param name="usage">Receives the stack usage of actor inputs and constructors, and 
+/// the static RAM usage.</param>
+string generateCode(Ref<AstNode> node, const CodeGeneratorConfig& config, MemoryUsage& usage)
 {
     ostringstream		output;
     CodeGeneratorState	state(&output);
 
+    state.setBlockParamsThreshold(config.blockParamsThreshold);
+    state.setBlockSize(config.blockSize);
+    state.setOptimizeLayout(config.optimizeLayout);
+    state.setBoundsChecks(config.boundsChecks);
+
+    if (config.boundsChecks)
+        state.setSafeArrayAccesses(findSafeArrayAccesses(node));
+
     //Set names for items which have defaults.
     auto &topLevelItems = node->children();
 
@@ -52,32 +76,60 @@ string generateCode(Ref<AstNode> node, const CodeGeneratorConfig& config)
     //write prolog.
     state.output() << config.prolog;
 
+    //Platforms may place constant data in a given section (ROM, for example).
+    state.output() << "\n#ifndef PCR_CONST_DATA\n#define PCR_CONST_DATA\n#endif\n\n";
+
+    //Get functions
+    auto functions = astGatherFunctions(node.getPointer());
+
+    markCLayoutTypes(functions, state);
+
     //Generate types.
     auto types = astGatherTypes(node);
     for (auto& type : types)
         dataTypeCodegen(type, state);
 
-    //Get functions
-    auto functions = astGatherFunctions(node.getPointer());
-
     //Declare functions.
     for (auto& fn : functions)
         declareFunction(fn, state);
 
     state.output() << "\n\n";
 
+    auto actors = astGatherActors(node.getPointer());
+
+    if (config.instrument)
+        generateProfileTable(functions, actors, state);
+
     //Generate functions code.
     for (auto& fn : functions)
         codegen(fn, state, VoidVariable());
 
     //Actors code generation.
-    auto actors = astGatherActors(node.getPointer());
+    for (auto& actor : actors)
+        assignEndPointIndexes(actor, state);
     for (auto& actor : actors)
         codegen(actor, state, VoidVariable());
 
+    if (config.staticActorGraph)
+    {
+        for (auto actor : actors)
+        {
+            if (actor->getName() == "_Main"
+                && astGetParameters(actor)->childCount() == 0
+                && isStaticActor(actor))
+            {
+                generateStaticActorGraph(actor, state);
+            }
+        }
+    }
+
+    generateTraceSymbols(actors, state);
+
     //Write epilog
     state.output() << config.epilog;
 
+    usage = analyzeMemoryUsage(node, state);
+
     return output.str();
 }
 
@@ -114,8 +166,10 @@ void codegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo&
         types[AST_TUPLE_DEF] = tupleDefCodegen;
         types[AST_TUPLE_ADAPTER] = tupleAdapterCodegen;
         types[AST_IF] = ifCodegen;
-        types[AST_FOR] = invalidNodeCodegen;
-        types[AST_FOR_EACH] = invalidNodeCodegen;
+        types[AST_SELECT] = selectCodegen;
+        types[AST_CASE] = invalidNodeCodegen;
+        types[AST_FOR] = forCodegen;
+        types[AST_FOR_EACH] = forEachCodegen;
         types[AST_RETURN] = returnCodegen;
         types[AST_FUNCTION] = functionCodegen;
         types[AST_ASSIGNMENT] = assignmentCodegen;
@@ -137,6 +191,7 @@ void codegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo&
         types[AST_TYPE_NAME] = voidCodegen;
         types[AST_IMPORT] = voidCodegen;
         types[AST_GET_ADDRESS] = getAddressCodegen;
+        types[AST_GENERIC] = voidCodegen;
     }
 
     if (node.notNull())
@@ -234,6 +289,7 @@ void functionCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariab
 
     //Necessary because functions usually define their own temporaries.
     CodegenBlock	functionBlock(state);
+    CodegenFrame	frame(state, node.getPointer());
 
     //Generate code for the parameters tuple.
     auto fnCode = astGetFunctionBody(node.getPointer());
@@ -242,14 +298,19 @@ void functionCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariab
     state.output() << "//Code for '" << node->getName() << "' function\n";
     state.output() << genFunctionHeader(node, state);
     state.output() << "{\n";
+    profileEnterCodegen(node.getPointer(), state);
 
     if (astIsVoidType(returnType))
+    {
         codegen(fnCode, state, VoidVariable());
+        profileExitCodegen(state);
+    }
     else
     {
         TempVariable	tmpReturn(returnType, state, false);
         codegen(fnCode, state, tmpReturn);
 
+        profileExitCodegen(state);
         state.output() << "return " << tmpReturn.cname() << ";\n";
     }
 
@@ -388,10 +449,18 @@ void varCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInf
 {
     auto	typeNode = node->getDataType();
 
+    if (isConstantData(node.getPointer()))
+        return constantDataCodegen(node.getPointer(), state);
+
+    state.addFrameVariable(typeNode, false);
     state.output() << state.cname(typeNode) << " ";
     state.output() << state.cname(node) << ";\n";
 
-    if (node->childExists(1))
+    if (!node->childExists(1))
+        return;
+    else if (astIsArrayType(typeNode))
+        arrayValueCodegen(node->child(1), state, NamedVariable(node, state));
+    else
         codegen(node->child(1), state, NamedVariable(node, state));
 }
 
@@ -420,7 +489,8 @@ void tupleDefCodegen(AstNode* type, CodeGeneratorState& state)
     if (type->childCount() == 0)
         return;		//Empty tuples shall not be generated
 
-    string name = state.cname(type);
+    string              name = state.cname(type);
+    vector<StructField> fields;
 
     state.output() << "typedef struct {\n";
 
@@ -428,14 +498,64 @@ void tupleDefCodegen(AstNode* type, CodeGeneratorState& state)
     for (int i = 0; i < count; ++i)
     {
         auto child = type->child(i);
+        auto fieldType = child->getDataType();
 
-        state.output() << state.cname(child->getDataType()) << " ";
-        state.output() << state.cname(child) << ";\n";
+        fields.push_back({ state.cname(fieldType) + " " + state.cname(child), estimateTypeLayout(fieldType, true) });
     }
 
+    structFieldsCodegen(fields, state.optimizeLayout() && !state.hasCLayout(type), state);
+
     state.output() << "}" << name << ";\n\n";
 }
 
+/// <summary>
+/// Writes the fields of a 'C' structure. If 'reorder' is set, they are sorted by
+/// descending alignment, which leaves no padding between them.
+/// </summary>
+void structFieldsCodegen(std::vector<StructField>& fields, bool reorder, CodeGeneratorState& state)
+{
+    if (reorder)
+    {
+        stable_sort(fields.begin(), fields.end(), [](const StructField& a, const StructField& b) {
+            return a.layout.align > b.layout.align;
+        });
+    }
+
+    for (auto& field : fields)
+        state.output() << field.declaration << ";\n";
+}
+
+/// <summary>
+/// Marks the types whose field order shall be kept, because 'C' code accesses
+/// them: parameters of 'C' functions, and the tuples they contain.
+/// 'struct[C]' types are always kept in declaration order.
+/// </summary>
+void markCLayoutTypes(const std::vector<AstNode*>& functions, CodeGeneratorState& state)
+{
+    std::function<void(AstNode*)> mark = [&mark, &state](AstNode* type) {
+        if (type->getType() == AST_TYPEDEF || type->getType() == AST_TYPE_NAME)
+            type = type->getType() == AST_TYPEDEF ? type->child(0).getPointer() : type->getDataType();
+
+        if (type->getType() == AST_ARRAY_DECL)
+            mark(type->child(0)->getDataType());
+        else if (astIsTupleType(type) && !state.hasCLayout(type))
+        {
+            state.setCLayout(type);
+            for (auto field : type->children())
+                mark(field->getDataType());
+        }
+    };
+
+    for (auto fn : functions)
+    {
+        if (fn->hasFlag(ASTF_EXTERN_C))
+        {
+            mark(fn->child(0)->getDataType());
+            mark(astGetParameters(fn));
+        }
+    }
+}
+
 /// <summary>
 /// Declares an array type
 /// </summary>
@@ -461,12 +581,58 @@ void tupleAdapterCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVa
     //TODO: This is not going to work when default tuple values are implemented.
     //(or other more complex type-adapting features)
     TempVariable	rTemp(node->child(0), state, false);
-    string			lName = resultDest.cname();
 
     codegen(node->child(0), state, rTemp);
-    state.output() << "memcpy (&" << lName << ", &" << rTemp.cname()
-        << ", sizeof(" << resultDest.cname() << "));\n";
+    tupleCopyCodegen(resultDest, rTemp, state);
+}
+
+/// <summary>
+/// Generates code which copies a tuple into a compatible one.
+/// </summary>
+/// <remarks>
+/// Tuples with the same layout are copied with 'memcpy'. Otherwise, they are copied
+/// field by field, down to the fields whose layouts match.
+/// </remarks>
+void tupleCopyCodegen(const IVariableInfo& dest, const IVariableInfo& src, CodeGeneratorState& state)
+{
+    if (!tupleLayoutsDiffer(dest.dataType(), src.dataType(), state))
+    {
+        state.output() << "memcpy (&" << dest.cname() << ", &" << src.cname()
+            << ", sizeof(" << dest.cname() << "));\n";
+        return;
+    }
+
+    for (size_t i = 0; i < src.dataType()->childCount(); ++i)
+    {
+        TupleField  lField(dest, (int)i, state);
+        TupleField  rField(src, (int)i, state);
+        auto        fieldType = lField.dataType();
+
+        if (astIsTupleType(fieldType) || astIsArrayType(fieldType))
+            tupleCopyCodegen(lField, rField, state);
+        else
+            state.output() << lField << " = " << rField << ";\n";
+    }
+}
+
+/// <summary>
+/// Checks if two compatible tuple types may have different 'C' layouts: reordered 
+/// and 'C' layouts are not the same, in any nesting level.
+/// </summary>
+bool tupleLayoutsDiffer(AstNode* typeA, AstNode* typeB, CodeGeneratorState& state)
+{
+    if (!state.optimizeLayout() || !astIsTupleType(typeA) || !astIsTupleType(typeB))
+        return false;
+    else if (state.hasCLayout(typeA) != state.hasCLayout(typeB))
+        return true;
+
+    for (size_t i = 0; i < typeA->childCount(); ++i)
+    {
+        if (tupleLayoutsDiffer(typeA->child(i)->getDataType(), typeB->child(i)->getDataType(), state))
+            return true;
+    }
 
+    return false;
 }
 
 
@@ -500,541 +666,2085 @@ void ifCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo
 }
 
 /// <summary>
-/// Generates code for a return statement
+/// Generates code for a 'select' expression.
 /// </summary>
-void returnCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+/// <remarks>
+/// It is generated as a 'C' switch, so the 'C' compiler can turn dense cases into
+/// a jump table.
+/// </remarks>
+void selectCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
 {
-    if (!node->childExists(0))
-        state.output() << "return;\n";
-    else
-    {
-        auto			expression = node->child(0);
-        TempVariable	tempVar(node, state, false);
+    auto	selector = node->child(0);
 
-        codegen(expression, state, tempVar);
-        state.output() << "return " << tempVar.cname() << ";\n";
-    }
-}
+    TempVariable selectorTempVar(selector, state, false);
 
-/// <summary>
-/// Generates code for an assignment expression.
-/// </summary>
-void assignmentCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
-{
-    auto	lexpr = node->child(0);
-    auto	rexpr = node->child(1);
+    codegen(selector, state, selectorTempVar);
 
-    assert(node->getValue() == "=");
+    state.output() << "switch(" << selectorTempVar.cname() << "){\n";
 
-    TempVariable	lRef(lexpr, state, true);
-    TempVariable	rResult(rexpr, state, false);
+    for (size_t i = 1; i < node->childCount(); ++i)
+    {
+        auto caseNode = node->child(i);
 
-    codegen(lexpr, state, lRef);
-    codegen(rexpr, state, rResult);
+        if (!caseNode->childExists(0))
+            state.output() << "default:\n";
+        else
+        {
+            for (auto valueNode : caseNode->child(0)->children())
+            {
+                long long value;
 
-    state.output() << "*" << lRef << " = " << rResult << ";\n";
-    if (!resultDest.isVoid())
-        state.output() << resultDest << " = " << rResult << ";\n";
+                getCaseValue(valueNode, value);
+                state.output() << "case " << value << ":\n";
+            }
+        }
+
+        //Each case has its own block, so temporaries are not shared between cases.
+        CodegenBlock	block(state);
+
+        state.output() << "{\n";
+        codegen(caseNode->child(1), state, resultDest);
+        state.output() << "}\nbreak;\n";
+    }
+
+    state.output() << "}\n";
 }
 
 /// <summary>
-/// Generates code for a function call expression.
+/// Generates code for a 'for' loop.
 /// </summary>
-void callCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+/// <remarks>
+/// If the condition and increment are simple expressions (comparisons between 
+/// variables and literals, increments / decrements of a variable) it is generated
+/// as a 'C' counted loop, which the 'C' compiler can vectorize.
+/// </remarks>
+void forCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
 {
-    auto fnExpr = node->child(0);
-    auto paramsExpr = node->child(1);
+    auto	initExpr = node->child(0);
+    auto	condition = node->child(1);
+    auto	increment = node->child(2);
+    auto	body = node->child(3);
+    string	conditionC;
+    string	incrementC;
 
-    //By the moment, only direct function invocation is supported
-    assert(fnExpr->getType() == AST_IDENTIFIER);
+    CodegenBlock	block(state);
 
-    auto	fnNode = fnExpr->getReference();
-    auto    fnType = fnNode->getDataType();
-    string	fnCName = state.cname(fnNode);
+    state.output() << "{\n";
+    auto bases = arrayBasesCodegen(node.getPointer(), state);
 
-    //TODO: Split in several functions.
-    if (fnType->getType() == AST_MESSAGE_TYPE)
-    {
-        assert(resultDest.isVoid());
-        TempVariable    addressTemp(fnType, state, false);
+    codegen(initExpr, state, VoidVariable());
 
-        codegen(fnExpr, state, addressTemp);
-        if (paramsExpr->childCount() == 0)
-        {
-            state.output() << "postMessage (&" << addressTemp << ", NULL, 0);\n";
-        }
-        else
-        {
-            auto			paramsType = astGetParameters(fnType);
-            TempVariable	tmpParams(paramsType, state, false);
+    const bool counted = (condition.isNull() || inlineLoopExpression(condition, state, conditionC))
+        && (increment.isNull() || inlineLoopExpression(increment, state, incrementC));
 
-            codegen(paramsExpr, state, tmpParams);
-            state.output() << "postMessage (&" << addressTemp << ", &" << tmpParams;
-            state.output() << ", sizeof(" << tmpParams << ")); \n";
-        }
-    }
-    else if (fnType->getType() == AST_ACTOR)
+    if (counted)
     {
-        if (paramsExpr->childCount() == 0)
-        {
-            state.output() << state.cname(fnType) + "_constructor (&" << resultDest << ", NULL);\n";
-        }
-        else
-        {
-            auto			paramsType = astGetParameters(fnType);
-            TempVariable	tmpParams(paramsType, state, false);
+        CodegenBlock	bodyBlock(state);
 
-            codegen(paramsExpr, state, tmpParams);
-            state.output() << state.cname(fnType) + "_constructor (&" << resultDest 
-                << ", &" << tmpParams << ");\n";
-        }
+        state.output() << "for (; " << conditionC << "; " << incrementC << "){\n";
+        codegen(body, state, VoidVariable());
+        state.output() << "}\n";
     }
     else
     {
-        if (paramsExpr->childCount() == 0)
-        {
-            assert(resultDest.isVoid());
+        CodegenBlock	bodyBlock(state);
 
-            state.output() << fnCName << "();\n";
-        }
-        else
+        state.output() << "for (;;){\n";
+        if (condition.notNull())
         {
-            auto			paramsType = astGetParameters(fnType);
-            TempVariable	tmpParams(paramsType, state, false);
-
-            codegen(paramsExpr, state, tmpParams);
-
-            if (!resultDest.isVoid())
-                state.output() << resultDest.cname() << " = ";
+            TempVariable	conditionTemp(condition, state, false);
 
-            state.output() << fnCName << "(&" << tmpParams.cname() << ");\n";
+            codegen(condition, state, conditionTemp);
+            state.output() << "if (!" << conditionTemp << ") break;\n";
         }
-
+        codegen(body, state, VoidVariable());
+        codegen(increment, state, VoidVariable());
+        state.output() << "}\n";
     }
+
+    for (auto decl : bases)
+        state.releaseArrayBase(decl);
+
+    state.output() << "}\n";
 }
 
 /// <summary>
-/// Generates code for the intem access operator '[]' 
+/// Generates code for a 'for each' loop. Arrays have a fixed size, so the trip count
+/// is a compile time constant.
 /// </summary>
-void arrayAccessOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+void forEachCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
 {
-    //TODO: Array references should be checked!!! This is supposed to be one of the main 
-    //features of this language.
-    auto arrayExpr = node->child(0);
-    auto indexExpr = node->child(1)->child(0);
-    auto arrayItemType = node->getDataType();
+    auto	sequence = node->child(0);
+    auto	item = node->child(1);
+    auto	body = node->child(2);
+    auto	arrayType = sequence->getDataType();
 
-    TempVariable    tmpArray(arrayItemType, state, true);
-    TempVariable    indexTmp(indexExpr->getDataType(), state, false);
+    CodegenBlock	block(state);
 
-    //HACK: The 'array' variable is treated as a reference when declared, but as 
-    //not a reference when used. This is due how arrays in 'C' are treated.
-    tmpArray.isReference = false;
+    state.output() << "{\n";
+    auto bases = arrayBasesCodegen(node.getPointer(), state);
 
-    codegen(arrayExpr, state, tmpArray);
-    codegen(indexExpr, state, indexTmp);
+    vector<unique_ptr<TempVariable>>	sequenceTemps;
+    TempVariable	indexTemp(astGetInt(), state, false);
+    string			sequenceBase;
 
-    string          refPrefix;
-    if (resultDest.isReference)
-        refPrefix = "&";
+    if (sequence->getType() == AST_IDENTIFIER)
+        sequenceBase = state.arrayBase(sequence->getReference());
+    if (sequenceBase.empty())
+        sequenceBase = arrayOperandCodegen(sequence, sequenceTemps, state);
 
-    state.output() << resultDest << " = " << refPrefix << tmpArray << "[" << indexTmp << "];\n";
+    state.output() << "for (" << indexTemp << " = 0; " << indexTemp << " < " 
+        << arrayType->child(1)->getValue() << "; ++" << indexTemp << "){\n";
+    {
+        CodegenBlock	bodyBlock(state);
+
+        codegen(item, state, VoidVariable());
+        state.output() << state.cname(item) << " = " << sequenceBase << "[" << indexTemp << "];\n";
+        codegen(body, state, VoidVariable());
+    }
+    state.output() << "}\n";
+
+    for (auto decl : bases)
+        state.releaseArrayBase(decl);
+
+    state.output() << "}\n";
 }
 
 /// <summary>
-/// Generates code for a literal node
+/// Translates simple loop conditions and increments directly to 'C' expressions, 
+/// without temporaries.
 /// </summary>
-void literalCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+/// <param name="node">Expression to translate.</param>
+/// <param name="cExpr">Receives the 'C' expression.</param>
+/// <returns>false if the expression is not simple enough.</returns>
+bool inlineLoopExpression(Ref<AstNode> node, CodeGeneratorState& state, std::string& cExpr)
 {
-    if (resultDest.isVoid())
-        return;
+    const string op = node->getValue();
 
     switch (node->getType())
     {
     case AST_INTEGER:
-    case AST_FLOAT:
     case AST_BOOL:
-        state.output() << resultDest.cname() << " = " << node->getValue() << ";\n";
-        break;
+        cExpr = node->getValue();
+        return true;
 
-    case AST_STRING:
-        state.output() << resultDest.cname() << " = " << escapeString(node->getValue(), true) << ";\n";
-        break;
+    case AST_IDENTIFIER:
+        if (node->getReference()->getType() != AST_DECLARATION || !astIsIntType(node->getDataType()))
+            return false;
+
+        cExpr = varAccessExpression(node, state);
+        return true;
+
+    case AST_BINARYOP:
+    {
+        string left, right;
+
+        if (op != "<" && op != "<=" && op != ">" && op != ">=" && op != "!=")
+            return false;
+        if (!inlineLoopExpression(node->child(0), state, left) || !inlineLoopExpression(node->child(1), state, right))
+            return false;
+
+        cExpr = left + " " + op + " " + right;
+        return true;
+    }
+
+    case AST_PREFIXOP:
+    case AST_POSTFIXOP:
+    {
+        string var;
+
+        if ((op != "++" && op != "--") || node->child(0)->getType() != AST_IDENTIFIER)
+            return false;
+        if (!inlineLoopExpression(node->child(0), state, var))
+            return false;
+
+        cExpr = op + var;
+        return true;
+    }
 
     default:
-        assert(!"Unexpected literal type");
+        return false;
     }
 }
 
 /// <summary>
-/// Generates code to read a variable.
+/// Finds the arrays whose elements are only accessed by index inside a loop, and 
+/// therefore can be accessed through '__restrict' pointers.
 /// </summary>
-void varAccessCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+/// <remarks>
+/// Arrays are values, so two array declarations never alias. Loops which contain
+/// function calls or message posts are discarded, as the called code may access 
+/// the arrays by other means.
+/// </remarks>
+/// <returns>Array declarations.</returns>
+std::vector<AstNode*> loopRestrictArrays(AstNode* loop)
 {
-    if (resultDest.isVoid())
-        return;
+    set<AstNode*>	candidates;
+    set<AstNode*>	excluded;
+    bool			hasCalls = false;
+
+    std::function<void(AstNode*, AstNode*)> walk = [&](AstNode* node, AstNode* parent) {
+        if (node->getType() == AST_FNCALL)
+            hasCalls = true;
+        else if (node->getType() == AST_IDENTIFIER)
+        {
+            auto decl = node->getReference();
+
+            if (decl->getType() == AST_DECLARATION && decl->getDataType()->getType() == AST_ARRAY_DECL)
+            {
+                const bool indexed = (parent->getType() == AST_CTCALL || parent->getType() == AST_FOR_EACH)
+                    && parent->child(0).getPointer() == node;
+
+                if (indexed)
+                    candidates.insert(decl);
+                else
+                    excluded.insert(decl);
+            }
+        }
 
-    if (node->getReference()->getType() == AST_INPUT)
-    {
-        assert(!resultDest.isReference);
-        state.output() << resultDest.cname() << ".actorPtr = _gen_actor;\n";
-        state.output() << resultDest.cname() << ".inputPtr = " << state.cname(node->getReference()) << ";\n";
-    }
-    else
+        for (auto& child : node->children())
+        {
+            if (child.notNull())
+                walk(child.getPointer(), node);
+        }
+    };
+
+    walk(loop, nullptr);
+
+    vector<AstNode*>	result;
+
+    if (hasCalls)
+        return result;
+
+    for (auto decl : candidates)
     {
-        string accessExpression = varAccessExpression(node, state);
-        if (resultDest.isReference)
-            state.output() << resultDest.cname() << " = &" << accessExpression << ";\n";
-        else
-            state.output() << resultDest.cname() << " = " << accessExpression << ";\n";
+        if (excluded.count(decl) == 0)
+            result.push_back(decl);
     }
-}
 
+    return result;
+}
 
 /// <summary>
-/// Generates code for an access to member expression.
+/// Declares '__restrict' pointers to the arrays which are only accessed by index
+/// inside a loop. Array accesses inside the loop use them.
 /// </summary>
-void memberAccessCodegen(
-    Ref<AstNode> node,
-    CodeGeneratorState& state,
-    const IVariableInfo& resultDest)
+/// <returns>Array declarations which got a pointer. They shall be cleared at 
+/// the end of the loop.</returns>
+std::vector<AstNode*> arrayBasesCodegen(AstNode* loop, CodeGeneratorState& state)
 {
-    if (resultDest.isVoid())
-        return;
+    vector<AstNode*>	result;
 
-    auto ltype = node->child(0)->getDataType();
+    for (auto decl : loopRestrictArrays(loop))
+    {
+        //Already declared in an enclosing loop.
+        if (!state.arrayBase(decl).empty())
+            continue;
 
-    switch (ltype->getType())
+        auto	itemType = decl->getDataType()->child(0)->getDataType();
+        string	name = state.allocArrayBase(decl);
+
+        state.addFrameVariable(itemType, true);
+        state.output() << state.cname(itemType) << "* __restrict\t" << name << " = "
+            << declarationAccessExpression(decl, state) << ";\n";
+        result.push_back(decl);
+    }
+
+    return result;
+}
+
+/// <summary>
+/// Generates code for a return statement
+/// </summary>
+void returnCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    if (!node->childExists(0))
     {
-    //case AST_TUPLE:
-    case AST_TUPLE_DEF:
-        tupleMemberAccessCodegen(node, state, resultDest);
-        return;
+        profileExitCodegen(state);
+        state.output() << "return;\n";
+    }
+    else
+    {
+        auto			expression = node->child(0);
+        TempVariable	tempVar(node, state, false);
 
-    case AST_ACTOR:
-        actorMemberAccessCodegen(node, state, resultDest);
+        codegen(expression, state, tempVar);
+        profileExitCodegen(state);
+        state.output() << "return " << tempVar.cname() << ";\n";
+    }
+}
+
+/// <summary>
+/// Generates code for an assignment expression.
+/// </summary>
+void assignmentCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    auto	lexpr = node->child(0);
+    auto	rexpr = node->child(1);
+
+    assert(node->getValue() == "=");
+
+    if (astIsArrayType(lexpr->getDataType()))
+        return arrayAssignmentCodegen(node, state, resultDest);
+
+    TempVariable	lRef(lexpr, state, true);
+    TempVariable	rResult(rexpr, state, false);
+
+    codegen(lexpr, state, lRef);
+    codegen(rexpr, state, rResult);
+
+    state.output() << "*" << lRef << " = " << rResult << ";\n";
+    if (!resultDest.isVoid())
+        state.output() << resultDest << " = " << rResult << ";\n";
+}
+
+/// <summary>
+/// Generates code for an assignment to a whole array.
+/// </summary>
+void arrayAssignmentCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    auto	lexpr = node->child(0);
+    auto	rexpr = node->child(1);
+
+    if (lexpr->getType() == AST_IDENTIFIER && lexpr->getReference()->getType() == AST_DECLARATION)
+        arrayValueCodegen(rexpr, state, NamedVariable(lexpr->getReference(), state));
+    else
+    {
+        TempVariable	lRef(lexpr, state, true);
+
+        codegen(lexpr, state, lRef);
+        arrayValueCodegen(rexpr, state, lRef);
+    }
+
+    arrayValueCodegen(lexpr, state, resultDest);
+}
+
+/// <summary>
+/// Generates code which writes the value of an array expression into an array.
+/// Element-wise operations are fused into a single loop, with a constant trip count,
+/// which the 'C' compiler can vectorize.
+/// </summary>
+/// <param name="expr">Array expression</param>
+/// <param name="resultDest">Destination array. It can also be an operand of 'expr', as
+/// each element is read before being written.</param>
+void arrayValueCodegen(Ref<AstNode> expr, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    if (resultDest.isVoid())
         return;
+    else if (resultDest.isReference)
+        return arrayValueCodegen(expr, state, PointedVariable(resultDest));
 
-    default:
-        break;      //Will throw an error.
-    }//switch
+    CodegenBlock					block(state);
+    vector<unique_ptr<TempVariable>>	operands;
 
-    string msg = "Invalid left expression data type on member access: ";
-    msg += astTypeToString(ltype);
-    errorAt(node->position(),
-        ETYPE_CODE_GENERATION_ERROR_1,
-        msg.c_str());
+    state.output() << "{\n";
+
+    TempVariable	indexTemp(astGetInt(), state, false);
+    const string	itemExpr = elementExpression(expr, indexTemp.cname(), operands, state);
+
+    state.output() << "for (" << indexTemp << " = 0; " << indexTemp << " < "
+        << astGetArraySize(expr->getDataType()) << "; ++" << indexTemp << ")\n";
+    state.output() << "\t" << resultDest << "[" << indexTemp << "] = " << itemExpr << ";\n";
+    state.output() << "}\n";
 }
 
 /// <summary>
-/// Member access code generation for tuples.
+/// Gets the 'C' expression which computes an element of an array expression.
+/// Operands which are not arrays are evaluated only once, before the loop.
 /// </summary>
-void tupleMemberAccessCodegen(
-    Ref<AstNode> node,
-    CodeGeneratorState& state,
-    const IVariableInfo& resultDest)
+/// <param name="expr">Array expression, or an scalar operand of an element-wise operation.</param>
+/// <param name="index">Name of the loop index variable.</param>
+/// <param name="operands">Receives the temporaries which hold the evaluated operands.</param>
+std::string elementExpression(
+    Ref<AstNode> expr,
+    const std::string& index,
+    std::vector<std::unique_ptr<TempVariable>>& operands,
+    CodeGeneratorState& state)
 {
-    auto lexpr = node->child(0);
-    auto rnode = node->child(1);
-    auto ltype = lexpr->getDataType();
+    auto type = expr->getDataType();
 
-    bool refVariable = (lexpr->getType() == AST_MEMBER_ACCESS || lexpr->getType() == AST_IDENTIFIER);
+    if (!astIsArrayType(type))
+    {
+        operands.emplace_back(new TempVariable(expr, state, false));
+        codegen(expr, state, *operands.back());
+        return operands.back()->cname();
+    }
+    else if (expr->getType() == AST_BINARYOP)
+    {
+        auto	itemType = astGetArrayItemType(type);
+        string	left = elementExpression(expr->child(0), index, operands, state);
+        string	right = elementExpression(expr->child(1), index, operands, state);
+        string	result = "(" + left + " " + expr->getValue() + " " + right + ")";
 
-    TempVariable lexprResult(ltype, state, refVariable);
-    codegen(lexpr, state, lexprResult);
+        //'C' promotes small integers to 'int'. Truncate, as scalar operations do.
+        if (astGetIntBits(itemType) < 32)
+            result = "(" + state.cname(itemType) + ")" + result;
 
-    string  fieldName = rnode->getName();
-    int     index = astFindMemberByName(ltype, fieldName);
+        return result;
+    }
+    else
+        return arrayOperandCodegen(expr, operands, state) + "[" + index + "]";
+}
 
-    if (index < 0)
+/// <summary>
+/// Generates the code which evaluates an array operand, and gets the 'C' expression
+/// of the array, to read its elements.
+/// Variables and fields are read in place (the 'C' array decays to a pointer). The results 
+/// of element-wise operations need storage, so they are written to an array temporary.
+/// </summary>
+/// <param name="expr">Array expression</param>
+/// <param name="temps">Receives the temporaries which hold the array, or the pointer to it.
+/// They shall live until the elements are read.</param>
+std::string arrayOperandCodegen(
+    Ref<AstNode> expr,
+    std::vector<std::unique_ptr<TempVariable>>& temps,
+    CodeGeneratorState& state)
+{
+    auto type = expr->getDataType();
+
+    if (expr->getType() == AST_IDENTIFIER && expr->getReference()->getType() == AST_DECLARATION)
+        return declarationAccessExpression(expr->getReference(), state);
+    else if (expr->getType() == AST_BINARYOP || expr->getType() == AST_ASSIGNMENT)
     {
-        //This should not happen
-        //TODO: Just an assert?
-        errorAt(node->position(),
-            ETYPE_MEMBER_NOT_FOUND_2,
-            fieldName.c_str(),
-            astTypeToString(ltype).c_str());
+        temps.emplace_back(new TempVariable(type, state, false));
+        codegen(expr, state, *temps.back());
+    }
+    else
+    {
+        //HACK: The 'array' variable is treated as a reference when declared, but as 
+        //not a reference when used. This is due how arrays in 'C' are treated.
+        temps.emplace_back(new TempVariable(astGetArrayItemType(type), state, true));
+        temps.back()->isReference = false;
+        codegen(expr, state, *temps.back());
     }
 
-    string fieldCName = state.cname(ltype->child(index));
+    return temps.back()->cname();
+}
 
-    state.output() << resultDest << " = ";
-    if (resultDest.isReference)
-        state.output() << "&";
-    
-    const char* accessOp = refVariable ? "->" : ".";
-    state.output() << lexprResult << accessOp << fieldCName << ";\n";
+/// <summary>
+/// Generates code for a function call expression.
+/// </summary>
+void callCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    auto fnExpr = node->child(0);
+    auto paramsExpr = node->child(1);
+
+    //By the moment, only direct function invocation is supported
+    assert(fnExpr->getType() == AST_IDENTIFIER);
+
+    auto	fnNode = fnExpr->getReference();
+    auto    fnType = fnNode->getDataType();
+    string	fnCName = state.cname(fnNode);
+
+    //TODO: Split in several functions.
+    if (fnType->getType() == AST_MESSAGE_TYPE)
+    {
+        assert(resultDest.isVoid());
+        TempVariable    addressTemp(fnType, state, false);
+
+        codegen(fnExpr, state, addressTemp);
+        if (paramsExpr->childCount() == 0)
+        {
+            state.output() << "postMessage (" << addressTemp << ", NULL, 0);\n";
+        }
+        else if (useBlockPost(astGetParameters(fnType), state))
+        {
+            blockPostCodegen(addressTemp, paramsExpr, state);
+        }
+        else
+        {
+            reservedPostCodegen(addressTemp, paramsExpr, state);
+        }
+    }
+    else if (fnType->getType() == AST_ACTOR)
+    {
+        state.addFrameCall(fnType);
+
+        if (paramsExpr->childCount() == 0)
+        {
+            state.output() << state.cname(fnType) + "_constructor (&" << resultDest << ", NULL);\n";
+        }
+        else
+        {
+            auto			paramsType = astGetParameters(fnType);
+            TempVariable	tmpParams(paramsType, state, false);
+
+            codegen(paramsExpr, state, tmpParams);
+            state.output() << state.cname(fnType) + "_constructor (&" << resultDest 
+                << ", &" << tmpParams << ");\n";
+        }
+    }
+    else
+    {
+        state.addFrameCall(fnNode);
+
+        if (paramsExpr->childCount() == 0)
+        {
+            assert(resultDest.isVoid());
+
+            state.output() << fnCName << "();\n";
+        }
+        else
+        {
+            auto			paramsType = astGetParameters(fnType);
+            TempVariable	tmpParams(paramsType, state, false);
+
+            codegen(paramsExpr, state, tmpParams);
+
+            if (!resultDest.isVoid())
+                state.output() << resultDest.cname() << " = ";
+
+            state.output() << fnCName << "(&" << tmpParams.cname() << ");\n";
+        }
+
+    }
 }
 
 /// <summary>
-/// Member access code generation for actors.
-/// It is used to access message endpoints. In the future, to access sockets.
+/// Generates code to post a message. The parameters are written directly in the space
+/// reserved for the message in the queue, instead of building them in a temporary
+/// which is copied by 'postMessage'.
 /// </summary>
-void actorMemberAccessCodegen(
-    Ref<AstNode> node,
-    CodeGeneratorState& state,
-    const IVariableInfo& resultDest)
+/// <param name="address">Message destination</param>
+/// <param name="paramsExpr">Parameters expression</param>
+/// <param name="state"></param>
+void reservedPostCodegen(const IVariableInfo& address, Ref<AstNode> paramsExpr, CodeGeneratorState& state)
 {
-    assert(!resultDest.isReference);
-    
-    auto lexpr = node->child(0);
-    auto rnode = node->child(1);
-    auto ltype = lexpr->getDataType();
+    auto			paramsType = astGetParameters(address.dataType());
+    TempVariable	paramsPtr(paramsType, state, true);
+
+    state.output() << paramsPtr << " = pcr_reserveMessage (" << address << ", sizeof(*" << paramsPtr << "));\n";
+    codegen(paramsExpr, state, PointedVariable(paramsPtr));
+    state.output() << "pcr_commitMessage (" << paramsPtr << ");\n";
+}
+
+/// <summary>
+/// Checks if a message is posted in a runtime pool block. Parameters shall be larger 
+/// than the block threshold, and fit in a pool block. Larger ones are copied into the
+/// message queue, as pool blocks cannot hold them.
+/// </summary>
+/// <param name="paramsType"></param>
+/// <param name="state"></param>
+/// <returns></returns>
+bool useBlockPost(AstNode* paramsType, CodeGeneratorState& state)
+{
+    const size_t size = estimateTypeSize(paramsType);
+
+    return size > state.blockParamsThreshold() && size <= state.blockSize();
+}
+
+/// <summary>
+/// Generates code to post a message with large parameters. The parameters are written
+/// directly in a runtime pool block, which is posted by reference, so they are not
+/// copied into the message queue. If the pool is exhausted, the runtime reserves them
+/// in the message queue instead.
+/// </summary>
+/// <param name="address">Message destination</param>
+/// <param name="paramsExpr">Parameters expression</param>
+/// <param name="state"></param>
+void blockPostCodegen(const IVariableInfo& address, Ref<AstNode> paramsExpr, CodeGeneratorState& state)
+{
+    auto			paramsType = astGetParameters(address.dataType());
+    TempVariable	blockPtr(paramsType, state, true);
+
+    state.output() << blockPtr << " = pcr_reserveBlockMessage (" << address << ", sizeof(*" << blockPtr << "));\n";
+    codegen(paramsExpr, state, PointedVariable(blockPtr));
+    state.output() << "pcr_commitBlockMessage (" << address << ", " << blockPtr << ");\n";
+}
+
+/// <summary>
+/// Estimates the size, in bytes, of the 'C' representation of a data type.
+/// </summary>
+/// <remarks>
+/// The estimation assumes a 32 bit target, and does not need to be exact: it is only
+/// used to choose how messages are posted. Generated code uses 'sizeof'.
+/// </remarks>
+size_t estimateTypeSize(AstNode* type)
+{
+    const size_t pointerSize = 4;
+
+    switch (type->getType())
+    {
+    case AST_TYPEDEF:
+        return estimateTypeSize(type->child(0).getPointer());
+
+    case AST_TYPE_NAME:
+        return estimateTypeSize(type->getDataType());
+
+    case AST_DEFAULT_TYPE:
+        if (astIsBoolType(type))
+            return 1;
+        else if (astIsIntType(type))
+            return astGetIntBits(type) / 8;
+        else
+            return pointerSize;
+
+    case AST_TUPLE_DEF:
+    {
+        size_t size = 0;
+
+        //Fields are rounded up to 4 bytes, as an approximation of alignment padding.
+        for (auto& field : type->children())
+            size += (estimateTypeSize(field->getDataType()) + 3) & ~size_t(3);
+
+        return size;
+    }
+
+    case AST_ARRAY_DECL:
+        return estimateTypeSize(type->child(0)->getDataType()) * atoi(type->child(1)->getValue().c_str());
+
+    case AST_MESSAGE_TYPE:
+        //'MessageSlot' is an end point identifier.
+        return 2;
+
+    default:
+        return pointerSize;
+    }
+}
+
+/// <summary>
+/// Generates code for the intem access operator '[]' 
+/// </summary>
+void arrayAccessOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    auto arrayExpr = node->child(0);
+    auto indexExpr = node->child(1)->child(0);
+    auto arrayItemType = node->getDataType();
+
+    TempVariable    indexTmp(indexExpr->getDataType(), state, false);
+    string          refPrefix;
+
+    if (resultDest.isReference)
+        refPrefix = "&";
+
+    //Array with a '__restrict' pointer, declared by the enclosing loop.
+    if (arrayExpr->getType() == AST_IDENTIFIER && !state.arrayBase(arrayExpr->getReference()).empty())
+    {
+        codegen(indexExpr, state, indexTmp);
+        indexCheckCodegen(node, indexTmp, state);
+        state.output() << resultDest << " = " << refPrefix << state.arrayBase(arrayExpr->getReference())
+            << "[" << indexTmp << "];\n";
+        return;
+    }
+
+    vector<unique_ptr<TempVariable>>	arrayTemps;
+    const string	arrayName = arrayOperandCodegen(arrayExpr, arrayTemps, state);
+
+    codegen(indexExpr, state, indexTmp);
+    indexCheckCodegen(node, indexTmp, state);
+
+    state.output() << resultDest << " = " << refPrefix << arrayName << "[" << indexTmp << "];\n";
+}
+
+/// <summary>
+/// Generates the runtime check of an array index, unless range analysis has proven
+/// that it is always in bounds.
+/// </summary>
+/// <param name="node">Array access node</param>
+/// <param name="index">Variable which holds the index value</param>
+void indexCheckCodegen(Ref<AstNode> node, const IVariableInfo& index, CodeGeneratorState& state)
+{
+    if (!state.needsIndexCheck(node.getPointer()))
+        return;
+
+    const int size = astGetArraySize(node->child(0)->getDataType());
+
+    //Negative indexes become large unsigned values.
+    state.output() << "if ((unsigned)" << index << " >= " << size << "u) pcr_indexOutOfRange("
+        << index << ", " << size << ");\n";
+}
+
+/// <summary>
+/// Generates code for a literal node
+/// </summary>
+void literalCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    if (resultDest.isVoid())
+        return;
+
+    switch (node->getType())
+    {
+    case AST_INTEGER:
+    case AST_FLOAT:
+    case AST_BOOL:
+        state.output() << resultDest.cname() << " = " << node->getValue() << ";\n";
+        break;
+
+    case AST_STRING:
+        state.output() << resultDest.cname() << " = " << escapeString(node->getValue(), true) << ";\n";
+        break;
+
+    default:
+        assert(!"Unexpected literal type");
+    }
+}
+
+/// <summary>
+/// Generates code to read a variable.
+/// </summary>
+void varAccessCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    if (resultDest.isVoid())
+        return;
+
+    if (node->getReference()->getType() == AST_INPUT)
+    {
+        assert(!resultDest.isReference);
+        state.output() << resultDest.cname() << " = _gen_actor->_gen_firstEndPoint + "
+            << state.endPointIndex(node->getReference()) << ";\n";
+    }
+    else
+    {
+        string accessExpression = varAccessExpression(node, state);
+        if (resultDest.isReference)
+            state.output() << resultDest.cname() << " = &" << accessExpression << ";\n";
+        else
+            state.output() << resultDest.cname() << " = " << accessExpression << ";\n";
+    }
+}
+
+
+/// <summary>
+/// Generates code for an access to member expression.
+/// </summary>
+void memberAccessCodegen(
+    Ref<AstNode> node,
+    CodeGeneratorState& state,
+    const IVariableInfo& resultDest)
+{
+    if (resultDest.isVoid())
+        return;
+
+    auto ltype = node->child(0)->getDataType();
+
+    switch (ltype->getType())
+    {
+    //case AST_TUPLE:
+    case AST_TUPLE_DEF:
+        tupleMemberAccessCodegen(node, state, resultDest);
+        return;
+
+    case AST_ACTOR:
+        actorMemberAccessCodegen(node, state, resultDest);
+        return;
+
+    default:
+        break;      //Will throw an error.
+    }//switch
+
+    string msg = "Invalid left expression data type on member access: ";
+    msg += astTypeToString(ltype);
+    errorAt(node->position(),
+        ETYPE_CODE_GENERATION_ERROR_1,
+        msg.c_str());
+}
+
+/// <summary>
+/// Member access code generation for tuples.
+/// </summary>
+void tupleMemberAccessCodegen(
+    Ref<AstNode> node,
+    CodeGeneratorState& state,
+    const IVariableInfo& resultDest)
+{
+    auto lexpr = node->child(0);
+    auto rnode = node->child(1);
+    auto ltype = lexpr->getDataType();
+
+    bool refVariable = (lexpr->getType() == AST_MEMBER_ACCESS || lexpr->getType() == AST_IDENTIFIER);
+
+    TempVariable lexprResult(ltype, state, refVariable, isConstantDataAccess(lexpr.getPointer()));
+    codegen(lexpr, state, lexprResult);
+
+    string  fieldName = rnode->getName();
+    int     index = astFindMemberByName(ltype, fieldName);
+
+    if (index < 0)
+    {
+        //This should not happen
+        //TODO: Just an assert?
+        errorAt(node->position(),
+            ETYPE_MEMBER_NOT_FOUND_2,
+            fieldName.c_str(),
+            astTypeToString(ltype).c_str());
+    }
+
+    string fieldCName = state.cname(ltype->child(index));
+
+    state.output() << resultDest << " = ";
+    if (resultDest.isReference)
+        state.output() << "&";
+    
+    const char* accessOp = refVariable ? "->" : ".";
+    state.output() << lexprResult << accessOp << fieldCName << ";\n";
+}
+
+/// <summary>
+/// Member access code generation for actors.
+/// It is used to access message endpoints. In the future, to access sockets.
+/// </summary>
+void actorMemberAccessCodegen(
+    Ref<AstNode> node,
+    CodeGeneratorState& state,
+    const IVariableInfo& resultDest)
+{
+    assert(!resultDest.isReference);
+    
+    auto lexpr = node->child(0);
+    auto rnode = node->child(1);
+    auto ltype = lexpr->getDataType();
+
+    TempVariable lexprResult(ltype, state, true);
+    codegen(lexpr, state, lexprResult);
+
+    int index = astFindMemberByName(ltype, rnode->getName());
+    assert(index >= 0);
+
+    state.output() << resultDest << " = " << lexprResult << "->_gen_firstEndPoint + "
+        << state.endPointIndex(ltype->child(index).getPointer()) << ";\n";
+}
+
+/// <summary>
+/// Generates code for a binary operation
+/// </summary>
+void binaryOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    if (resultDest.isVoid())
+        return;
+    else if (astIsArrayType(node->getDataType()))
+        return arrayValueCodegen(node, state, resultDest);
+
+    auto leftExpr = node->child(0);
+    auto rightExpr = node->child(1);
+    auto operation = node->getValue();
+
+    TempVariable	leftTmp(leftExpr, state, false);
+    TempVariable	rightTmp(rightExpr, state, false);
+
+    codegen(leftExpr, state, leftTmp);
+    codegen(rightExpr, state, rightTmp);
+
+    state.output() << resultDest << " = ";
+    state.output() << leftTmp.cname() << operation << rightTmp.cname() << ";\n";
+}
+
+
+/// <summary>
+/// Generates code for a prefix operator
+/// </summary>
+void prefixOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    auto child = node->child(0);
+    auto operation = node->getValue();
+    bool needsRef = (operation == "++" || operation == "--");
+
+    TempVariable	temp(child, state, needsRef);
+
+    codegen(child, state, temp);
+
+    if (!resultDest.isVoid())
+        state.output() << resultDest << " = ";
+
+    state.output() << operation;
+    if (needsRef)
+        state.output() << "*";
+    state.output() << temp << ";\n";
+}
+
+
+/// <summary>
+/// Generates code for a postfix operator
+/// </summary>
+void postfixOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    auto child = node->child(0);
+    auto operation = node->getValue();
+
+    TempVariable	temp(child, state, true);
+
+    codegen(child, state, temp);
+
+    if (!resultDest.isVoid())
+        state.output() << resultDest << " = ";
+    state.output() << "(*" << temp << ")" << operation << ";\n";
+}
+
+/// <summary>
+/// Generates code for the operation to get the address of a variable.
+/// </summary>
+void getAddressCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    auto            child = node->child(0);
+    TempVariable	temp(child, state, true);
+
+    codegen(child, state, temp);
+
+    state.output() << resultDest << " = " << temp << ";\n";
+}
+
+
+/// <summary>
+/// Generates the code associated to an actor definition.
+/// </summary>
+void actorCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    //generateActorStruct(node, state);
+    generateActorConstants(node, state);
+    generateActorInputs(node, state);
+    generateActorConstructor(node, state);
+}
+
+/// <summary>
+/// Generates code for an output message.
+/// It defines a 'MessageSlot' in which an input message can be registered.
+/// </summary>
+void outputMessageCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+{
+    string name = state.cname(node);
+
+    state.output() << "MessageSlot " << name << ";\n";
+}
+
+
+/// <summary>
+/// Generates the data structure which contains the actor data.
+/// </summary>
+/// <remarks>
+/// 'actorFieldLayouts' shall be kept in sync with this function.
+/// </remarks>
+void generateActorStruct(AstNode* type, CodeGeneratorState& state)
+{
+    string              name = state.cname(type);
+    vector<StructField> fields;
+
+    state.output() << "typedef struct " << "{\n";
+
+    auto params = astGetParameters(type);
+
+    if (params->childCount() > 0)
+    {
+        string paramsTypeName = state.cname(params);
+        fields.push_back({ paramsTypeName + " params", estimateTypeLayout(params, true) });
+    }
+
+    for (size_t i = 1; i < type->childCount(); ++i)
+    {
+        auto child = type->child(i);
+        if (isConstantData(child.getPointer()))
+            continue;       //Not stored in the actor. See 'generateActorConstants'.
+        else if (child->getType() == AST_DECLARATION)
+        {
+            string childName = state.cname(child);
+            string childTypeName = state.cname(child->getDataType());
+
+            fields.push_back({ childTypeName + " " + childName, estimateTypeLayout(child->getDataType(), true) });
+        }
+        else if (child->getType() == AST_OUTPUT)
+        {
+            string childName = state.cname(child);
+
+            fields.push_back({ "MessageSlot " + childName, { 2, 2 } });
+        }
+        else if (child->getType() == AST_INPUT && child->hasFlag(ASTF_CONFLATE))
+        {
+            //Index of the pending message in the queue, for conflating inputs.
+            string childName = state.cname(child);
+
+            fields.push_back({ "int " + childName + "_pending", { 4, 4 } });
+        }
+    }
+
+    //Inputs are registered in the end point table, starting at this identifier.
+    if (countActorInputs(type) > 0)
+        fields.push_back({ "MessageSlot _gen_firstEndPoint", { 2, 2 } });
+
+    structFieldsCodegen(fields, state.optimizeLayout(), state);
+
+    state.output() << "}" << name << ";\n\n";
+}
+
+/// <summary>
+/// Gets the layouts of the fields of the 'C' structure of an actor, in declaration 
+/// order. It mirrors 'generateActorStruct'.
+/// </summary>
+/// <param name="actor"></param>
+/// <param name="optimized">Use the optimized layout for the nested types.</param>
+std::vector<FieldLayout> actorFieldLayouts(AstNode* actor, bool optimized)
+{
+    vector<FieldLayout> fields;
+    auto                params = astGetParameters(actor);
+
+    if (params->childCount() > 0)
+        fields.push_back(estimateTypeLayout(params, optimized));
+
+    for (size_t i = 1; i < actor->childCount(); ++i)
+    {
+        auto child = actor->child(i);
+
+        if (isConstantData(child.getPointer()))
+            continue;
+        else if (child->getType() == AST_DECLARATION)
+            fields.push_back(estimateTypeLayout(child->getDataType(), optimized));
+        else if (child->getType() == AST_OUTPUT)
+            fields.push_back({ 2, 2 });
+        else if (child->getType() == AST_INPUT && child->hasFlag(ASTF_CONFLATE))
+            fields.push_back({ 4, 4 });
+    }
+
+    if (countActorInputs(actor) > 0)
+        fields.push_back({ 2, 2 });
+
+    return fields;
+}
+
+/// <summary>
+/// Estimates the size and alignment of a structure.
+/// </summary>
+/// <param name="fields">Field layouts, in declaration order.</param>
+/// <param name="reorder">Compute it for fields sorted by descending alignment, as 
+/// 'structFieldsCodegen' emits them.</param>
+FieldLayout estimateStructLayout(std::vector<FieldLayout> fields, bool reorder)
+{
+    FieldLayout result = { 0, 1 };
+
+    if (reorder)
+    {
+        stable_sort(fields.begin(), fields.end(), [](const FieldLayout& a, const FieldLayout& b) {
+            return a.align > b.align;
+        });
+    }
+
+    for (auto& field : fields)
+    {
+        result.size = (result.size + field.align - 1) / field.align * field.align + field.size;
+        result.align = max(result.align, field.align);
+    }
+
+    result.size = (result.size + result.align - 1) / result.align * result.align;
+    return result;
+}
+
+/// <summary>
+/// Estimates the size and alignment of a data type in a 32 bit target, including
+/// padding.
+/// </summary>
+/// <param name="type"></param>
+/// <param name="optimized">Use the optimized layout (reordered fields) for the 
+/// structures which are not 'struct[C]'.</param>
+FieldLayout estimateTypeLayout(AstNode* type, bool optimized)
+{
+    switch (type->getType())
+    {
+    case AST_TYPEDEF:
+        return estimateTypeLayout(type->child(0).getPointer(), optimized);
+
+    case AST_TYPE_NAME:
+        return estimateTypeLayout(type->getDataType(), optimized);
+
+    case AST_DEFAULT_TYPE:
+        if (astIsBoolType(type))
+            return { 1, 1 };
+        else if (astIsIntType(type))
+            return { size_t(astGetIntBits(type) / 8), size_t(astGetIntBits(type) / 8) };
+        else
+            return { 4, 4 };
+
+    case AST_TUPLE_DEF:
+    {
+        vector<FieldLayout> fields;
+
+        for (auto& field : type->children())
+            fields.push_back(estimateTypeLayout(field->getDataType(), optimized));
+
+        return estimateStructLayout(fields, optimized && !type->hasFlag(ASTF_EXTERN_C));
+    }
+
+    case AST_ARRAY_DECL:
+    {
+        auto item = estimateTypeLayout(type->child(0)->getDataType(), optimized);
+
+        return { item.size * atoi(type->child(1)->getValue().c_str()), item.align };
+    }
+
+    case AST_MESSAGE_TYPE:
+        return { 2, 2 };
+
+    case AST_ACTOR:
+        return estimateStructLayout(actorFieldLayouts(type, optimized), optimized);
+
+    default:
+        return { 4, 4 };
+    }
+}
+
+/// <summary>
+/// Generates a report of the estimated RAM used by each actor type, with fields
+/// in declaration order and with the optimized layout.
+/// </summary>
+/// <param name="node">AST root</param>
+std::string generateLayoutReport(Ref<AstNode> node)
+{
+    ostringstream   report;
+    auto            actors = astGatherActors(node.getPointer());
+
+    report << "Actor RAM estimate, in bytes, for a 32 bit target.\n";
+    report << "actor\tdeclared\toptimized\n";
+
+    for (auto actor : actors)
+    {
+        report << actor->getName() << "\t" << estimateTypeLayout(actor, false).size
+            << "\t" << estimateTypeLayout(actor, true).size << "\n";
+    }
+
+    return report.str();
+}
+
+/// <summary>
+/// Estimates the memory usage of a program: the worst case stack usage of each actor
+/// input and constructor, and the static RAM.
+/// </summary>
+/// <remarks>
+/// Message handlers run to completion, and messages are posted asynchronously, so the
+/// stack depth of a handler is bounded by its static call graph. Stack usage of
+/// the runtime and of 'C' functions is not included.
+/// </remarks>
+/// <param name="node">AST root</param>
+/// <param name="state">Code generator state, after generating the program code.</param>
+MemoryUsage analyzeMemoryUsage(Ref<AstNode> node, const CodeGeneratorState& state)
+{
+    MemoryUsage					result;
+    map<AstNode*, StackUsage>	cache;
+    set<AstNode*>				callStack;
+
+    for (auto actor : astGatherActors(node.getPointer()))
+    {
+        auto constructor = worstStackUsage(actor, state, callStack, cache);
+
+        constructor.name = actor->getName() + ".constructor";
+        result.handlers.push_back(constructor);
+
+        for (auto child : actor->children())
+        {
+            auto type = child->getType();
+            if (type != AST_INPUT && type != AST_UNNAMED_INPUT)
+                continue;
+
+            auto input = worstStackUsage(child.getPointer(), state, callStack, cache);
+
+            input.name = inputDisplayName(actor, child.getPointer());
+            result.handlers.push_back(input);
+        }
+
+        if (actor->getName() == "_Main")
+            result.actorsRam = estimateTypeLayout(actor, state.optimizeLayout()).size;
+    }
+
+    result.runtimeRam = estimateRuntimeRam();
+    result.constData = estimateConstantData(node);
+
+    return result;
+}
+
+/// <summary>
+/// Computes the worst case stack usage of a function, including its deepest call chain.
+/// </summary>
+/// <param name="function">Function, actor input, or actor (for its constructor).</param>
+/// <param name="callStack">Functions in the current call chain, to detect recursion.</param>
+/// <param name="cache">Already computed bounded usages.</param>
+StackUsage worstStackUsage(
+    AstNode* function,
+    const CodeGeneratorState& state,
+    std::set<AstNode*>& callStack,
+    std::map<AstNode*, StackUsage>& cache)
+{
+    StackUsage	result;
+    auto&		frames = state.stackFrames();
+    auto		itFrame = frames.find(function);
+    auto		itCache = cache.find(function);
+
+    result.name = function->getName();
+
+    if (itCache != cache.end())
+        return itCache->second;
+    else if (function->hasFlag(ASTF_EXTERN_C))
+    {
+        result.callsC = true;
+        return result;
+    }
+    else if (itFrame == frames.end() || callStack.count(function) > 0)
+    {
+        //Recursion, or indirect call.
+        result.bounded = false;
+        return result;
+    }
+
+    result.frame = estimateFrameSize(itFrame->second, state.optimizeLayout());
+
+    size_t deepest = 0;
+
+    callStack.insert(function);
+    for (auto callee : itFrame->second.callees)
+    {
+        auto calleeUsage = worstStackUsage(callee, state, callStack, cache);
+
+        deepest = max(deepest, calleeUsage.worst);
+        result.bounded = result.bounded && calleeUsage.bounded;
+        result.callsC = result.callsC || calleeUsage.callsC;
+    }
+    callStack.erase(function);
+
+    result.worst = result.frame + deepest;
+
+    //Unbounded results depend on the call chain which leads to the function.
+    if (result.bounded)
+        cache[function] = result;
+
+    return result;
+}
+
+/// <summary>
+/// Estimates the size of the stack frame of a generated function, in a 32 bit target.
+/// </summary>
+/// <remarks>
+/// Variables are not assumed to share stack slots, even if they are in disjoint blocks,
+/// so the estimation is an upper bound (at least for the variables which are not
+/// optimized away).
+/// </remarks>
+size_t estimateFrameSize(const StackFrameInfo& frame, bool optimized)
+{
+    //Return address, saved frame pointer, and the two pointer parameters of inputs.
+    const size_t overhead = 16;
+    const size_t pointerSize = 4;
+
+    size_t size = overhead + frame.pointers * pointerSize;
+
+    for (auto type : frame.variables)
+        size += (estimateTypeLayout(type, optimized).size + 3) & ~size_t(3);
+
+    return size;
+}
+
+/// <summary>
+/// Estimates the static RAM used by the runtime, in a 32 bit target. It mirrors the
+/// default configuration of 'pcr.c' (single threaded, no telemetry).
+/// </summary>
+size_t estimateRuntimeRam()
+{
+    const size_t queueSize = 512;       //SYSTEM_QUEUE_SIZE
+    const size_t queueCounters = 20;    //'SystemMsgQueue' fields besides 'data'.
+    const size_t priorityLevels = 4;    //PCR_PRIORITY_LEVELS
+    const size_t maxEndPoints = 256;    //PCR_MAX_ENDPOINTS
+    const size_t endPointSize = 16;     //'EndPointAddress'
+    const size_t blockSize = 256;       //PCR_BLOCK_SIZE
+    const size_t blockCount = 8;        //PCR_BLOCK_COUNT
+
+    const size_t queues = priorityLevels * (queueSize + queueCounters);
+    const size_t discardBuffer = queueSize;
+
+    return queues + discardBuffer + maxEndPoints * endPointSize + blockSize * blockCount;
+}
+
+/// <summary>
+/// Generates a report of the estimated stack usage of each actor input and constructor,
+/// and of the static RAM.
+/// </summary>
+std::string generateMemoryReport(const MemoryUsage& usage)
+{
+    ostringstream   report;
+
+    report << "Stack usage estimate, in bytes, for a 32 bit target.\n";
+    report << "'C' functions and the runtime are not included. '+C' marks handlers which call 'C' functions.\n";
+    report << "handler\tframe\tworst\n";
+
+    for (auto& handler : usage.handlers)
+    {
+        report << handler.name << "\t" << handler.frame << "\t";
+
+        if (handler.bounded)
+            report << handler.worst;
+        else
+            report << "unbounded";
+
+        if (handler.callsC)
+            report << "+C";
+
+        report << "\n";
+    }
+
+    report << "\nStatic RAM estimate, in bytes.\n";
+    report << "actors\t" << usage.actorsRam << "\n";
+    report << "runtime\t" << usage.runtimeRam << "\n";
+    report << "total\t" << usage.totalRam() << "\n";
+
+    report << "\nConstant data estimate (read only memory), in bytes.\n";
+    report << "const\t" << usage.constData << "\n";
+
+    return report.str();
+}
+
+/// <summary>
+/// Generates the actor constructor function.
+/// </summary>
+/// <param name="node"></param>
+/// <param name="state"></param>
+void generateActorConstructor(Ref<AstNode> node, CodeGeneratorState& state)
+{
+    string actorCName = state.cname(node);
+    string fnCName = actorCName + "_constructor";
+
+    //Necessary because initialization expression may require temporaries.
+    CodegenBlock	functionBlock(state);
+    CodegenFrame	frame(state, node.getPointer());
+
+    //generateParamsStruct(node, state, "actor");
+
+    const int inputCount = countActorInputs(node.getPointer());
+
+    if (inputCount > 0)
+        generateActorInputTable(node, state);
+
+    //Header
+    state.output() << "//Code for '" << node->getName() << "' actor constructor\n";
+    state.output() << genInputMsgHeader(node, node, state, fnCName) << "{\n";
+
+    if (inputCount > 0)
+    {
+        state.output() << "_gen_actor->_gen_firstEndPoint = pcr_registerActor (_gen_actor, "
+            << actorCName << "_inputs, " << inputCount << ");\n";
+    }
+
+    //Copy parameters
+    auto params = astGetParameters(node.getPointer());
+
+    if (params->childCount() > 0)
+        state.output() << "_gen_actor->params = *_gen_params;\n";
+
+    //Conflating inputs have no pending message
+    for (auto child : node->children())
+    {
+        if (child->getType() == AST_INPUT && child->hasFlag(ASTF_CONFLATE))
+            state.output() << "_gen_actor->" << state.cname(child) << "_pending = -1;\n";
+    }
+
+    state.output() << "\n";
+
+    //Initialice members
+    const size_t count = node->childCount();
+    for (size_t i = 1; i < count; ++i)
+    {
+        auto child = node->child(i);
+        auto childType = child->getType();
+
+        if (childType == AST_DECLARATION && !isConstantData(child.getPointer()))
+        {
+            NamedVariable memberVar(child, state);
+
+            codegen(child->child(1), state, memberVar);
+        }
+        else if (childType == AST_UNNAMED_INPUT)
+        {
+            generateConnection(node, child, state);
+        }
+    }
+
+    state.output() << "}\n\n";
+}
+
+/// <summary>
+/// Generates the table which describes the inputs of an actor type, used to register
+/// them in the end point table.
+/// </summary>
+void generateActorInputTable(Ref<AstNode> node, CodeGeneratorState& state)
+{
+    string actorCName = state.cname(node);
+
+    state.output() << "static const PcrInputInfo " << actorCName << "_inputs[] = {\n";
+
+    for (auto child : node->children())
+    {
+        auto type = child->getType();
+        if (type != AST_INPUT && type != AST_UNNAMED_INPUT)
+            continue;
+
+        state.output() << "{(void*)" << state.cname(child) << ", " << astGetInputPriority(child.getPointer()) << ", ";
+
+        if (child->hasFlag(ASTF_CONFLATE))
+            state.output() << "offsetof(" << actorCName << ", " << state.cname(child) << "_pending)";
+        else
+            state.output() << "-1";
+
+        state.output() << "},\n";
+    }
+
+    state.output() << "};\n\n";
+}
+
+/// <summary>
+/// Assigns each input of an actor (named and unnamed) its index in the end point 
+/// table entries of the actor instances.
+/// </summary>
+void assignEndPointIndexes(AstNode* actor, CodeGeneratorState& state)
+{
+    int index = 0;
+
+    for (auto child : actor->children())
+    {
+        auto type = child->getType();
+        if (type == AST_INPUT || type == AST_UNNAMED_INPUT)
+            state.setEndPointIndex(child.getPointer(), index++);
+    }
+}
+
+/// <summary>
+/// Counts the inputs of an actor (named and unnamed)
+/// </summary>
+int countActorInputs(AstNode* actor)
+{
+    int count = 0;
+
+    for (auto child : actor->children())
+    {
+        auto type = child->getType();
+        if (type == AST_INPUT || type == AST_UNNAMED_INPUT)
+            ++count;
+    }
+
+    return count;
+}
+
+/// <summary>
+/// Generates the code for actor inputs (named and unnamed)
+/// </summary>
+/// <param name="node"></param>
+/// <param name="state"></param>
+void generateActorInputs(Ref<AstNode> node, CodeGeneratorState& state)
+{
+    for (auto child : node->children())
+    {
+        auto type = child->getType();
+        if (type == AST_INPUT || type == AST_UNNAMED_INPUT)
+            generateActorInput(node, child, state);
+    }
+}
+
+/// <summary>
+/// Generates code for an actor input (named and unnamed)
+/// </summary>
+void generateActorInput(Ref<AstNode> actor, Ref<AstNode> input, CodeGeneratorState& state)
+{
+    string actorCName = state.cname(actor);
+    string fnCName = state.cname(input);
+
+    //Declare a block for temporaries.
+    CodegenBlock	functionBlock(state);
+    CodegenFrame	frame(state, input.getPointer());
+
+    //Header
+    state.output() << "//Code for '" << input->getName() << "' input message\n";
+    state.output() << genInputMsgHeader(actor, input, state) << "{\n";
+    profileEnterCodegen(input.getPointer(), state);
+
+    codegen(astGetFunctionBody(input.getPointer()), state, VoidVariable());
+
+    profileExitCodegen(state);
+    state.output() << "}\n\n";
+}
+
+/// <summary>
+/// Generates the code which connects and output to an input.
+/// </summary>
+void generateConnection(Ref<AstNode> actor, Ref<AstNode> connection, CodeGeneratorState& state)
+{
+    string strPath = "_gen_actor->" + connectionOutputPath(actor.getPointer(), connection.getPointer(), state);
+
+    state.output() << strPath << " = _gen_actor->_gen_firstEndPoint + "
+        << state.endPointIndex(connection.getPointer()) << ";\n";
+}
+
+
+
+/// <summary>
+/// Gets the 'C' path of the output connected to an unnamed input, relative to
+/// the actor which contains the unnamed input.
+/// </summary>
+std::string connectionOutputPath(AstNode* actor, AstNode* connection, CodeGeneratorState& state)
+{
+    vector<string>	path;
+    auto			type = actor->getDataType();
+
+    for (auto pathNode : connection->child(0)->children())
+    {
+        const int index = astFindMemberByName(type, pathNode->getName());
+        assert(index >= 0);
+        auto child = type->child(index);
+
+        path.push_back(state.cname(child));
+
+        type = child->getDataType();
+    }
+
+    return join(path, ".");
+}
+
+/// <summary>
+/// Checks if the actor graph below an actor is fixed at compile time: all actor
+/// members are created by constructor calls with literal parameters.
+/// </summary>
+bool isStaticActor(AstNode* actor)
+{
+    for (auto child : actor->children())
+    {
+        if (child->getType() != AST_DECLARATION || child->getDataType()->getType() != AST_ACTOR)
+            continue;
+
+        if (staticConstructorCall(child.getPointer()) == nullptr)
+            return false;
+        if (!isStaticActor(child->getDataType()))
+            return false;
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Gets the actor constructor call which initializes an actor member, if it can be 
+/// evaluated at compile time.
+/// </summary>
+/// <returns>The call node, or NULL if the member is not initialized by a constructor
+/// call with literal parameters.</returns>
+AstNode* staticConstructorCall(AstNode* declaration)
+{
+    if (!declaration->childExists(1))
+        return nullptr;
+
+    auto call = declaration->child(1);
+    if (call->getType() != AST_FNCALL || call->child(0)->getType() != AST_IDENTIFIER)
+        return nullptr;
+
+    auto fnType = call->child(0)->getReference()->getDataType();
+    if (fnType->getType() != AST_ACTOR)
+        return nullptr;
+
+    for (auto param : call->child(1)->children())
+    {
+        if (!isLiteralNode(param.getPointer()))
+            return nullptr;
+    }
+
+    return call.getPointer();
+}
+
+/// <summary>
+/// Checks if a node is a literal which can be used in a 'C' static initializer.
+/// </summary>
+bool isLiteralNode(AstNode* node)
+{
+    switch (node->getType())
+    {
+    case AST_INTEGER:
+    case AST_FLOAT:
+    case AST_BOOL:
+    case AST_STRING:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/// <summary>
+/// Gets the 'C' text of a literal node.
+/// </summary>
+std::string literalText(AstNode* node)
+{
+    if (node->getType() == AST_STRING)
+        return escapeString(node->getValue(), true);
+    else
+        return node->getValue();
+}
+
+/// <summary>
+/// Walks the actor graph, assigning end point identifiers to the instances (in 
+/// pre-order, as constructors register them) and resolving the connections.
+/// </summary>
+/// <param name="actor">Actor type of the instance.</param>
+/// <param name="params">Constructor parameters expression. NULL if none.</param>
+/// <param name="path">'C' path of the instance.</param>
+/// <param name="graph"></param>
+/// <param name="state"></param>
+void buildStaticActorGraph(
+    AstNode* actor,
+    AstNode* params,
+    const std::string& path,
+    StaticActorGraph& graph,
+    CodeGeneratorState& state)
+{
+    StaticActorGraph::Instance  instance = { actor, params, graph.endPointCount };
+
+    graph.instances[path] = instance;
+    graph.paths.push_back(path);
+    graph.endPointCount += countActorInputs(actor);
+
+    for (auto child : actor->children())
+    {
+        if (child->getType() == AST_DECLARATION && child->getDataType()->getType() == AST_ACTOR)
+        {
+            auto call = staticConstructorCall(child.getPointer());
 
-    TempVariable lexprResult(ltype, state, true);
-    codegen(lexpr, state, lexprResult);
+            buildStaticActorGraph(child->getDataType(),
+                call->child(1).getPointer(),
+                path + "." + state.cname(child),
+                graph,
+                state);
+        }
+        else if (child->getType() == AST_UNNAMED_INPUT)
+        {
+            const string output = path + "." + connectionOutputPath(actor, child.getPointer(), state);
 
-    state.output() << resultDest << ".actorPtr = " << lexprResult << ";\n";
-    state.output() << resultDest << ".inputPtr = (void*)" << state.cname(rnode) << ";\n";
+            graph.connections[output] = instance.firstEndPoint + state.endPointIndex(child.getPointer());
+        }
+    }
 }
 
 /// <summary>
-/// Generates code for a binary operation
+/// Generates the actor graph of the entry point actor as constant initialized data:
+/// the actor instances, and the end point table. The constructors are not called;
+/// the boot functions ('_init') only run the initializations which are not literals.
 /// </summary>
-void binaryOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+/// <remarks>
+/// It defines 'PCR_STATIC_ACTOR_GRAPH', which selects the static initialization
+/// code in the platform epilog.
+/// </remarks>
+void generateStaticActorGraph(AstNode* mainActor, CodeGeneratorState& state)
 {
-    if (resultDest.isVoid())
-        return;
+    const string        root = "_gen_mainActor";
+    StaticActorGraph    graph;
+    set<AstNode*>       initGenerated;
 
-    auto leftExpr = node->child(0);
-    auto rightExpr = node->child(1);
-    auto operation = node->getValue();
+    buildStaticActorGraph(mainActor, nullptr, root, graph, state);
 
-    TempVariable	leftTmp(leftExpr, state, false);
-    TempVariable	rightTmp(rightExpr, state, false);
+    //Children instances are after their parents, so boot functions are defined
+    //before they are called.
+    for (auto it = graph.paths.rbegin(); it != graph.paths.rend(); ++it)
+    {
+        auto actor = graph.instances.at(*it).actor;
 
-    codegen(leftExpr, state, leftTmp);
-    codegen(rightExpr, state, rightTmp);
+        if (initGenerated.insert(actor).second)
+            generateActorInit(actor, state);
+    }
 
-    state.output() << resultDest << " = ";
-    state.output() << leftTmp.cname() << operation << rightTmp.cname() << ";\n";
-}
+    state.output() << "//Statically initialized actor graph\n";
+    state.output() << "static " << state.cname(mainActor) << " " << root << " = ";
+    generateStaticInitializer(root, graph, state);
+    state.output() << ";\n\n";
 
+    state.output() << "static const PcrEndPoint _gen_endPoints[] = {\n";
+    state.output() << "{NULL, NULL, 0, NULL},\n";
 
-/// <summary>
-/// Generates code for a prefix operator
-/// </summary>
-void prefixOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
-{
-    auto child = node->child(0);
-    auto operation = node->getValue();
-    bool needsRef = (operation == "++" || operation == "--");
+    for (auto& path : graph.paths)
+    {
+        auto actor = graph.instances.at(path).actor;
 
-    TempVariable	temp(child, state, needsRef);
+        for (auto child : actor->children())
+        {
+            auto type = child->getType();
+            if (type != AST_INPUT && type != AST_UNNAMED_INPUT)
+                continue;
 
-    codegen(child, state, temp);
+            state.output() << "{(void*)&" << path << ", (void*)" << state.cname(child) << ", "
+                << astGetInputPriority(child.getPointer()) << ", ";
 
-    if (!resultDest.isVoid())
-        state.output() << resultDest << " = ";
+            if (child->hasFlag(ASTF_CONFLATE))
+                state.output() << "&" << path << "." << state.cname(child) << "_pending";
+            else
+                state.output() << "NULL";
 
-    state.output() << operation;
-    if (needsRef)
-        state.output() << "*";
-    state.output() << temp << ";\n";
-}
+            state.output() << "},\n";
+        }
+    }
 
+    state.output() << "};\n";
+    state.output() << "#define PCR_STATIC_ACTOR_GRAPH\n\n";
+}
 
 /// <summary>
-/// Generates code for a postfix operator
+/// Generates the static initializer of an actor instance of the graph. Members which 
+/// are not initialized by literals are left to zero, and set by the boot functions.
 /// </summary>
-void postfixOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+void generateStaticInitializer(const std::string& path, const StaticActorGraph& graph, CodeGeneratorState& state)
 {
-    auto child = node->child(0);
-    auto operation = node->getValue();
+    auto&   instance = graph.instances.at(path);
+    auto    actor = instance.actor;
 
-    TempVariable	temp(child, state, true);
+    state.output() << "{\n";
 
-    codegen(child, state, temp);
+    if (instance.params != nullptr && instance.params->childCount() > 0)
+    {
+        auto paramsDef = astGetParameters(actor);
 
-    if (!resultDest.isVoid())
-        state.output() << resultDest << " = ";
-    state.output() << "(*" << temp << ")" << operation << ";\n";
+        StringVector    fields;
+
+        for (size_t i = 0; i < instance.params->childCount(); ++i)
+        {
+            fields.push_back("." + state.cname(paramsDef->child(i)) + " = "
+                + literalText(instance.params->child(i).getPointer()));
+        }
+        state.output() << ".params = {" << join(fields, ", ") << "},\n";
+    }
+
+    for (size_t i = 1; i < actor->childCount(); ++i)
+    {
+        auto child = actor->child(i);
+        auto type = child->getType();
+        const string childName = state.cname(child);
+
+        if (type == AST_DECLARATION && !isConstantData(child.getPointer()))
+        {
+            if (child->getDataType()->getType() == AST_ACTOR)
+            {
+                state.output() << "." << childName << " = ";
+                generateStaticInitializer(path + "." + childName, graph, state);
+                state.output() << ",\n";
+            }
+            else if (child->childExists(1) && isLiteralNode(child->child(1).getPointer()))
+                state.output() << "." << childName << " = " << literalText(child->child(1).getPointer()) << ",\n";
+        }
+        else if (type == AST_OUTPUT)
+        {
+            auto it = graph.connections.find(path + "." + childName);
+
+            if (it != graph.connections.end())
+                state.output() << "." << childName << " = " << it->second << ",\n";
+        }
+        else if (type == AST_INPUT && child->hasFlag(ASTF_CONFLATE))
+            state.output() << "." << childName << "_pending = -1,\n";
+    }
+
+    if (countActorInputs(actor) > 0)
+        state.output() << "._gen_firstEndPoint = " << instance.firstEndPoint << "\n";
+
+    state.output() << "}";
 }
 
 /// <summary>
-/// Generates code for the operation to get the address of a variable.
+/// Generates the boot function of an actor of the static graph. It runs the member
+/// initializations which are not literals (they may have side effects), and the boot
+/// functions of the children actors, in declaration order.
 /// </summary>
-void getAddressCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+void generateActorInit(AstNode* actor, CodeGeneratorState& state)
 {
-    auto            child = node->child(0);
-    TempVariable	temp(child, state, true);
+    string actorCName = state.cname(actor);
 
-    codegen(child, state, temp);
+    //Necessary because initialization expression may require temporaries.
+    CodegenBlock	functionBlock(state);
 
-    state.output() << resultDest << " = " << temp << ";\n";
-}
+    state.output() << "//Boot code for '" << actor->getName() << "' actor (static actor graph)\n";
+    state.output() << "static void " << actorCName << "_init(" << actorCName << "* _gen_actor){\n";
 
+    for (size_t i = 1; i < actor->childCount(); ++i)
+    {
+        auto child = actor->child(i);
 
-/// <summary>
-/// Generates the code associated to an actor definition.
-/// </summary>
-void actorCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
-{
-    //generateActorStruct(node, state);
-    generateActorInputs(node, state);
-    generateActorConstructor(node, state);
+        if (child->getType() != AST_DECLARATION || !child->childExists(1) || isConstantData(child.getPointer()))
+            continue;
+
+        if (child->getDataType()->getType() == AST_ACTOR)
+        {
+            state.output() << state.cname(child->getDataType()) << "_init (&_gen_actor->"
+                << state.cname(child) << ");\n";
+        }
+        else if (!isLiteralNode(child->child(1).getPointer()))
+        {
+            NamedVariable memberVar(child, state);
+
+            codegen(child->child(1), state, memberVar);
+        }
+    }
+
+    state.output() << "}\n\n";
 }
 
 /// <summary>
-/// Generates code for an output message.
-/// It defines a 'MessageSlot' in which an input message can be registered.
+/// Checks if a declaration is constant data: a constant initialized from literals.
+/// Constant data is generated as 'static const' objects, which flash based platforms
+/// keep in ROM, instead of being copied into RAM when the actor is constructed.
 /// </summary>
-void outputMessageCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest)
+/// <remarks>
+/// Only tuples are constant data inside functions. Scalar local constants are already
+/// folded by the 'C' compiler. Arrays cannot be initialized from literals yet.
+/// </remarks>
+bool isConstantData(AstNode* declaration)
 {
-    string name = state.cname(node);
+    if (declaration->getType() != AST_DECLARATION || !declaration->hasFlag(ASTF_CONST))
+        return false;
+    if (declaration->hasFlag(ASTF_FUNCTION_PARAMETER) || !declaration->childExists(1))
+        return false;
 
-    state.output() << "MessageSlot " << name << ";\n";
-}
+    auto type = declaration->getDataType();
+
+    if (!declaration->hasFlag(ASTF_ACTOR_MEMBER) && !astIsTupleType(type))
+        return false;
 
+    return isConstantInitializer(declaration->child(1).getPointer(), type);
+}
 
 /// <summary>
-/// Generates the data structure which contains the actor data.
+/// Checks if an expression designates constant data, or a member of it. References
+/// to these objects shall be 'const' pointers, as they are 'static const' in 'C'.
 /// </summary>
-void generateActorStruct(AstNode* type, CodeGeneratorState& state)
+bool isConstantDataAccess(AstNode* expr)
 {
-    string name = state.cname(type);
-
-    state.output() << "typedef struct " << "{\n";
-
-    auto params = astGetParameters(type);
-
-    if (params->childCount() > 0)
+    if (expr->getType() == AST_MEMBER_ACCESS)
+        return isConstantDataAccess(expr->child(0).getPointer());
+    else if (expr->getType() == AST_IDENTIFIER)
     {
-        string paramsTypeName = state.cname(params);
-        state.output() << paramsTypeName << " params;\n";
+        auto referenced = expr->getReference();
+        return referenced != nullptr && isConstantData(referenced);
     }
+    else
+        return false;
+}
 
-    for (size_t i = 1; i < type->childCount(); ++i)
+/// <summary>
+/// Checks if an expression can be the static initializer of a 'type' object:
+/// numeric and boolean literals, and tuples of them.
+/// </summary>
+bool isConstantInitializer(AstNode* expr, AstNode* type)
+{
+    if (astIsTupleType(type))
     {
-        auto child = type->child(i);
-        if (child->getType() == AST_DECLARATION)
-        {
-            string childName = state.cname(child);
-            string childTypeName = state.cname(child->getDataType());
+        if (expr->getType() == AST_TUPLE_ADAPTER)
+            expr = expr->child(0).getPointer();
 
-            state.output() << childTypeName << " " << childName << ";\n";
-        }
-        else if (child->getType() == AST_OUTPUT)
+        if (expr->getType() != AST_TUPLE || type->childCount() == 0
+            || expr->childCount() != type->childCount())
         {
-            string childName = state.cname(child);
+            return false;
+        }
 
-            state.output() << "MessageSlot " << childName << ";\n";
+        for (size_t i = 0; i < expr->childCount(); ++i)
+        {
+            if (!isConstantInitializer(expr->child(i).getPointer(), type->child(i)->getDataType()))
+                return false;
         }
+        return true;
     }
+    else if (expr->getType() == AST_PREFIXOP && expr->getValue() == "-")
+    {
+        auto operandType = expr->child(0)->getType();
 
-    state.output() << "}" << name << ";\n\n";
+        return operandType == AST_INTEGER || operandType == AST_FLOAT;
+    }
+    else
+        return isLiteralNode(expr) && expr->getType() != AST_STRING;
 }
 
 /// <summary>
-/// Generates the actor constructor function.
+/// Gets the 'C' static initializer of a constant data object.
 /// </summary>
-/// <param name="node"></param>
-/// <param name="state"></param>
-void generateActorConstructor(Ref<AstNode> node, CodeGeneratorState& state)
+/// <remarks>
+/// Tuple fields are designated by name, as they may be reordered in the 'C' structure.
+/// </remarks>
+std::string constantInitializerText(AstNode* expr, AstNode* type, CodeGeneratorState& state)
 {
-    string actorCName = state.cname(node);
-    string fnCName = actorCName + "_constructor";
+    if (astIsTupleType(type))
+    {
+        if (expr->getType() == AST_TUPLE_ADAPTER)
+            expr = expr->child(0).getPointer();
 
-    //Necessary because initialization expression may require temporaries.
-    CodegenBlock	functionBlock(state);
+        StringVector	fields;
 
-    //generateParamsStruct(node, state, "actor");
+        for (size_t i = 0; i < type->childCount(); ++i)
+        {
+            auto field = type->child(i);
 
-    //Header
-    state.output() << "//Code for '" << node->getName() << "' actor constructor\n";
-    state.output() << genInputMsgHeader(node, node, state, fnCName) << "{\n";
+            fields.push_back("." + state.cname(field) + " = "
+                + constantInitializerText(expr->child(i).getPointer(), field->getDataType(), state));
+        }
 
-    //Copy parameters
-    auto params = astGetParameters(node.getPointer());
+        return "{" + join(fields, ", ") + "}";
+    }
+    else if (expr->getType() == AST_PREFIXOP)
+        return "-" + literalText(expr->child(0).getPointer());
+    else
+        return literalText(expr);
+}
 
-    if (params->childCount() > 0)
-        state.output() << "_gen_actor->params = *_gen_params;\n";
+/// <summary>
+/// Generates a constant data declaration, as a 'static const' object in the
+/// platform defined section ('PCR_CONST_DATA').
+/// </summary>
+void constantDataCodegen(AstNode* declaration, CodeGeneratorState& state)
+{
+    auto type = declaration->getDataType();
 
-    state.output() << "\n";
+    state.output() << "PCR_CONST_DATA static const " << state.cname(type) << " "
+        << state.cname(declaration) << " = "
+        << constantInitializerText(declaration->child(1).getPointer(), type, state) << ";\n";
+}
 
-    //Initialice members
-    const size_t count = node->childCount();
-    for (size_t i = 1; i < count; ++i)
+/// <summary>
+/// Generates the constant data members of an actor. They are shared by all its
+/// instances, and read directly by the actor code.
+/// </summary>
+void generateActorConstants(Ref<AstNode> actor, CodeGeneratorState& state)
+{
+    bool first = true;
+
+    for (auto child : actor->children())
     {
-        auto child = node->child(i);
-        auto childType = child->getType();
+        if (!isConstantData(child.getPointer()))
+            continue;
 
-        if (childType == AST_DECLARATION)
-        {
-            NamedVariable memberVar(child, state);
+        if (first)
+            state.output() << "//Constant data of '" << actor->getName() << "' actor\n";
+        first = false;
 
-            codegen(child->child(1), state, memberVar);
-        }
-        else if (childType == AST_UNNAMED_INPUT)
-        {
-            generateConnection(node, child, state);
-        }
+        constantDataCodegen(child.getPointer(), state);
     }
 
-    state.output() << "}\n\n";
+    if (!first)
+        state.output() << "\n";
 }
 
 /// <summary>
-/// Generates the code for actor inputs (named and unnamed)
+/// Estimates the size of the constant data of a program, for a 32 bit target.
 /// </summary>
-/// <param name="node"></param>
-/// <param name="state"></param>
-void generateActorInputs(Ref<AstNode> node, CodeGeneratorState& state)
+size_t estimateConstantData(Ref<AstNode> node)
 {
+    size_t result = 0;
+
     for (auto child : node->children())
     {
-        auto type = child->getType();
-        if (type == AST_INPUT || type == AST_UNNAMED_INPUT)
-            generateActorInput(node, child, state);
+        //Top level constants and generic definitions are not generated.
+        if (child.isNull() || child->getType() == AST_GENERIC)
+            continue;
+        if (child->getType() == AST_DECLARATION && node->getType() == AST_SCRIPT)
+            continue;
+
+        if (isConstantData(child.getPointer()))
+            result += estimateTypeLayout(child->getDataType(), true).size;
+        else
+            result += estimateConstantData(child);
     }
+
+    return result;
 }
 
 /// <summary>
-/// Generates code for an actor input (named and unnamed)
+/// Generates the table of actor input names used by the runtime traces. It is
+/// only compiled if 'PCR_TRACE' is defined.
 /// </summary>
-void generateActorInput(Ref<AstNode> actor, Ref<AstNode> input, CodeGeneratorState& state)
+void generateTraceSymbols(const std::vector<AstNode*>& actors, CodeGeneratorState& state)
 {
-    string actorCName = state.cname(actor);
-    string fnCName = state.cname(input);
+    state.output() << "#ifdef PCR_TRACE\n";
+    state.output() << "//Actor input names, for runtime traces.\n";
+    state.output() << "const PcrTraceSymbol pcr_traceSymbols[] = {\n";
 
-    //Declare a block for temporaries.
-    CodegenBlock	functionBlock(state);
+    for (auto actor : actors)
+    {
+        for (auto child : actor->children())
+        {
+            auto type = child->getType();
+            if (type != AST_INPUT && type != AST_UNNAMED_INPUT)
+                continue;
 
-    //Header
-    state.output() << "//Code for '" << input->getName() << "' input message\n";
-    state.output() << genInputMsgHeader(actor, input, state) << "{\n";
+            state.output() << "{(void*)" << state.cname(child) << ", " 
+                << escapeString(inputDisplayName(actor, child.getPointer())) << "},\n";
+        }
+    }
 
-    codegen(astGetFunctionBody(input.getPointer()), state, VoidVariable());
+    state.output() << "{NULL, NULL}\n";
+    state.output() << "};\n";
+    state.output() << "#endif\n\n";
+}
 
-    state.output() << "}\n\n";
+/// <summary>
+/// Gets the name of an actor input, as shown in traces and reports. Unnamed inputs 
+/// are named after the output they are connected to.
+/// </summary>
+std::string inputDisplayName(AstNode* actor, AstNode* input)
+{
+    if (input->getType() == AST_INPUT)
+        return actor->getName() + "." + input->getName();
+
+    StringVector path;
+
+    for (auto pathNode : input->child(0)->children())
+        path.push_back(pathNode->getName());
+
+    return actor->getName() + ".(" + join(path, ".") + ")";
 }
 
 /// <summary>
-/// Generates the code which connects and output to an input.
+/// Generates the profile table of instrumented code, and assigns each function 
+/// and actor input its entry.
 /// </summary>
-void generateConnection(Ref<AstNode> actor, Ref<AstNode> connection, CodeGeneratorState& state)
+void generateProfileTable(
+    const std::vector<AstNode*>& functions, 
+    const std::vector<AstNode*>& actors, 
+    CodeGeneratorState& state)
 {
-    vector<string>	path;
-    auto			type = actor->getDataType();
+    vector<string>	names;
 
-    for (auto pathNode : connection->child(0)->children())
+    for (auto fn : functions)
     {
-        const int index = astFindMemberByName(type, pathNode->getName());
-        assert(index >= 0);
-        auto child = type->child(index);
+        if (fn->hasFlag(ASTF_EXTERN_C))
+            continue;
 
-        path.push_back(state.cname(child));
+        state.setProfileIndex(fn, (int)names.size());
+        names.push_back(fn->getName());
+    }
 
-        type = child->getDataType();
+    for (auto actor : actors)
+    {
+        for (auto child : actor->children())
+        {
+            auto type = child->getType();
+            if (type != AST_INPUT && type != AST_UNNAMED_INPUT)
+                continue;
+
+            state.setProfileIndex(child.getPointer(), (int)names.size());
+            names.push_back(inputDisplayName(actor, child.getPointer()));
+        }
     }
 
-    string strPath = "_gen_actor->" + join(path, ".");
+    state.output() << "//Profile counters of functions and actor inputs.\n";
+    state.output() << "static PcrProfileEntry _gen_profileTable[] = {\n";
+
+    for (auto& name : names)
+        state.output() << "{" << escapeString(name) << ", 0, 0, 0},\n";
+
+    state.output() << "{NULL, 0, 0, 0}\n";
+    state.output() << "};\n\n";
+}
+
+/// <summary>
+/// Generates the entry hook of a profiled function: it reads the cycle counter.
+/// It does nothing if the code is not instrumented.
+/// </summary>
+/// <param name="function">Function or actor input.</param>
+void profileEnterCodegen(AstNode* function, CodeGeneratorState& state)
+{
+    const int index = state.profileIndex(function);
+
+    state.setCurrentProfileIndex(index);
 
-    state.output() << strPath << ".actorPtr = (void*)_gen_actor;\n";
-    state.output() << strPath << ".inputPtr = (void*)" << state.cname(connection) << ";\n";
+    if (index >= 0)
+        state.output() << "const unsigned long long _gen_profileStart = system_cycles();\n";
 }
 
+/// <summary>
+/// Generates the exit hook of the profiled function being generated. It shall be 
+/// emitted before each 'return'.
+/// </summary>
+void profileExitCodegen(CodeGeneratorState& state)
+{
+    const int index = state.currentProfileIndex();
 
+    if (index >= 0)
+        state.output() << "pcr_profileExit (_gen_profileTable, " << index << ", _gen_profileStart);\n";
+}
 
 /// <summary>
 /// Generates the expression need to access a variable. 
@@ -1045,11 +2755,20 @@ void generateConnection(Ref<AstNode> actor, Ref<AstNode> connection, CodeGenerat
 /// <returns></returns>
 std::string varAccessExpression(Ref<AstNode> node, CodeGeneratorState& state)
 {
-    string namePrefix = "";
+    return declarationAccessExpression(node->getReference(), state);
+}
 
-    auto referenced = node->getReference();
+/// <summary>
+/// Generates the expression needed to access a declared variable.
+/// </summary>
+/// <param name="referenced">Declaration node</param>
+/// <param name="state"></param>
+/// <returns></returns>
+std::string declarationAccessExpression(AstNode* referenced, CodeGeneratorState& state)
+{
+    string namePrefix = "";
 
-    if (referenced->hasFlag(ASTF_ACTOR_MEMBER))
+    if (referenced->hasFlag(ASTF_ACTOR_MEMBER) && !isConstantData(referenced))
     {
         if (referenced->hasFlag(ASTF_FUNCTION_PARAMETER))
             namePrefix = "_gen_actor->params.";
@@ -10,6 +10,7 @@
 #include "ast.h"
 #include <string>
 #include <map>
+#include <vector>
 
 /// <summary>
 /// Struture which contains configuration parameters of code generator.
@@ -22,7 +23,63 @@ struct CodeGeneratorConfig
     //Prolog and epilog to be added to genrated 'C' source.
     std::string     prolog;
     std::string     epilog;
+
+    //Messages whose parameters are larger than this size (in bytes) are posted in
+    //runtime pool blocks, by reference, instead of being copied to the message queue.
+    size_t          blockParamsThreshold = 64;
+
+    //Size of the runtime pool blocks ('PCR_BLOCK_SIZE'). Messages whose parameters do
+    //not fit in a block are always copied to the message queue.
+    size_t          blockSize = 256;
+
+    //If the program has an entry point actor ('_Main') and its actor graph is fixed
+    //at compile time, it is emitted as constant initialized data. Only side effecting
+    //initialization runs at boot.
+    bool            staticActorGraph = true;
+
+    //Sorts the fields of actors and tuples by alignment, to remove padding.
+    //'struct[C]' types, and parameters of 'C' functions keep declaration order.
+    bool            optimizeLayout = true;
+
+    //Array indexes are checked at runtime. Accesses which range analysis proves to be
+    //in bounds are not checked.
+    bool            boundsChecks = true;
+
+    //Functions and actor inputs count their calls and execution cycles, in the 
+    //'pcr_profileTable' table, which the runtime writes on exit.
+    bool            instrument = false;
+};
+
+/// <summary>
+/// Worst case stack usage of an actor input or constructor, in bytes.
+/// </summary>
+struct StackUsage
+{
+    std::string     name;
+    size_t          frame = 0;          //Own stack frame.
+    size_t          worst = 0;          //Including the deepest call chain.
+    bool            bounded = true;     //false if there is recursion, or indirect calls.
+    bool            callsC = false;     //Calls 'C' functions, whose stack usage is unknown.
+};
+
+/// <summary>
+/// Memory usage estimation of a program, for a 32 bit target.
+/// </summary>
+struct MemoryUsage
+{
+    std::vector<StackUsage> handlers;
+    size_t                  actorsRam = 0;      //Entry point actor ('_Main') instance.
+    size_t                  runtimeRam = 0;     //Runtime queues and tables.
+    size_t                  constData = 0;      //'static const' objects, not in RAM.
+
+    size_t totalRam()const
+    {
+        return actorsRam + runtimeRam;
+    }
 };
 
 std::string generateCode(Ref<AstNode> node);
 std::string generateCode(Ref<AstNode> node, const CodeGeneratorConfig& config);
+std::string generateCode(Ref<AstNode> node, const CodeGeneratorConfig& config, MemoryUsage& usage);
+std::string generateLayoutReport(Ref<AstNode> node);
+std::string generateMemoryReport(const MemoryUsage& usage);
@@ -8,6 +8,7 @@
 
 class CodeGeneratorState;
 struct IVariableInfo;
+class TempVariable;
 
 typedef void(*NodeCodegenFN)(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
 
@@ -29,12 +30,70 @@ void tupleDefCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariab
 void tupleDefCodegen(AstNode* type, CodeGeneratorState& state);
 void arrayTypeCodegen(AstNode* type, CodeGeneratorState& state);
 
+/// <summary>
+/// Estimated size and alignment of a type, in bytes.
+/// </summary>
+struct FieldLayout
+{
+    size_t  size;
+    size_t  align;
+};
+
+/// <summary>
+/// Field of a generated 'C' structure.
+/// </summary>
+struct StructField
+{
+    std::string     declaration;
+    FieldLayout     layout;
+};
+
+void structFieldsCodegen(std::vector<StructField>& fields, bool reorder, CodeGeneratorState& state);
+void markCLayoutTypes(const std::vector<AstNode*>& functions, CodeGeneratorState& state);
+std::vector<FieldLayout> actorFieldLayouts(AstNode* actor, bool optimized);
+FieldLayout estimateStructLayout(std::vector<FieldLayout> fields, bool reorder);
+FieldLayout estimateTypeLayout(AstNode* type, bool optimized);
+
+struct StackFrameInfo;
+
+MemoryUsage analyzeMemoryUsage(Ref<AstNode> node, const CodeGeneratorState& state);
+StackUsage worstStackUsage(
+    AstNode* function,
+    const CodeGeneratorState& state,
+    std::set<AstNode*>& callStack,
+    std::map<AstNode*, StackUsage>& cache);
+size_t estimateFrameSize(const StackFrameInfo& frame, bool optimized);
+size_t estimateRuntimeRam();
+
 void tupleAdapterCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+void tupleCopyCodegen(const IVariableInfo& dest, const IVariableInfo& src, CodeGeneratorState& state);
+bool tupleLayoutsDiffer(AstNode* typeA, AstNode* typeB, CodeGeneratorState& state);
 void ifCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+void selectCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+void forCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+void forEachCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+bool inlineLoopExpression(Ref<AstNode> node, CodeGeneratorState& state, std::string& cExpr);
+std::vector<AstNode*> loopRestrictArrays(AstNode* loop);
+std::vector<AstNode*> arrayBasesCodegen(AstNode* loop, CodeGeneratorState& state);
 void returnCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
 void assignmentCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+void arrayAssignmentCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+void arrayValueCodegen(Ref<AstNode> expr, CodeGeneratorState& state, const IVariableInfo& resultDest);
+std::string elementExpression(
+    Ref<AstNode> expr,
+    const std::string& index,
+    std::vector<std::unique_ptr<TempVariable>>& operands,
+    CodeGeneratorState& state);
+std::string arrayOperandCodegen(
+    Ref<AstNode> expr,
+    std::vector<std::unique_ptr<TempVariable>>& temps,
+    CodeGeneratorState& state);
 void callCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+void reservedPostCodegen(const IVariableInfo& address, Ref<AstNode> paramsExpr, CodeGeneratorState& state);
+void blockPostCodegen(const IVariableInfo& address, Ref<AstNode> paramsExpr, CodeGeneratorState& state);
+bool useBlockPost(AstNode* paramsType, CodeGeneratorState& state);
 void arrayAccessOpCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
+void indexCheckCodegen(Ref<AstNode> node, const IVariableInfo& index, CodeGeneratorState& state);
 void literalCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
 void varAccessCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
 void memberAccessCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
@@ -49,9 +108,62 @@ void actorCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableI
 void outputMessageCodegen(Ref<AstNode> node, CodeGeneratorState& state, const IVariableInfo& resultDest);
 void generateActorStruct(AstNode* type, CodeGeneratorState& state);
 void generateActorConstructor(Ref<AstNode> node, CodeGeneratorState& state);
+void generateActorInputTable(Ref<AstNode> node, CodeGeneratorState& state);
+void assignEndPointIndexes(AstNode* actor, CodeGeneratorState& state);
+int countActorInputs(AstNode* actor);
 void generateActorInputs(Ref<AstNode> node, CodeGeneratorState& state);
 void generateActorInput(Ref<AstNode> actor, Ref<AstNode> input, CodeGeneratorState& state);
 void generateConnection(Ref<AstNode> actor, Ref<AstNode> connection, CodeGeneratorState& state);
+std::string connectionOutputPath(AstNode* actor, AstNode* connection, CodeGeneratorState& state);
+void generateTraceSymbols(const std::vector<AstNode*>& actors, CodeGeneratorState& state);
+std::string inputDisplayName(AstNode* actor, AstNode* input);
+void generateProfileTable(
+    const std::vector<AstNode*>& functions, 
+    const std::vector<AstNode*>& actors, 
+    CodeGeneratorState& state);
+void profileEnterCodegen(AstNode* function, CodeGeneratorState& state);
+void profileExitCodegen(CodeGeneratorState& state);
+
+/// <summary>
+/// Actor graph which is fixed at compile time, and can be emitted as constant
+/// initialized 'C' data.
+/// </summary>
+struct StaticActorGraph
+{
+    /// <summary>An actor instance of the graph.</summary>
+    struct Instance
+    {
+        AstNode*        actor;
+        AstNode*        params;         //Constructor parameters expression. NULL if none.
+        int             firstEndPoint;
+    };
+
+    std::map<std::string, Instance>     instances;      //By 'C' path of the instance.
+    std::vector<std::string>            paths;          //Instances, in end point order.
+    std::map<std::string, int>          connections;    //Output 'C' path -> end point.
+    int                                 endPointCount = 1;
+};
+
+bool isStaticActor(AstNode* actor);
+AstNode* staticConstructorCall(AstNode* declaration);
+bool isLiteralNode(AstNode* node);
+std::string literalText(AstNode* node);
+void buildStaticActorGraph(AstNode* actor,
+    AstNode* params,
+    const std::string& path,
+    StaticActorGraph& graph,
+    CodeGeneratorState& state);
+void generateStaticActorGraph(AstNode* mainActor, CodeGeneratorState& state);
+void generateStaticInitializer(const std::string& path, const StaticActorGraph& graph, CodeGeneratorState& state);
+void generateActorInit(AstNode* actor, CodeGeneratorState& state);
+
+bool isConstantData(AstNode* declaration);
+bool isConstantDataAccess(AstNode* expr);
+bool isConstantInitializer(AstNode* expr, AstNode* type);
+std::string constantInitializerText(AstNode* expr, AstNode* type, CodeGeneratorState& state);
+void constantDataCodegen(AstNode* declaration, CodeGeneratorState& state);
+void generateActorConstants(Ref<AstNode> actor, CodeGeneratorState& state);
+size_t estimateConstantData(Ref<AstNode> node);
 
 std::string genFunctionHeader(Ref<AstNode> node, CodeGeneratorState& state);
 std::string genInputMsgHeader(Ref<AstNode> actor,
@@ -60,3 +172,5 @@ std::string genInputMsgHeader(Ref<AstNode> actor,
     const std::string& nameOverride = "");
 void generateParamsStruct(Ref<AstNode> node, CodeGeneratorState& state, const std::string& commentSufix);
 std::string varAccessExpression(Ref<AstNode> node, CodeGeneratorState& state);
+std::string declarationAccessExpression(AstNode* referenced, CodeGeneratorState& state);
+size_t estimateTypeSize(AstNode* type);
@@ -23,6 +23,8 @@ std::string CodeGeneratorState::cname(AstNode* node)
     case AST_DEFAULT_TYPE:
         if (node->getName() == "Cpointer")
             return "void *";
+        else if (astIsIntType(node) && node->getName() != "int")
+            return node->getName() + "_t";		//'stdint.h' types
         else
             return node->getName();
 
@@ -199,6 +201,13 @@ std::string	CodeGeneratorState::allocCName(std::string base)
             base = base.substr(0, 7) + "__" + base.substr(base.size() - 7, 7);
 
         replaceIn(base, '\'', "1");	// single quotes are illegal in 'C' names.
+
+        //Generic instance names ('Fifo[int,8]') also contain illegal characters.
+        for (auto& c : base)
+        {
+            if (!isalnum((unsigned char)c) && c != '_')
+                c = '_';
+        }
     }
 
     sprintf_s(buffer, bufSize, "%s_%04X", base.c_str(), m_nextSymbolId++);
@@ -240,13 +249,21 @@ std::ostream& operator << (std::ostream& output, const IVariableInfo& var)
 /// </summary>
 /// <param name="type"></param>
 /// <param name="state"></param>
-TempVariable::TempVariable(AstNode* type, CodeGeneratorState& state, bool ref)
+/// <param name="ref">The temporary is a pointer to a value of the given type</param>
+/// <param name="constant">The pointed value is read only ('const' qualified in 'C')</param>
+TempVariable::TempVariable(AstNode* type, CodeGeneratorState& state, bool ref, bool constant)
     : IVariableInfo(ref), m_state(state), m_dataType(type)
 {
     string	cTypeName = state.cname(type);
 
+    //The qualifier is part of the 'C' type name, so constant temporaries are only
+    //reused by other constant temporaries.
+    if (ref && constant)
+        cTypeName = "const " + cTypeName;
+
     if (state.allocTemp(cTypeName, m_cName, ref))
     {
+        state.addFrameVariable(type, ref);
         state.output() << cTypeName;
         if (ref)
             state.output() << "*";
@@ -262,8 +279,8 @@ TempVariable::TempVariable(AstNode* type, CodeGeneratorState& state, bool ref)
 /// </summary>
 /// <param name="node"></param>
 /// <param name="state"></param>
-TempVariable::TempVariable(Ref<AstNode> node, CodeGeneratorState& state, bool ref)
-    :TempVariable(node->getDataType(), state, ref)
+TempVariable::TempVariable(Ref<AstNode> node, CodeGeneratorState& state, bool ref, bool constant)
+    :TempVariable(node->getDataType(), state, ref, constant)
 {
 }
 
@@ -304,6 +321,26 @@ AstNode* NamedVariable::dataType()const
     return m_node->getDataType();
 }
 
+/// <summary>
+/// Constructor for 'PointedVariable'.
+/// </summary>
+PointedVariable::PointedVariable(const IVariableInfo& reference)
+    :IVariableInfo(false), m_type(reference.dataType())
+{
+    assert(reference.isReference);
+
+    m_cName = "(*" + reference.cname() + ")";
+}
+
+const std::string& PointedVariable::cname()const
+{
+    return m_cName;
+}
+AstNode* PointedVariable::dataType()const
+{
+    return m_type;
+}
+
 /// <summary>
 /// Constructor for 'TupleField'. Resolves needed data on invocation.
 /// </summary>
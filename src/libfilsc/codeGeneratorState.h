@@ -6,6 +6,17 @@
 #define FRIEND_TEST(x,y)
 #endif
 
+/// <summary>
+/// Stack usage of a generated function (or actor input, or actor constructor), 
+/// collected during code generation.
+/// </summary>
+struct StackFrameInfo
+{
+    std::vector<AstNode*>   variables;      //Types of local variables and temporaries.
+    int                     pointers = 0;   //Reference temporaries and array base pointers.
+    std::set<AstNode*>      callees;        //Called functions and actor constructors.
+};
+
 /// <summary>Stores code generator state</summary>
 /// <remarks>Most code generator state has to do with assigning names in 'C' source
 /// to FILS variables, and managing local temporary variables.</remarks>
@@ -25,6 +36,161 @@ public:
 
     void setCname(Ref<AstNode> node, const std::string& name);
 
+    size_t blockParamsThreshold()const
+    {
+        return m_blockParamsThreshold;
+    }
+
+    void setBlockParamsThreshold(size_t size)
+    {
+        m_blockParamsThreshold = size;
+    }
+
+    size_t blockSize()const
+    {
+        return m_blockSize;
+    }
+
+    void setBlockSize(size_t size)
+    {
+        m_blockSize = size;
+    }
+
+    /// <summary>
+    /// Name of the '__restrict' pointer to the first element of an array, declared
+    /// by the enclosing loop. Empty if there is none.
+    /// </summary>
+    std::string arrayBase(AstNode* arrayDecl)const
+    {
+        auto it = m_arrayBases.find(arrayDecl);
+
+        return it == m_arrayBases.end() ? std::string() : it->second;
+    }
+
+    std::string allocArrayBase(AstNode* arrayDecl)
+    {
+        return m_arrayBases[arrayDecl] = allocCName(arrayDecl->getName() + "_base");
+    }
+
+    void releaseArrayBase(AstNode* arrayDecl)
+    {
+        m_arrayBases.erase(arrayDecl);
+    }
+
+    void setBoundsChecks(bool value)
+    {
+        m_boundsChecks = value;
+    }
+
+    void setSafeArrayAccesses(const std::set<AstNode*>& accesses)
+    {
+        m_safeArrayAccesses = accesses;
+    }
+
+    /// <summary>
+    /// Checks if an array access needs a runtime check of its index.
+    /// </summary>
+    bool needsIndexCheck(AstNode* access)const
+    {
+        return m_boundsChecks && m_safeArrayAccesses.count(access) == 0;
+    }
+
+    bool optimizeLayout()const
+    {
+        return m_optimizeLayout;
+    }
+
+    void setOptimizeLayout(bool optimize)
+    {
+        m_optimizeLayout = optimize;
+    }
+
+    /// <summary>
+    /// Checks if the fields of a type shall be kept in declaration order, because
+    /// 'C' code depends on it.
+    /// </summary>
+    bool hasCLayout(AstNode* type)const
+    {
+        return type->hasFlag(ASTF_EXTERN_C) || m_cLayoutTypes.count(type) > 0;
+    }
+
+    void setCLayout(AstNode* type)
+    {
+        m_cLayoutTypes.insert(type);
+    }
+
+    /// <summary>
+    /// Index of an input in the end point table entries of its actor instance.
+    /// </summary>
+    int endPointIndex(AstNode* input)const
+    {
+        auto it = m_endPointIndexes.find(input);
+
+        assert(it != m_endPointIndexes.end());
+        return it->second;
+    }
+
+    void setEndPointIndex(AstNode* input, int index)
+    {
+        m_endPointIndexes[input] = index;
+    }
+
+    /// <summary>
+    /// Records a variable declared in the function being generated.
+    /// </summary>
+    void addFrameVariable(AstNode* type, bool ref)
+    {
+        if (m_currentFrame == nullptr)
+            return;
+        else if (ref)
+            m_currentFrame->pointers++;
+        else
+            m_currentFrame->variables.push_back(type);
+    }
+
+    /// <summary>
+    /// Records a call from the function being generated.
+    /// </summary>
+    void addFrameCall(AstNode* callee)
+    {
+        if (m_currentFrame != nullptr)
+            m_currentFrame->callees.insert(callee);
+    }
+
+    /// <summary>
+    /// Index of a function or actor input in the profile table of instrumented code.
+    /// -1 if it is not profiled.
+    /// </summary>
+    int profileIndex(AstNode* function)const
+    {
+        auto it = m_profileIndexes.find(function);
+
+        return it == m_profileIndexes.end() ? -1 : it->second;
+    }
+
+    void setProfileIndex(AstNode* function, int index)
+    {
+        m_profileIndexes[function] = index;
+    }
+
+    /// <summary>
+    /// Profile table index of the function being generated. -1 if it is not profiled.
+    /// </summary>
+    int currentProfileIndex()const
+    {
+        return m_currentProfileIndex;
+    }
+
+    void setCurrentProfileIndex(int index)
+    {
+        m_currentProfileIndex = index;
+    }
+
+    const std::map<AstNode*, StackFrameInfo>& stackFrames()const
+    {
+        return m_stackFrames;
+    }
+
     std::ostream& output()
     {
         return *m_output;
@@ -39,6 +205,7 @@ protected:
 
     friend class TempVariable;
     friend class CodegenBlock;
+    friend class CodegenFrame;
     FRIEND_TEST(CodeGeneratorState, temporaries);
 
 private:
@@ -64,6 +231,18 @@ private:
     std::map< Ref<RefCountObj>, std::string>	m_objNames;
     std::map< TupleMemberKey, std::string>		m_tupleMemberNames;
     int											m_nextSymbolId = 0;
+    size_t										m_blockParamsThreshold = 64;
+    size_t										m_blockSize = 256;
+    std::map< AstNode*, int>					m_endPointIndexes;
+    std::set< AstNode*>							m_cLayoutTypes;
+    std::map< AstNode*, std::string>			m_arrayBases;
+    std::set< AstNode*>							m_safeArrayAccesses;
+    bool										m_optimizeLayout = true;
+    bool										m_boundsChecks = false;
+    std::map< AstNode*, StackFrameInfo>			m_stackFrames;
+    StackFrameInfo*								m_currentFrame = nullptr;
+    std::map< AstNode*, int>					m_profileIndexes;
+    int											m_currentProfileIndex = -1;
 
     std::string		allocCName(std::string base);
     TempVarInfo*	findTemporary(std::function<bool(const TempVarInfo&)> predicate);
@@ -89,6 +268,26 @@ private:
     CodeGeneratorState & m_state;
 };
 
+/// <summary>
+/// Manages the stack usage collection of a generated function.
+/// </summary>
+class CodegenFrame
+{
+public:
+    CodegenFrame(CodeGeneratorState& state, AstNode* function) : m_state(state)
+    {
+        state.m_currentFrame = &state.m_stackFrames[function];
+    }
+
+    ~CodegenFrame()
+    {
+        m_state.m_currentFrame = nullptr;
+    }
+
+private:
+    CodeGeneratorState & m_state;
+};
+
 
 /// <summary>
 /// Interface to get informaiton about variables in code generation.
@@ -118,8 +317,8 @@ std::ostream& operator << (std::ostream& output, const IVariableInfo& var);
 class TempVariable : public IVariableInfo
 {
 public:
-    TempVariable(AstNode* type, CodeGeneratorState& state, bool ref);
-    TempVariable(Ref<AstNode> node, CodeGeneratorState& state, bool ref);
+    TempVariable(AstNode* type, CodeGeneratorState& state, bool ref, bool constant = false);
+    TempVariable(Ref<AstNode> node, CodeGeneratorState& state, bool ref, bool constant = false);
     ~TempVariable();
 
     const std::string& cname()const override
@@ -165,6 +364,22 @@ private:
     std::string			m_cName;
 };
 
+/// <summary>
+/// Class to identify the variable pointed by a reference variable.
+/// </summary>
+class PointedVariable : public IVariableInfo
+{
+public:
+    PointedVariable(const IVariableInfo& reference);
+
+    virtual const std::string&	cname()const override;
+    virtual AstNode*		dataType()const  override;
+
+private:
+    AstNode * m_type;
+    std::string			m_cName;
+};
+
 /// <summary>
 /// Class to identify a tuple field.
 /// </summary>
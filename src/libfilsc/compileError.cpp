@@ -146,6 +146,16 @@ const char * errorTypeTemplate(ErrorTypes type)
         /*ETYPE_INVALID_ARRAY_INDEX*/   "The array index must be a single integer",
         /*ETYPE_INVALID_TUPLE_INDEX*/   "The tuple index must be an integer constant",
         /*ETYPE_TUPLE_INDEX_OUT_OF_RANGE_2*/"Tuple index '%d' is out of range [0, %d)",
+        /*ETYPE_INVALID_INPUT_PRIORITY_2*/"Invalid input priority '%s'. It must be in range [0, %d]",
+        /*ETYPE_ARRAY_INDEX_OUT_OF_RANGE_2*/"Array index '%d' is out of range [0, %d)",
+        /*ETYPE_STACK_BUDGET_EXCEEDED_3*/"Stack usage of '%s' (%s bytes) exceeds the budget (%d bytes)",
+        /*ETYPE_RAM_BUDGET_EXCEEDED_2*/ "Static RAM usage (%d bytes) exceeds the budget (%d bytes)",
+        /*ETYPE_WRONG_GENERIC_PARAMS_COUNT_3*/"'%s' expects %d compile time parameters, but %d were supplied",
+        /*ETYPE_GENERIC_TYPE_PARAMETER_1*/"Compile time parameter '%s' must be a type name",
+        /*ETYPE_GENERIC_CONST_PARAMETER_2*/"Compile time parameter '%s' must be a '%s' literal",
+        /*ETYPE_WRONG_SELECT_TYPE_1*/"'select' expressions must be of an integer type, not '%s'",
+        /*ETYPE_INVALID_CASE_VALUE_1*/"Case values must be integer constants in the range of '%s'",
+        /*ETYPE_DUPLICATED_CASE_VALUE_1*/"Duplicated case value: %s",
 
     };
 
@@ -51,6 +51,16 @@ enum ErrorTypes
     ETYPE_INVALID_ARRAY_INDEX,
     ETYPE_INVALID_TUPLE_INDEX,
     ETYPE_TUPLE_INDEX_OUT_OF_RANGE_2,
+    ETYPE_INVALID_INPUT_PRIORITY_2,
+    ETYPE_ARRAY_INDEX_OUT_OF_RANGE_2,
+    ETYPE_STACK_BUDGET_EXCEEDED_3,
+    ETYPE_RAM_BUDGET_EXCEEDED_2,
+    ETYPE_WRONG_GENERIC_PARAMS_COUNT_3,
+    ETYPE_GENERIC_TYPE_PARAMETER_1,
+    ETYPE_GENERIC_CONST_PARAMETER_2,
+    ETYPE_WRONG_SELECT_TYPE_1,
+    ETYPE_INVALID_CASE_VALUE_1,
+    ETYPE_DUPLICATED_CASE_VALUE_1,
 
     //Add new error types above this line.
     //REMEMBER to add the description to 'errorTypeTemplate' function.
@@ -42,9 +42,8 @@ SemanticResult symbolGatherPass(Ref<AstNode> node, SemAnalysisState& state)
 /// <param name="state"></param>
 void addDefaultTypes(SemAnalysisState& state)
 {
-    state.rootScope->add("int", astGetInt());
-    state.rootScope->add("bool", astGetBool());
-    state.rootScope->add("Cpointer", astGetCPointer());
+    for (auto& name : astGetDefaultTypeNames())
+        state.rootScope->add(name, astGetDefaultType(name));
 }
 
 /// <summary>
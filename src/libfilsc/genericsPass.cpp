@@ -0,0 +1,524 @@
+/// <summary>
+/// Semantic analysis pass which instantiates generic functions and actors.
+/// </summary>
+/// <remarks>
+/// Generic definitions have compile time parameters: types ('T') and constants ('N:int').
+/// Each distinct set of parameter values creates a copy of the definition, in which the
+/// parameters are replaced by their values. Instances are ordinary top level items, named
+/// after their parameters (for example: 'Fifo[int,8]'), so the rest of the compiler
+/// analyzes and generates them as any other function or actor.
+///
+/// The generic node keeps the list of its instances. So the scripts and modules which
+/// use the same parameter values share a single instance. Parameter values are compared
+/// after resolving them: type names by the declaration they reference from the script of
+/// the call, and constants by their value ('16' and '0x10' are the same).
+/// </remarks>
+
+#include "pch.h"
+#include "genericsPass.h"
+#include "semanticAnalysis_internal.h"
+#include "SymbolScope.h"
+#include "semAnalysisState.h"
+#include "scopeCreationPass.h"
+
+using namespace std;
+
+/// <summary>
+/// 'Pass' function which instantiates generics.
+/// </summary>
+/// <param name="node"></param>
+/// <param name="state"></param>
+/// <returns></returns>
+SemanticResult genericsPass(Ref<AstNode> node, SemAnalysisState& state)
+{
+    GenericsPassState	genState(state);
+
+    for (auto script : getScripts(node))
+    {
+        //Instances from imported modules can only be shared if they are already analyzed.
+        auto error = analyzeImportedModules(script);
+
+        if (!error.isOk())
+        {
+            genState.errors.push_back(error);
+            continue;
+        }
+
+        genState.root = node;
+        genState.script = script;
+        genState.generics = gatherGenerics(node, script);
+        genState.localInstances.clear();
+
+        if (genState.generics.empty())
+            continue;
+
+        for (size_t i = 0; i < script->childCount(); ++i)
+        {
+            auto item = script->child(i);
+
+            if (item.notNull() && item->getType() != AST_GENERIC)
+                i += instantiateGenerics(item, i, true, genState);
+        }
+    }
+
+    if (!genState.errors.empty())
+        return SemanticResult(genState.errors);
+    else
+        return SemanticResult(node);
+}
+
+/// <summary>
+/// Gets the script nodes of a module, or the script itself if the node is a script.
+/// </summary>
+/// <param name="node"></param>
+/// <returns></returns>
+AstNodeList getScripts(Ref<AstNode> node)
+{
+    AstNodeList	result;
+
+    if (node->getType() == AST_SCRIPT)
+        result.push_back(node);
+    else if (node->getType() == AST_MODULE)
+    {
+        for (auto child : node->children())
+        {
+            if (child->getType() != AST_SCRIPT)
+                break;
+
+            result.push_back(child);
+        }
+    }
+
+    return result;
+}
+
+/// <summary>
+/// Performs the semantic analysis of the modules imported by a script, if they have
+/// not been analyzed yet.
+/// </summary>
+/// <param name="script"></param>
+/// <returns></returns>
+CompileError analyzeImportedModules(Ref<AstNode> script)
+{
+    for (auto item : script->children())
+    {
+        if (item.isNull() || item->getType() != AST_IMPORT || item->hasFlag(ASTF_EXTERN_C))
+            continue;
+
+        auto module = item->getReference();
+
+        if (module != nullptr && !module->hasFlag(ASTF_TYPECHECKED))
+        {
+            auto r = semanticAnalysis(ref(module));
+
+            if (!r.ok())
+                return r.errors[0];
+        }
+    }
+
+    return CompileError::ok();
+}
+
+/// <summary>
+/// Gathers the generic definitions which can be used from a script.
+/// </summary>
+/// <param name="root">Root node of the semantic analysis. It can be the script
+/// itself, or the module which contains it.</param>
+/// <param name="script"></param>
+/// <returns>Map of generic definitions, by name.</returns>
+AstStr2NodesMap gatherGenerics(Ref<AstNode> root, Ref<AstNode> script)
+{
+    AstStr2NodesMap	result;
+
+    auto addGenerics = [&result](AstNode* container) {
+        for (auto item : container->children())
+        {
+            if (item.notNull() && item->getType() == AST_GENERIC)
+                result[item->getName()] = item;
+        }
+    };
+
+    //Local definitions are added last, to prevail over imported ones.
+    for (auto item : script->children())
+    {
+        if (item.notNull() && item->getType() == AST_IMPORT && item->getReference() != nullptr)
+            addGenerics(item->getReference());
+    }
+
+    if (root->getType() == AST_MODULE)
+        addGenerics(root.getPointer());
+
+    addGenerics(script.getPointer());
+
+    return result;
+}
+
+/// <summary>
+/// Instantiates the generics used by a top level item.
+/// New instances are inserted in the script before the item, preceded by the instances
+/// which they use in turn.
+/// </summary>
+/// <param name="item">Top level item.</param>
+/// <param name="position">Item position in the script.</param>
+/// <param name="scoped">true if scopes have already been assigned to item nodes.</param>
+/// <param name="genState"></param>
+/// <returns>Number of nodes inserted into the script.</returns>
+size_t instantiateGenerics(Ref<AstNode> item, size_t position, bool scoped, GenericsPassState& genState)
+{
+    genState.newInstances.clear();
+    replaceGenericCalls(item, scoped, genState);
+
+    const AstNodeList	instances = genState.newInstances;
+    auto				scriptScope = genState.semState.getScope(genState.script);
+    size_t				inserted = 0;
+
+    for (auto instance : instances)
+    {
+        inserted += instantiateGenerics(instance, position + inserted, false, genState);
+
+        genState.script->insertChild(position + inserted, instance);
+        buildScope(instance, scriptScope, genState.semState);
+        ++inserted;
+    }
+
+    return inserted;
+}
+
+/// <summary>
+/// Replaces the compile time calls to generics ('Fifo[int, 8]') by references to
+/// their instances.
+/// </summary>
+/// <param name="node"></param>
+/// <param name="scoped">true if scopes have already been assigned to the nodes.</param>
+/// <param name="genState"></param>
+void replaceGenericCalls(Ref<AstNode> node, bool scoped, GenericsPassState& genState)
+{
+    for (size_t i = 0; i < node->childCount(); ++i)
+    {
+        auto child = node->child(i);
+
+        if (child.isNull() || child->getType() == AST_GENERIC)
+            continue;
+
+        //Children first, because parameters can be instances of other generics.
+        replaceGenericCalls(child, scoped, genState);
+
+        if (child->getType() != AST_CTCALL)
+            continue;
+
+        auto instance = getGenericInstance(child, genState);
+
+        if (instance.notNull())
+        {
+            const string	name = instance->getName();
+            auto			idNode = AstNode::create(AST_IDENTIFIER, child->position(), name, name);
+
+            if (scoped)
+                genState.semState.setScope(idNode, genState.semState.getScope(child));
+
+            genState.replacedNodes.push_back(child);
+            node->setChild((unsigned)i, idNode);
+        }
+    }
+}
+
+/// <summary>
+/// Gets the instance of a generic which corresponds to a compile time call.
+/// It creates the instance if it does not exist.
+/// </summary>
+/// <param name="call">'AST_CTCALL' node.</param>
+/// <param name="genState"></param>
+/// <returns>The instance, or a null reference if the call does not reference a
+/// generic, or if it has invalid parameters.</returns>
+Ref<AstNode> getGenericInstance(Ref<AstNode> call, GenericsPassState& genState)
+{
+    auto fnExpr = call->child(0);
+
+    if (fnExpr->getType() != AST_IDENTIFIER)
+        return Ref<AstNode>();
+
+    auto it = genState.generics.find(fnExpr->getName());
+
+    if (it == genState.generics.end())
+        return Ref<AstNode>();
+
+    auto	generic = it->second;
+    auto	params = generic->child(0);
+    auto	args = call->child(1);
+
+    if (args->childCount() != params->childCount())
+    {
+        genState.errors.push_back(semError(call,
+            ETYPE_WRONG_GENERIC_PARAMS_COUNT_3,
+            generic->getName().c_str(),
+            (int)params->childCount(),
+            (int)args->childCount()));
+        return Ref<AstNode>();
+    }
+
+    //Instance name, key, and parameters check.
+    string	name = generic->getName() + "[";
+    auto	key = AstNode::create(AST_LIST, call->position());
+
+    for (size_t i = 0; i < params->childCount(); ++i)
+    {
+        auto	param = params->child(i);
+        auto	arg = args->child(i);
+        string	typeName;
+
+        if (!param->childExists(0))
+        {
+            if (arg->getType() != AST_IDENTIFIER)
+            {
+                genState.errors.push_back(semError(arg, ETYPE_GENERIC_TYPE_PARAMETER_1, param->getName().c_str()));
+                return Ref<AstNode>();
+            }
+        }
+        else if (!isValidGenericConstant(param, arg, typeName))
+        {
+            genState.errors.push_back(semError(arg,
+                ETYPE_GENERIC_CONST_PARAMETER_2,
+                param->getName().c_str(),
+                typeName.c_str()));
+            return Ref<AstNode>();
+        }
+
+        auto keyItem = genericKeyItem(arg, genState);
+
+        if (i > 0)
+            name += ",";
+        name += (keyItem->getType() == AST_IDENTIFIER) ? keyItem->getName() : keyItem->getValue();
+        key->addChild(keyItem);
+    }
+    name += "]";
+
+    //Look for an existing instance.
+    auto	instances = generic->child(2);
+    auto	keys = generic->child(3);
+    int		sameName = 0;
+
+    for (size_t i = 0; i < instances->childCount(); ++i)
+    {
+        auto instance = instances->child(i);
+
+        if (!sameGenericKey(keys->child(i), key))
+        {
+            //Instances of different types with the same name, for example, of two 
+            //modules which define a 'Point' type.
+            if (instance->getName() == name || instance->getName().find(name + "#") == 0)
+                ++sameName;
+            continue;
+        }
+        name = instance->getName();
+
+        //Instances created in other scripts or modules are not in the script scope.
+        auto scope = genState.semState.getScope(genState.script);
+
+        if (genState.localInstances.count(instance.getPointer()) == 0 && !scope->contains(name, false))
+            scope->add(name, instance);
+
+        return instance;
+    }
+
+    if (sameName > 0)
+        name += "#" + to_string(sameName + 1);
+
+    auto instance = createGenericInstance(generic, name, args);
+
+    instances->addChild(instance);
+    keys->addChild(key);
+    genState.newInstances.push_back(instance);
+    genState.localInstances.insert(instance.getPointer());
+
+    return instance;
+}
+
+/// <summary>
+/// Gets the resolved value of a compile time parameter, which identifies the instance.
+/// </summary>
+/// <param name="arg">Parameter value, as written in the call.</param>
+/// <param name="genState"></param>
+/// <returns>For type names, an identifier which references its declaration (no 
+/// reference for the predefined types). For constants, a literal node with the value 
+/// in canonical form.</returns>
+Ref<AstNode> genericKeyItem(Ref<AstNode> arg, GenericsPassState& genState)
+{
+    if (arg->getType() == AST_IDENTIFIER)
+    {
+        auto item = AstNode::create(AST_IDENTIFIER, arg->position(), arg->getName());
+        auto decl = findTopLevelDeclaration(arg->getName(), genState.root, genState.script);
+
+        if (decl.notNull())
+            item->setReference(decl.getPointer());
+        return item;
+    }
+    else if (arg->getType() == AST_INTEGER)
+    {
+        long long value = 0;
+
+        //Out of range values have already been rejected by 'isValidGenericConstant'.
+        genericIntValue(arg, value);
+        return AstNode::create(AST_INTEGER, arg->position(), "", to_string(value));
+    }
+    else
+        return AstNode::create(arg->getType(), arg->position(), "", arg->getValue());
+}
+
+/// <summary>
+/// Looks for a top level declaration visible from a script. Symbols are not gathered 
+/// yet when generics are instantiated, so scopes cannot be used.
+/// </summary>
+/// <param name="name"></param>
+/// <param name="root">Root node of the semantic analysis.</param>
+/// <param name="script"></param>
+/// <returns>The declaration, or a null reference if not found (predefined types).</returns>
+Ref<AstNode> findTopLevelDeclaration(const string& name, Ref<AstNode> root, Ref<AstNode> script)
+{
+    auto find = [&name](AstNode* container) {
+        for (auto item : container->children())
+        {
+            if (item.notNull() && item->getName() == name && item->getType() != AST_GENERIC)
+                return item;
+        }
+        return Ref<AstNode>();
+    };
+
+    //Same order of precedence as symbol gathering: local, module, and imported items.
+    auto result = find(script.getPointer());
+
+    if (result.isNull() && root->getType() == AST_MODULE)
+        result = find(root.getPointer());
+
+    for (auto item : script->children())
+    {
+        if (result.notNull())
+            break;
+        if (item.notNull() && item->getType() == AST_IMPORT && item->getReference() != nullptr)
+            result = find(item->getReference());
+    }
+
+    return result;
+}
+
+/// <summary>
+/// Checks if two instance keys (see 'genericKeyItem') are the same.
+/// </summary>
+bool sameGenericKey(Ref<AstNode> keyA, Ref<AstNode> keyB)
+{
+    if (keyA->childCount() != keyB->childCount())
+        return false;
+
+    for (size_t i = 0; i < keyA->childCount(); ++i)
+    {
+        auto a = keyA->child(i);
+        auto b = keyB->child(i);
+
+        if (a->getType() != b->getType() || a->getName() != b->getName() || a->getValue() != b->getValue())
+            return false;
+        else if (a->getReference() != b->getReference())
+            return false;
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Creates a new instance of a generic definition.
+/// </summary>
+/// <param name="generic">'AST_GENERIC' node.</param>
+/// <param name="name">Instance name.</param>
+/// <param name="args">Compile time parameters values.</param>
+/// <returns></returns>
+Ref<AstNode> createGenericInstance(Ref<AstNode> generic, const std::string& name, Ref<AstNode> args)
+{
+    auto				params = generic->child(0);
+    auto				instance = astClone(generic->child(1));
+    AstStr2NodesMap		values;
+
+    for (size_t i = 0; i < params->childCount(); ++i)
+        values[params->child(i)->getName()] = args->child(i);
+
+    instance->setName(name);
+    substituteGenericParams(instance, values);
+
+    return instance;
+}
+
+/// <summary>
+/// Replaces the references to compile time parameters by their values.
+/// </summary>
+/// <param name="node"></param>
+/// <param name="values">Parameter values, by parameter name.</param>
+void substituteGenericParams(Ref<AstNode> node, const AstStr2NodesMap& values)
+{
+    for (size_t i = 0; i < node->childCount(); ++i)
+    {
+        auto child = node->child(i);
+
+        if (child.isNull())
+            continue;
+
+        const auto	type = child->getType();
+        auto		it = values.find(child->getName());
+
+        if ((type == AST_IDENTIFIER || type == AST_TYPE_NAME) && it != values.end())
+        {
+            auto value = it->second;
+
+            if (value->getType() == AST_IDENTIFIER)
+            {
+                const string valueName = value->getName();
+
+                node->setChild((unsigned)i, AstNode::create(type, child->position(), valueName, valueName));
+            }
+            else
+                node->setChild((unsigned)i, astClone(value));
+        }
+        else
+            substituteGenericParams(child, values);
+    }
+}
+
+/// <summary>
+/// Checks if a value is valid for a constant compile time parameter.
+/// Only literals of the parameter type are valid.
+/// </summary>
+/// <param name="param">Parameter declaration.</param>
+/// <param name="arg">Parameter value.</param>
+/// <param name="typeName">[out] Name of the parameter type.</param>
+/// <returns></returns>
+bool isValidGenericConstant(Ref<AstNode> param, Ref<AstNode> arg, std::string& typeName)
+{
+    typeName = param->child(0)->getName();
+
+    auto        type = astGetDefaultType(typeName);
+    long long   value;
+
+    if (arg->getType() == AST_INTEGER && !genericIntValue(arg, value))
+        return false;
+
+    if (type != nullptr && astIsBoolType(type))
+        return arg->getType() == AST_BOOL;
+    else if (type != nullptr && astIsIntType(type))
+        return arg->getType() == AST_INTEGER;
+    else
+    {
+        const auto argType = arg->getType();
+
+        return argType == AST_INTEGER || argType == AST_FLOAT || argType == AST_BOOL;
+    }
+}
+
+/// <summary>
+/// Gets the value of an integer literal compile time parameter.
+/// </summary>
+/// <param name="arg">Integer literal node.</param>
+/// <param name="value">[out] Literal value.</param>
+/// <returns>'false' if the value does not fit in 64 bits.</returns>
+bool genericIntValue(Ref<AstNode> arg, long long& value)
+{
+    errno = 0;
+    value = strtoll(arg->getValue().c_str(), nullptr, 0);
+
+    return errno != ERANGE;
+}
@@ -0,0 +1,49 @@
+/// <summary>
+/// Semantic analysis pass which instantiates generic functions and actors.
+/// </summary>
+
+#pragma once
+
+#include "semanticAnalysis.h"
+#include <set>
+
+class SemAnalysisState;
+
+/// <summary>
+/// State of the generics instantiation in a script.
+/// </summary>
+struct GenericsPassState
+{
+    SemAnalysisState&			semState;
+    Ref<AstNode>				root;
+    Ref<AstNode>				script;
+    AstStr2NodesMap				generics;
+    AstNodeList					newInstances;
+    std::set<AstNode*>			localInstances;
+    std::vector<CompileError>	errors;
+
+    //Replaced nodes are kept alive until the end of the pass. Scopes are assigned by
+    //node address, and a new node could take the address of a deleted one.
+    AstNodeList					replacedNodes;
+
+    GenericsPassState(SemAnalysisState& state) :semState(state)
+    {
+    }
+};
+
+SemanticResult genericsPass(Ref<AstNode> node, SemAnalysisState& state);
+
+AstNodeList getScripts(Ref<AstNode> node);
+CompileError analyzeImportedModules(Ref<AstNode> script);
+AstStr2NodesMap gatherGenerics(Ref<AstNode> root, Ref<AstNode> script);
+
+size_t instantiateGenerics(Ref<AstNode> item, size_t position, bool scoped, GenericsPassState& genState);
+void replaceGenericCalls(Ref<AstNode> node, bool scoped, GenericsPassState& genState);
+Ref<AstNode> getGenericInstance(Ref<AstNode> call, GenericsPassState& genState);
+Ref<AstNode> genericKeyItem(Ref<AstNode> arg, GenericsPassState& genState);
+Ref<AstNode> findTopLevelDeclaration(const std::string& name, Ref<AstNode> root, Ref<AstNode> script);
+bool sameGenericKey(Ref<AstNode> keyA, Ref<AstNode> keyB);
+Ref<AstNode> createGenericInstance(Ref<AstNode> generic, const std::string& name, Ref<AstNode> args);
+void substituteGenericParams(Ref<AstNode> node, const AstStr2NodesMap& values);
+bool isValidGenericConstant(Ref<AstNode> param, Ref<AstNode> arg, std::string& typeName);
+bool genericIntValue(Ref<AstNode> arg, long long& value);
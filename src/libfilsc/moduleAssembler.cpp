@@ -91,6 +91,7 @@ bool isExportable(Ref<AstNode> node)
     case AST_FUNCTION_TYPE:
     case AST_ACTOR:
     case AST_MESSAGE_TYPE:
+    case AST_GENERIC:
         return true;
 
     default:
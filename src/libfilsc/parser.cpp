@@ -557,15 +557,144 @@ ExprResult parseIf(LexToken token)
 /// <returns></returns>
 ExprResult parseSelect(LexToken token)
 {
-    auto r = ExprResult::requireReserved("select", token);
+    auto r = ExprResult::requireReserved("select", token).requireOp("(").then(parseExpression);
+
+    if (!r.ok())
+        return r.final();
+
+    auto	selectNode = astCreateSelect(token.getPosition(), r.result);
+    bool	hasDefault = false;
+
+    r = r.requireOp(")").requireOp("{");
+
+    while (r.ok() && r.nextText() != "}")
+    {
+        if (hasDefault && r.nextText() == "else")
+            return r.getError(ETYPE_UNEXPECTED_TOKEN_2, "else", "case value").final();
+
+        r = r.then(parseSelectCase);
+
+        if (r.ok())
+        {
+            hasDefault = hasDefault || !r.result->childExists(0);
+            selectNode->addChild(r.result);
+
+            if (r.nextText() != "}")
+                r = parseStatementSeparator(r);
+        }
+    }
+
+    r = r.requireOp("}");
 
     if (r.ok())
-        r = r.getError(ETYPE_NOT_IMPLEMENTED_1, "'select' parsing");
+        r.result = selectNode;
+
+    return r.final();
+}
+
+/// <summary>
+/// Parses a case of a 'select' expression: '<value>, <value>...: <expression>', or
+/// 'else: <expression>' for the default case.
+/// </summary>
+/// <param name="token"></param>
+/// <returns></returns>
+ExprResult parseSelectCase(LexToken token)
+{
+    Ref<AstNode>	values;
+    auto			r = ExprResult::requireReserved("else", token);
+
+    if (r.ok())
+        r = r.requireOp(":");
+    else
+    {
+        //'parseList' also consumes the ':' which ends the values list.
+        r = parseList(token, parseExpression, "", ":", ",");
+        values = r.result;
+    }
+
+    r = r.then(parseReturn);
+
+    if (r.ok())
+        r.result = astCreateCase(token.getPosition(), values, r.result);
 
     return r.final();
 }
 
 
+/// <summary>
+/// Parses a 'for' loop. Counted loops have the form:
+/// 'for (<init>; <condition>; <increment>) <body>', where the three components are
+/// optional. It also parses 'for each' loops.
+/// </summary>
+/// <param name="token"></param>
+/// <returns></returns>
+ExprResult parseFor(LexToken token)
+{
+    auto r = ExprResult::requireReserved("for", token).requireOp("(");
+
+    if (r.ok() && r.nextType() == LEX_ID && r.nextToken().next().text() == "in")
+        return parseForEach(token);
+
+    Ref<AstNode>	initExpr;
+    Ref<AstNode>	conditionExpr;
+    Ref<AstNode>	incrementExpr;
+
+    if (r.ok() && r.nextText() != ";")
+    {
+        r = r.then(parseVar).orElse(parseExpression);
+        initExpr = r.result;
+    }
+
+    r = r.requireOp(";");
+    if (r.ok() && r.nextText() != ";")
+    {
+        r = r.then(parseExpression);
+        conditionExpr = r.result;
+    }
+
+    r = r.requireOp(";");
+    if (r.ok() && r.nextText() != ")")
+    {
+        r = r.then(parseExpression);
+        incrementExpr = r.result;
+    }
+
+    r = r.requireOp(")").then(parseReturn);
+
+    if (r.ok())
+        r.result = astCreateFor(token.getPosition(), initExpr, conditionExpr, incrementExpr, r.result);
+
+    return r.final();
+}
+
+/// <summary>
+/// Parses a 'for each' loop: 'for (<item> in <array expression>) <body>'.
+/// The item is a constant, which takes the value of each array element.
+/// </summary>
+/// <param name="token"></param>
+/// <returns></returns>
+ExprResult parseForEach(LexToken token)
+{
+    auto r = ExprResult::requireReserved("for", token).requireOp("(");
+    auto itemToken = r.nextToken();
+
+    r = r.require(LEX_ID).requireId("in").then(parseExpression);
+
+    auto sequenceExpr = r.result;
+
+    r = r.requireOp(")").then(parseReturn);
+
+    if (r.ok())
+    {
+        auto item = astCreateDeclaration(itemToken, Ref<AstNode>(), Ref<AstNode>());
+
+        item->addFlag(ASTF_CONST);
+        r.result = astCreateForEach(token.getPosition(), item, sequenceExpr, r.result);
+    }
+
+    return r.final();
+}
+
 /// <summary>
 ///  Parses a return statement
 /// </summary>
@@ -618,6 +747,7 @@ ExprResult parseExpression(LexToken token)
 ExprResult parseTerm(LexToken token)
 {
     return parseConditional(token)
+        .orElse(parseFor)
         .orElse(parseLeftExpr);
 }
 
@@ -916,6 +1046,15 @@ ExprResult parseFunctionDef(LexToken token)
         r = r.skip();
     }
 
+    //Compile time parameters make it a generic function. Not available for 'C' functions.
+    Ref<AstNode>	genericParams;
+
+    if (r.ok() && !name.empty() && flags == 0 && r.nextText() == "[")
+    {
+        r = r.then(parseGenericParams);
+        genericParams = r.result;
+    }
+
     //Parameters tuple.
     r = r.then(parseTupleDef);
     auto params = r.result;
@@ -952,6 +1091,9 @@ ExprResult parseFunctionDef(LexToken token)
     {
         r.result = astCreateFunction(token.getPosition(), name, params, returnType, body);
         r.result->addFlags(flags);
+
+        if (genericParams.notNull())
+            r.result = astCreateGeneric(token.getPosition(), name, genericParams, r.result);
     }
 
     return r.final();
@@ -1072,6 +1214,13 @@ ExprResult parseActorDef(LexToken token)
 
     string			name = r.result->getName();
     Ref<AstNode>    actor = astCreateActor(token.getPosition(), name);
+    Ref<AstNode>	genericParams;
+
+    if (r.nextText() == "[")
+    {
+        r = r.then(parseGenericParams);
+        genericParams = r.result;
+    }
 
     if (r.nextText() == "(")
     {
@@ -1114,8 +1263,52 @@ ExprResult parseActorDef(LexToken token)
     r = r.requireOp("}");
 
     if (r.ok())
+    {
         r.result = actor;
 
+        if (genericParams.notNull())
+            r.result = astCreateGeneric(token.getPosition(), name, genericParams, actor);
+    }
+
+    return r.final();
+}
+
+/// <summary>
+/// Parses the compile time parameters list of a generic function or actor: '[T, N:int]'.
+/// </summary>
+/// <param name="token"></param>
+/// <returns></returns>
+ExprResult parseGenericParams(LexToken token)
+{
+    auto r = parseList(token, parseGenericParam, "[", "]", ",");
+
+    if (r.ok() && r.result->childCount() == 0)
+        return ExprResult::getError(token.next(), ETYPE_UNEXPECTED_TOKEN_2, "]", "compile time parameter");
+
+    return r.final();
+}
+
+/// <summary>
+/// Parses a compile time parameter. A parameter without type is a type parameter,
+/// and a parameter with type is a constant parameter.
+/// </summary>
+/// <param name="token"></param>
+/// <returns></returns>
+ExprResult parseGenericParam(LexToken token)
+{
+    Ref<AstNode>	typeDescriptor;
+
+    auto r = ExprResult::require(LEX_ID, token);
+
+    if (r.ok() && r.nextText() == ":")
+    {
+        r = r.then(parseTypeSpecifier);
+        typeDescriptor = r.result;
+    }
+
+    if (r.ok())
+        r.result = astCreateDeclaration(token, typeDescriptor, Ref<AstNode>());
+
     return r.final();
 }
 
@@ -1126,7 +1319,22 @@ ExprResult parseActorDef(LexToken token)
 /// <returns></returns>
 ExprResult parseInputMsg(LexToken token)
 {
-    auto	r = ExprResult::requireReserved("input", token).then(parseMsgHeader);
+    auto	r = ExprResult::requireReserved("input", token);
+    int     priority = 0;
+    int     flags = 0;
+
+    //Optional attributes list
+    if (r.ok() && r.nextText() == "[")
+    {
+        r = r.then(parseInputAttributes);
+        if (r.ok())
+        {
+            priority = astGetInputPriority(r.result.getPointer());
+            flags = r.result->getFlags();
+        }
+    }
+
+    r = r.then(parseMsgHeader);
 
     auto header = r.result;
     r = r.then(parseBlock);
@@ -1134,7 +1342,8 @@ ExprResult parseInputMsg(LexToken token)
     if (r.ok())
     {
         auto block = r.result;
-        r.result = astCreateInputMsg(token.getPosition(), header->getName());
+        r.result = astCreateInputMsg(token.getPosition(), header->getName(), priority);
+        r.result->addFlags(flags);
         r.result->addChild(header->child(0));
         r.result->addChild(block);
     }
@@ -1143,6 +1352,65 @@ ExprResult parseInputMsg(LexToken token)
 }
 
 
+/// <summary>
+/// Parses the attributes list of an input message. For example: '[priority = 2, conflate]'
+/// Supported attributes are:
+///     priority = n:   Dispatch priority, from 0 to 'AST_MAX_INPUT_PRIORITY'.
+///     conflate:       A new message overwrites the pending one, if there is any.
+/// </summary>
+/// <param name="token"></param>
+/// <returns>The result is an unnamed input node which contains the attributes.</returns>
+ExprResult parseInputAttributes(LexToken token)
+{
+    auto    r = ExprResult::require("[", token);
+    int     priority = 0;
+    int     flags = 0;
+
+    while (r.ok())
+    {
+        auto attrTok = r.nextToken();
+
+        if (attrTok.text() == "priority")
+        {
+            r = r.skip().requireOp("=");
+            if (!r.ok())
+                return r.final();
+
+            auto valueTok = r.nextToken();
+
+            if (valueTok.type() != LEX_INT)
+                return r.getError(ETYPE_UNEXPECTED_TOKEN_2, valueTok.text().c_str(), "integer");
+
+            //'strtoll' saturates on overflow, so out of range values are reported, too.
+            const long long value = strtoll(valueTok.text().c_str(), nullptr, 0);
+
+            if (value < 0 || value > AST_MAX_INPUT_PRIORITY)
+                return r.getError(ETYPE_INVALID_INPUT_PRIORITY_2, valueTok.text().c_str(), AST_MAX_INPUT_PRIORITY);
+            priority = (int)value;
+        }
+        else if (attrTok.text() == "conflate")
+            flags |= ASTF_CONFLATE;
+        else
+            return r.getError(ETYPE_UNEXPECTED_TOKEN_2, attrTok.text().c_str(), "input attribute");
+
+        r = r.skip();
+        if (r.nextText() == ",")
+            r = r.skip();
+        else
+            break;
+    }
+
+    r = r.requireOp("]");
+
+    if (r.ok())
+    {
+        r.result = astCreateInputMsg(token.getPosition(), "", priority);
+        r.result->addFlags(flags);
+    }
+
+    return r.final();
+}
+
 /// <summary>
 /// Parses an output message declaration.
 /// </summary>
@@ -29,6 +29,9 @@ ExprResult  parseTupleDefItem(LexToken token);
 
 ExprResult parseIf(LexToken token);
 ExprResult parseSelect(LexToken token);
+ExprResult parseSelectCase(LexToken token);
+ExprResult parseFor(LexToken token);
+ExprResult parseForEach(LexToken token);
 ExprResult parseReturn(LexToken token);
 
 ExprResult parseExpression(LexToken token);
@@ -57,7 +60,10 @@ ExprResult parseInputType(LexToken token);
 ExprResult parseMemberAccess(LexToken token, Ref<AstNode> objExpr);
 
 ExprResult parseActorDef(LexToken token);
+ExprResult parseGenericParams(LexToken token);
+ExprResult parseGenericParam(LexToken token);
 ExprResult parseInputMsg(LexToken token);
+ExprResult parseInputAttributes(LexToken token);
 ExprResult parseOutputMsg(LexToken token);
 ExprResult parseMsgHeader(LexToken token);
 ExprResult parseUnnamedInput(LexToken token);
@@ -0,0 +1,246 @@
+/// <summary>
+/// Range analysis of array indexes. Finds the array accesses which cannot be out of
+/// bounds, so the code generator can omit their runtime checks.
+/// </summary>
+/// <remarks>
+/// The analysis is conservative: an access is safe only if the range of its index
+/// expression is known, and inside the array bounds. Known ranges come from:
+/// - Integer literals.
+/// - Induction variables of 'for' loops with literal start and end values, which are not
+///   modified in the loop body.
+/// - The range of the index data type (an 'uint8' index can access a 256 items array).
+/// - Addition, subtraction, and masking ('&' with a non negative literal) of the above.
+/// </remarks>
+
+#include "pch.h"
+#include "rangeAnalysis.h"
+#include "typeCheckPass.h"
+
+using namespace std;
+
+/// <summary>
+/// Finds the array accesses whose index is always in bounds.
+/// </summary>
+/// <param name="root">Root of the AST to analyze. It must be type checked.</param>
+/// <returns>Set of 'AST_CTCALL' nodes which access array items.</returns>
+std::set<AstNode*> findSafeArrayAccesses(Ref<AstNode> root)
+{
+    set<AstNode*>	result;
+    IndexRanges		ranges;
+
+    safeAccessesSearch(root.getPointer(), ranges, result);
+    return result;
+}
+
+/// <summary>
+/// Recursive search of safe array accesses.
+/// </summary>
+/// <param name="ranges">Ranges of the induction variables of the enclosing loops.</param>
+void safeAccessesSearch(AstNode* node, IndexRanges& ranges, std::set<AstNode*>& result)
+{
+    if (node->getType() == AST_CTCALL && isSafeArrayAccess(node, ranges))
+        result.insert(node);
+
+    IntRange	inductionRange;
+    const bool	induction = node->getType() == AST_FOR && getInductionRange(node, inductionRange);
+
+    for (size_t i = 0; i < node->childCount(); ++i)
+    {
+        auto child = node->child(i);
+
+        if (child.isNull())
+            continue;
+
+        //The induction variable is only in range inside the loop body.
+        if (induction && i == 3)
+        {
+            auto decl = node->child(0).getPointer();
+
+            ranges[decl] = inductionRange;
+            safeAccessesSearch(child.getPointer(), ranges, result);
+            ranges.erase(decl);
+        }
+        else
+            safeAccessesSearch(child.getPointer(), ranges, result);
+    }
+}
+
+/// <summary>
+/// Checks if an array access is always in bounds.
+/// </summary>
+/// <param name="node">'AST_CTCALL' node. Other compile time calls are not array accesses.</param>
+bool isSafeArrayAccess(AstNode* node, const IndexRanges& ranges)
+{
+    auto arrayType = node->child(0)->getDataType();
+
+    if (arrayType == nullptr || !astIsArrayType(arrayType))
+        return false;
+
+    IntRange	range;
+
+    if (!getExpressionRange(node->child(1)->child(0).getPointer(), ranges, range))
+        return false;
+
+    return range.min >= 0 && range.max < astGetArraySize(arrayType);
+}
+
+/// <summary>
+/// Gets the range of values of an integer expression.
+/// </summary>
+/// <returns>false if the range is unknown.</returns>
+bool getExpressionRange(AstNode* expr, const IndexRanges& ranges, IntRange& range)
+{
+    auto		type = expr->getDataType();
+    long long	value;
+
+    if (type == nullptr || !astIsIntType(type))
+        return false;
+
+    const IntRange	typeRange = intTypeRange(type);
+
+    if (getIntLiteralValue(expr, value))
+    {
+        range = { value, value };
+        return true;
+    }
+    else if (expr->getType() == AST_IDENTIFIER)
+    {
+        auto it = ranges.find(expr->getReference());
+
+        range = (it != ranges.end()) ? it->second : typeRange;
+        return true;
+    }
+    else if (expr->getType() == AST_BINARYOP)
+    {
+        const string	op = expr->getValue();
+        IntRange		left, right;
+
+        if (op == "&" && getIntLiteralValue(expr->child(1), value) && value >= 0)
+            range = { 0, value };
+        else if (op != "+" && op != "-")
+            range = typeRange;
+        else if (!getExpressionRange(expr->child(0).getPointer(), ranges, left)
+            || !getExpressionRange(expr->child(1).getPointer(), ranges, right))
+        {
+            range = typeRange;
+        }
+        else if (op == "+")
+            range = { left.min + right.min, left.max + right.max };
+        else
+            range = { left.min - right.max, left.max - right.min };
+
+        //The result may wrap around.
+        if (range.min < typeRange.min || range.max > typeRange.max)
+            range = typeRange;
+
+        return true;
+    }
+    else
+    {
+        range = typeRange;
+        return true;
+    }
+}
+
+/// <summary>
+/// Gets the range of the induction variable of a 'for' loop, inside the loop body.
+/// </summary>
+/// <remarks>
+/// Recognized loops have the form: 'for (var i = <start>; i <op> <end>; ++i)' (or '--i'),
+/// and do not modify 'i' in the body.
+/// </remarks>
+/// <returns>false if it is not a recognized counted loop.</returns>
+bool getInductionRange(AstNode* loop, IntRange& range)
+{
+    auto		init = loop->child(0);
+    auto		condition = loop->child(1);
+    auto		increment = loop->child(2);
+    long long	start, end;
+
+    if (init.isNull() || condition.isNull() || increment.isNull())
+        return false;
+
+    if (init->getType() != AST_DECLARATION || !astIsIntType(init->getDataType()))
+        return false;
+    else if (!init->childExists(1) || !getIntLiteralValue(init->child(1), start))
+        return false;
+
+    auto isVariable = [&init](Ref<AstNode> expr) {
+        return expr->getType() == AST_IDENTIFIER && expr->getReference() == init.getPointer();
+    };
+
+    if (condition->getType() != AST_BINARYOP || !isVariable(condition->child(0))
+        || !getIntLiteralValue(condition->child(1), end))
+    {
+        return false;
+    }
+
+    if ((increment->getType() != AST_PREFIXOP && increment->getType() != AST_POSTFIXOP)
+        || !isVariable(increment->child(0)))
+    {
+        return false;
+    }
+
+    if (isModifiedIn(init.getPointer(), condition.getPointer()) || isModifiedIn(init.getPointer(), loop->child(3).getPointer()))
+        return false;
+
+    //The end condition shall be reachable without wrapping around.
+    const IntRange	typeRange = intTypeRange(init->getDataType());
+    const string	op = condition->getValue();
+    const string	step = increment->getValue();
+
+    if (step == "++" && op == "<" && end <= typeRange.max)
+        range = { start, end - 1 };
+    else if (step == "++" && op == "<=" && end < typeRange.max)
+        range = { start, end };
+    else if (step == "--" && op == ">" && end >= typeRange.min)
+        range = { end + 1, start };
+    else if (step == "--" && op == ">=" && end > typeRange.min)
+        range = { end, start };
+    else
+        return false;
+
+    return true;
+}
+
+/// <summary>
+/// Checks if a variable is written inside an AST subtree.
+/// </summary>
+bool isModifiedIn(AstNode* decl, AstNode* node)
+{
+    if (node == nullptr)
+        return false;
+
+    const auto	type = node->getType();
+    const bool	writes = type == AST_ASSIGNMENT
+        || ((type == AST_PREFIXOP || type == AST_POSTFIXOP) && (node->getValue() == "++" || node->getValue() == "--"));
+
+    if (writes)
+    {
+        auto target = node->child(0);
+
+        if (target->getType() == AST_IDENTIFIER && target->getReference() == decl)
+            return true;
+    }
+
+    for (auto& child : node->children())
+    {
+        if (child.notNull() && isModifiedIn(decl, child.getPointer()))
+            return true;
+    }
+
+    return false;
+}
+
+/// <summary>
+/// Gets the range of values of an integer type.
+/// </summary>
+IntRange intTypeRange(AstNode* type)
+{
+    const int bits = astGetIntBits(type);
+
+    if (astIsUnsignedType(type))
+        return { 0, (1LL << bits) - 1 };
+    else
+        return { -(1LL << (bits - 1)), (1LL << (bits - 1)) - 1 };
+}
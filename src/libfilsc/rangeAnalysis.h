@@ -0,0 +1,28 @@
+/// <summary>
+/// Range analysis of array indexes. Finds the array accesses which cannot be out of
+/// bounds, so the code generator can omit their runtime checks.
+/// </summary>
+#pragma once
+
+#include "ast.h"
+#include <set>
+
+/// <summary>
+/// Range of values that an integer expression can take (both ends included).
+/// </summary>
+struct IntRange
+{
+    long long	min;
+    long long	max;
+};
+
+typedef std::map<AstNode*, IntRange>	IndexRanges;
+
+std::set<AstNode*> findSafeArrayAccesses(Ref<AstNode> root);
+
+void safeAccessesSearch(AstNode* node, IndexRanges& ranges, std::set<AstNode*>& result);
+bool isSafeArrayAccess(AstNode* node, const IndexRanges& ranges);
+bool getExpressionRange(AstNode* expr, const IndexRanges& ranges, IntRange& range);
+bool getInductionRange(AstNode* loop, IntRange& range);
+bool isModifiedIn(AstNode* decl, AstNode* node);
+IntRange intTypeRange(AstNode* type);
@@ -11,7 +11,6 @@
 
 
 bool needsOwnScope(Ref<AstNode> node);
-void buildScope(Ref<AstNode> node, Ref<SymbolScope> currentScope, SemAnalysisState& state);
 
 /// <summary>
 /// 'Pass' function which performs scope creation.
@@ -62,6 +61,7 @@ bool needsOwnScope(Ref<AstNode> node)
 
     return type == AST_BLOCK
         || type == AST_FOR
+        || type == AST_FOR_EACH
         || type == AST_TUPLE_DEF
         || type == AST_FUNCTION
         || type == AST_INPUT
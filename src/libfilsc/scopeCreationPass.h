@@ -8,5 +8,7 @@
 #include "semanticAnalysis.h"
 
 class SemAnalysisState;
+class SymbolScope;
 
 SemanticResult scopeCreationPass(Ref<AstNode> node, SemAnalysisState& state);
+void buildScope(Ref<AstNode> node, Ref<SymbolScope> currentScope, SemAnalysisState& state);
@@ -5,6 +5,7 @@
 #include "passOperations.h"
 
 #include "scopeCreationPass.h"
+#include "genericsPass.h"
 #include "gatherPass.h"
 #include "typeCheckPass.h"
 
@@ -54,6 +55,7 @@ const PassList& getSemAnalysisPasses()
     if (passes.empty())
     {
         passes.push_back(scopeCreationPass);
+        passes.push_back(genericsPass);
         passes.push_back(symbolGatherPass);
         passes.push_back(preTypeCheckPass);
         passes.push_back(typeCheckPass);
@@ -94,9 +96,10 @@ SemanticResult semInOrderWalk(PassFunction fn, SemAnalysisState& state, Ref<AstN
     {
         auto child = children[i];
 
-        if (child.notNull())
+        //Generic definitions are only analyzed through their instances.
+        if (child.notNull() && child->getType() != AST_GENERIC)
         {
-            auto result = semInOrderWalk(fn, state, child);
+            auto result = isModuleExport(node, child) ? fn(child, state) : semInOrderWalk(fn, state, child);
 
             if (!result.ok())
                 errors.insert(errors.end(), result.errors.begin(), result.errors.end());
@@ -156,9 +159,9 @@ SemanticResult semPreOrderWalk(PassFunction fn, SemAnalysisState& state, Ref<Ast
     {
         auto child = children[i];
 
-        if (child.notNull())
+        if (child.notNull() && child->getType() != AST_GENERIC)
         {
-            auto childResult = semPreOrderWalk(fn, state, child);
+            auto childResult = isModuleExport(node, child) ? fn(child, state) : semPreOrderWalk(fn, state, child);
 
             if (!childResult.ok())
                 errors.insert(errors.end(), childResult.errors.begin(), childResult.errors.end());
@@ -174,6 +177,16 @@ SemanticResult semPreOrderWalk(PassFunction fn, SemAnalysisState& state, Ref<Ast
         return result;
 }
 
+/// <summary>
+/// Checks if a node is an item exported by a module.
+/// Exported items are walked as part of their scripts, so walk functions only process
+/// the item node again (to register it at module level), and not its children.
+/// </summary>
+bool isModuleExport(Ref<AstNode> parent, Ref<AstNode> node)
+{
+    return parent->getType() == AST_MODULE && node->getType() != AST_SCRIPT;
+}
+
 /// <summary>
 /// Creates a semantic analysis error
 /// </summary>
@@ -26,6 +26,8 @@ SemanticResult semInOrderWalk(PassFunction fn, SemAnalysisState& state, Ref<AstN
 SemanticResult semPreOrderWalk(const PassOperations& fnSet, SemAnalysisState& state, Ref<AstNode> node);
 SemanticResult semPreOrderWalk(PassFunction fn, SemAnalysisState& state, Ref<AstNode> node);
 
+bool isModuleExport(Ref<AstNode> parent, Ref<AstNode> node);
+
 CompileError semError(Ref<AstNode> node, ErrorTypes type, ...);
 
 SemanticResult buildModuleNode(const AstStr2NodesMap& nodes, const std::string& name);
@@ -0,0 +1,254 @@
+/// <summary>
+/// Converts the binary runtime traces written by PCR ('PCR_TRACE' mode) to
+/// Chrome / Perfetto trace event format (JSON).
+/// </summary>
+/// <remarks>
+/// Trace file format is described in 'pcr_writeTrace' function ('pcr.c'). Traces
+/// are read in host byte order, so they must be converted on a machine with the
+/// same endianness than the target.
+/// Each actor instance is shown as a thread, whose name is taken from the inputs
+/// it has received. Timer events are shown in thread 0.
+/// </remarks>
+
+#include "pch.h"
+#include "traceConverter.h"
+#include "json11.hpp"
+
+using namespace std;
+using json11::Json;
+
+/// <summary>
+/// Trace event types. Must match 'TraceEventType' enum in 'pcr.c'.
+/// </summary>
+enum TraceEventType
+{
+    TRACE_POST = 1,
+    TRACE_DISPATCH_START,
+    TRACE_DISPATCH_END,
+    TRACE_TIMER,
+    TRACE_DROP
+};
+
+/// <summary>
+/// Reads binary values from a trace file contents.
+/// </summary>
+class TraceReader
+{
+public:
+    TraceReader(const string& data) : m_data(data)
+    {
+    }
+
+    const char* read(size_t size)
+    {
+        if (m_pos + size > m_data.size())
+            throw exception("Corrupted trace file: unexpected end of file");
+
+        const char* result = m_data.data() + m_pos;
+        m_pos += size;
+        return result;
+    }
+
+    template <class T>
+    T readValue()
+    {
+        T value;
+
+        memcpy(&value, read(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    unsigned long long readPointer(unsigned ptrSize)
+    {
+        if (ptrSize == 8)
+            return readValue<unsigned long long>();
+        else
+            return readValue<unsigned>();
+    }
+
+private:
+    const string&   m_data;
+    size_t          m_pos = 0;
+};
+
+/// <summary>
+/// Formats an address as an hexadecimal string.
+/// </summary>
+static string addressToString(unsigned long long address)
+{
+    char buffer[32];
+
+    sprintf_s(buffer, "0x%llX", address);
+    return buffer;
+}
+
+/// <summary>
+/// Converts the contents of a binary trace file to a JSON document in
+/// Chrome / Perfetto trace event format.
+/// </summary>
+/// <param name="traceData">Trace file contents.</param>
+/// <returns>JSON document</returns>
+string traceToJson(const string& traceData)
+{
+    TraceReader     reader(traceData);
+
+    if (string(reader.read(8), 8) != "PCRTRACE")
+        throw exception("Invalid trace file: bad signature");
+
+    const auto version = reader.readValue<unsigned>();
+    const auto ptrSize = reader.readValue<unsigned>();
+    const auto symbolCount = reader.readValue<unsigned>();
+    const auto eventCount = reader.readValue<unsigned>();
+
+    if (version != 2)
+        throw exception("Unsupported trace file version");
+    if (ptrSize != 4 && ptrSize != 8)
+        throw exception("Corrupted trace file: invalid pointer size");
+
+    //Clock calibration. If it is not valid, time stamps are taken as microseconds.
+    const auto clockTicks = reader.readValue<unsigned long long>();
+    const auto clockUs = reader.readValue<unsigned long long>();
+    const double usPerTick = (clockTicks > 0 && clockUs > 0) ? double(clockUs) / clockTicks : 1.0;
+
+    //Symbols
+    map<unsigned long long, string>   symbols;
+
+    for (unsigned i = 0; i < symbolCount; ++i)
+    {
+        const auto address = reader.readPointer(ptrSize);
+        const auto length = reader.readValue<unsigned short>();
+
+        symbols[address] = string(reader.read(length), length);
+    }
+
+    auto symbolName = [&symbols](unsigned long long address) -> string
+    {
+        auto it = symbols.find(address);
+
+        if (it != symbols.end())
+            return it->second;
+        else
+            return addressToString(address);
+    };
+
+    //Events
+    Json::array                         events;
+    map<unsigned long long, int>        actorThreads;
+    map<int, int>                       openDispatches;
+
+    for (unsigned i = 0; i < eventCount; ++i)
+    {
+        const auto time = reader.readValue<unsigned long long>();
+        const auto type = reader.readValue<unsigned char>();
+        const auto priority = reader.readValue<unsigned char>();
+        reader.readValue<short>();
+        reader.readValue<unsigned>();
+        const auto actor = reader.readPointer(ptrSize);
+        const auto input = reader.readPointer(ptrSize);
+        const string name = symbolName(input);
+
+        //Each actor is a thread.
+        int     tid = 0;
+        auto    itThread = actorThreads.find(actor);
+
+        if (itThread != actorThreads.end())
+            tid = itThread->second;
+        else
+        {
+            tid = (int)actorThreads.size() + 1;
+            actorThreads[actor] = tid;
+
+            const string actorName = name.substr(0, name.find('.')) + " @" + addressToString(actor);
+
+            events.push_back(Json::object{
+                { "name", "thread_name" },
+                { "ph", "M" },
+                { "pid", 1 },
+                { "tid", tid },
+                { "args", Json::object{ { "name", actorName } } }
+            });
+        }
+
+        Json::object    ev{
+            { "ts", time * usPerTick },
+            { "pid", 1 },
+            { "tid", tid },
+        };
+
+        switch (type)
+        {
+        case TRACE_POST:
+        case TRACE_DROP:
+            ev["name"] = (type == TRACE_POST ? "post " : "drop ") + name;
+            ev["ph"] = "i";
+            ev["s"] = "t";
+            ev["args"] = Json::object{ { "priority", priority } };
+            break;
+
+        case TRACE_DISPATCH_START:
+            ev["name"] = name;
+            ev["ph"] = "B";
+            ev["args"] = Json::object{ { "priority", priority } };
+            ++openDispatches[tid];
+            break;
+
+        case TRACE_DISPATCH_END:
+            //The ring may have overwritten the start event.
+            if (openDispatches[tid] == 0)
+                continue;
+            --openDispatches[tid];
+            ev["ph"] = "E";
+            break;
+
+        case TRACE_TIMER:
+            ev["name"] = "timer " + name;
+            ev["ph"] = "i";
+            ev["s"] = "g";
+            ev["tid"] = 0;
+            break;
+
+        default:
+            throw exception("Corrupted trace file: invalid event type");
+        }
+
+        events.push_back(ev);
+    }
+
+    Json result = Json::object{
+        { "traceEvents", events },
+        { "displayTimeUnit", "ms" }
+    };
+
+    return result.dump();
+}
+
+/// <summary>
+/// Converts a binary trace file to a JSON file in Chrome / Perfetto trace event format.
+/// Throws an exception if it fails.
+/// </summary>
+/// <param name="tracePath"></param>
+/// <param name="jsonPath"></param>
+void convertTraceFile(const string& tracePath, const string& jsonPath)
+{
+    ifstream    input(tracePath, ios::in | ios::binary);
+
+    if (!input)
+    {
+        string message = "Cannot open trace file: " + tracePath;
+        throw exception(message.c_str());
+    }
+
+    stringstream    buffer;
+
+    buffer << input.rdbuf();
+
+    ofstream    output(jsonPath);
+
+    if (!output)
+    {
+        string message = "Cannot write file: " + jsonPath;
+        throw exception(message.c_str());
+    }
+
+    output << traceToJson(buffer.str());
+}
@@ -0,0 +1,10 @@
+/// <summary>
+/// Converts the binary runtime traces written by PCR ('PCR_TRACE' mode) to
+/// Chrome / Perfetto trace event format (JSON).
+/// </summary>
+#pragma once
+
+#include <string>
+
+std::string traceToJson(const std::string& traceData);
+void convertTraceFile(const std::string& tracePath, const std::string& jsonPath);
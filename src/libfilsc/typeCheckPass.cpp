@@ -27,6 +27,9 @@ SemanticResult typeCheckPass(Ref<AstNode> node, SemAnalysisState& state)
         functions.add(AST_TUPLE, tupleTypeCheck);
         functions.add(AST_DECLARATION, declarationTypeCheck);
         functions.add(AST_IF, ifTypeCheck);
+        functions.add(AST_SELECT, selectTypeCheck);
+        functions.add(AST_FOR, forTypeCheck);
+        functions.add(AST_FOR_EACH, setVoidType);
         functions.add(AST_RETURN, returnTypeAssign);
         functions.add(AST_FUNCTION, functionDefTypeCheck);
         functions.add(AST_FUNCTION_TYPE, assignItselftAsType);
@@ -51,6 +54,7 @@ SemanticResult typeCheckPass(Ref<AstNode> node, SemAnalysisState& state)
         functions.add(AST_MODULE, moduleTypeCheck);
 
         functions.add(AST_ASSIGNMENT, addTupleAdapter);
+        functions.add(AST_DECLARATION, addDeclarationTupleAdapter);
     }
 
     return semInOrderWalk(functions, state, node);
@@ -200,6 +204,9 @@ CompileError tupleTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
 /// </summary>
 CompileError declarationTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
 {
+    if (state.parent()->getType() == AST_FOR_EACH)
+        return forEachItemTypeCheck(node, state);
+
     //Type declared explicitly?
     if (node->childExists(0))
     {
@@ -228,6 +235,38 @@ CompileError declarationTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
     }
 }
 
+/// <summary>Type checking for 'for' loops</summary>
+CompileError forTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
+{
+    auto condition = node->child(1);
+
+    if (condition.notNull() && !astIsBoolType(condition->getDataType()))
+    {
+        return semError(condition,
+            ETYPE_WRONG_TYPE_2,
+            astTypeToString(condition->getDataType()).c_str(),
+            "bool");
+    }
+
+    return setVoidType(node, state);
+}
+
+/// <summary>
+/// Type checking for the item declaration of a 'for each' loop. Its type is the
+/// type of the array items.
+/// </summary>
+CompileError forEachItemTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
+{
+    auto sequence = state.parent()->child(0);
+    auto sequenceType = sequence->getDataType();
+
+    if (sequenceType->getType() != AST_ARRAY_DECL)
+        return semError(sequence, ETYPE_WRONG_TYPE_2, astTypeToString(sequenceType).c_str(), "array");
+
+    node->setDataType(sequenceType->child(0)->getDataType());
+    return CompileError::ok();
+}
+
 /// <summary>Type checking for 'if' expressions</summary>
 CompileError ifTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
 {
@@ -262,6 +301,67 @@ CompileError ifTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
     return CompileError::ok();
 }
 
+/// <summary>Type checking for 'select' expressions</summary>
+/// <remarks>Case values shall be integer constants, or names of constants initialized
+/// with them, and they cannot be repeated.
+/// The expression has the common type of all cases only if it has a default ('else')
+/// case. Otherwise, there are values for which no case is evaluated.</remarks>
+CompileError selectTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
+{
+    auto selectorType = node->child(0)->getDataType();
+
+    if (!astIsIntType(selectorType))
+    {
+        return semError(node->child(0),
+            ETYPE_WRONG_SELECT_TYPE_1,
+            astTypeToString(selectorType).c_str());
+    }
+
+    set<long long>	usedValues;
+    AstNode*		common = nullptr;
+    bool			hasDefault = false;
+
+    for (size_t i = 1; i < node->childCount(); ++i)
+    {
+        auto caseNode = node->child(i);
+        auto body = caseNode->child(1);
+
+        caseNode->setDataType(body->getDataType());
+
+        if (!caseNode->childExists(0))
+            hasDefault = true;
+        else
+        {
+            for (auto valueNode : caseNode->child(0)->children())
+            {
+                long long value;
+
+                if (!getCaseValue(valueNode, value) || !intLiteralFits(value, selectorType))
+                {
+                    return semError(valueNode,
+                        ETYPE_INVALID_CASE_VALUE_1,
+                        astTypeToString(selectorType).c_str());
+                }
+
+                if (!usedValues.insert(value).second)
+                    return semError(valueNode, ETYPE_DUPLICATED_CASE_VALUE_1, to_string(value).c_str());
+            }
+        }
+
+        if (i == 1)
+            common = body->getDataType();
+        else if (common != nullptr)
+            common = getCommonType(common, body->getDataType(), state);
+    }
+
+    if (hasDefault && common != nullptr)
+        node->setDataType(common);
+    else
+        setVoidType(node, state);
+
+    return CompileError::ok();
+}
+
 /// <summary>'return' expressions type check</summary>
 /// <remarks>Just assign the type, as at the moment in which is called
 /// the function return type has not been assigned.
@@ -409,6 +509,13 @@ CompileError arrayAccessTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
     if (!astIsIntType (indexExpr->getDataType()))
         return semError(params, ETYPE_INVALID_ARRAY_INDEX);
 
+    //Constant indexes are range checked at compile time.
+    long long	indexVal;
+    const int	size = astGetArraySize(arrayExpr->getDataType());
+
+    if (getIntLiteralValue(indexExpr, indexVal) && (indexVal < 0 || indexVal >= size))
+        return semError(params, ETYPE_ARRAY_INDEX_OUT_OF_RANGE_2, (int)indexVal, size);
+
     //The type of the expression is the type of the array items
     auto dataType = arrayExpr->getDataType()->child(0)->getDataType();
     node->setDataType(dataType);
@@ -495,6 +602,9 @@ CompileError binaryOpTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
 {
     string op = node->getValue();
 
+    if (astIsArrayType(node->child(0)->getDataType()) || astIsArrayType(node->child(1)->getDataType()))
+        return elementWiseOpTypeCheck(node, state);
+
     if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%")
         return mathOperatorTypeCheck(node, state);
     else if (op == ">>" || op == "<<" || op == "&" || op == "|" || op == "^")
@@ -543,6 +653,11 @@ CompileError postfixOpTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
 }
 
 /// <summary>Type check for arithmetic operators</summary>
+/// <remarks>
+/// Operands of different integer types are promoted to the type which can represent
+/// all the values of both. Integer literals take the type of the other operand, if
+/// their value fits in it.
+/// </remarks>
 CompileError mathOperatorTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
 {
     //TODO: Support other types different from integers.
@@ -555,15 +670,87 @@ CompileError mathOperatorTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
         return semError(node->child(0), ETYPE_WRONG_TYPE_2, astTypeToString(lexpr->getDataType()).c_str(), "int");
     else if (!astIsIntType(rexpr->getDataType()))
         return semError(node->child(0), ETYPE_WRONG_TYPE_2, astTypeToString(rexpr->getDataType()).c_str(), "int");
-    else
-        return CompileError::ok();
+
+    auto resultType = getIntPromotion(lexpr, rexpr);
+
+    if (resultType == nullptr)
+        return incompatibleTypesError(lexpr->getDataType(), rexpr).errors[0];
+
+    node->setDataType(resultType);
+    return CompileError::ok();
+}
+
+/// <summary>Type check for element-wise operations on arrays.</summary>
+/// <remarks>
+/// Operands are two arrays of the same size and element type, or an array and a scalar
+/// which can be assigned to the array elements. The shift count of '<<' and '>>' can 
+/// be of any integer type. The result has the type of the array operand.
+/// </remarks>
+CompileError elementWiseOpTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
+{
+    string      op = node->getValue();
+    auto        lexpr = node->child(0);
+    auto        rexpr = node->child(1);
+    auto        arrayType = astIsArrayType(lexpr->getDataType()) ? lexpr->getDataType() : rexpr->getDataType();
+    auto        itemType = astGetArrayItemType(arrayType);
+    const bool  shift = (op == "<<" || op == ">>");
+
+    node->setDataType(arrayType);
+
+    if (op != "+" && op != "-" && op != "*" && op != "/" && op != "%"
+        && op != "&" && op != "|" && op != "^" && !shift)
+    {
+        return semError(node, ETYPE_WRONG_TYPE_2, astTypeToString(arrayType).c_str(), "int");
+    }
+
+    if (!astIsIntType(itemType))
+        return semError(node, ETYPE_WRONG_TYPE_2, astTypeToString(itemType).c_str(), "int");
+
+    for (auto expr : { lexpr, rexpr })
+    {
+        auto        type = expr->getDataType();
+        const bool  shiftCount = shift && expr.getPointer() == rexpr.getPointer();
+        long long   value;
+
+        if (astIsArrayType(type))
+        {
+            if (astGetArraySize(type) != astGetArraySize(arrayType))
+                return incompatibleTypesError(arrayType, expr).errors[0];
+            else if (shiftCount ? !astIsIntType(astGetArrayItemType(type)) : astGetArrayItemType(type) != itemType)
+                return incompatibleTypesError(arrayType, expr).errors[0];
+        }
+        else if (!astIsIntType(type))
+            return semError(expr, ETYPE_WRONG_TYPE_2, astTypeToString(type).c_str(), "int");
+        else if (!shiftCount && !isIntWidening(itemType, type)
+            && !(getIntLiteralValue(expr, value) && intLiteralFits(value, itemType)))
+        {
+            return incompatibleTypesError(itemType, expr).errors[0];
+        }
+    }
+
+    return CompileError::ok();
 }
 
 /// <summary>Type check for bitwise operators</summary>
 CompileError bitwiseOperatorTypeCheck(Ref<AstNode> node, SemAnalysisState& state)
 {
-    //It is the same, by the moment.
-    return mathOperatorTypeCheck(node, state);
+    string op = node->getValue();
+
+    if (op != "<<" && op != ">>")
+        return mathOperatorTypeCheck(node, state);
+
+    //Shifts have the type of the left operand.
+    auto lexpr = node->child(0);
+    auto rexpr = node->child(1);
+
+    node->setDataType(lexpr->getDataType());
+
+    if (!astIsIntType(lexpr->getDataType()))
+        return semError(node->child(0), ETYPE_WRONG_TYPE_2, astTypeToString(lexpr->getDataType()).c_str(), "int");
+    else if (!astIsIntType(rexpr->getDataType()))
+        return semError(node->child(0), ETYPE_WRONG_TYPE_2, astTypeToString(rexpr->getDataType()).c_str(), "int");
+    else
+        return CompileError::ok();
 }
 
 /// <summary>Type check for comparision operators</summary>
@@ -589,6 +776,8 @@ CompileError equalityOperatorTypeCheck(Ref<AstNode> node, SemAnalysisState& stat
     {
         if (!astIsIntType(rexpr->getDataType()))
             return semError(rexpr, ETYPE_WRONG_TYPE_2, astTypeToString(rexpr->getDataType()).c_str(), "int");
+        else if (getIntPromotion(lexpr, rexpr) == nullptr)
+            return incompatibleTypesError(lexpr->getDataType(), rexpr).errors[0];
     }
     else if (astIsBoolType(lexpr->getDataType()))
     {
@@ -822,6 +1011,21 @@ Ref<AstNode> addTupleAdapter(Ref<AstNode> node, SemAnalysisState& state)
     return node;
 }
 
+/// <summary>
+/// Adds a 'tuple adapter node' for variables initialized with a compatible,
+/// but not the same type tuple. Tuple literals are written field by field, so
+/// they do not need it.
+/// </summary>
+Ref<AstNode> addDeclarationTupleAdapter(Ref<AstNode> node, SemAnalysisState& state)
+{
+    auto type = node->getDataType();
+
+    if (node->childExists(1) && astIsTupleType(type) && node->child(1)->getType() != AST_TUPLE)
+        node->setChild(1, makeTupleAdapter(node->child(1), type));
+
+    return node;
+}
+
 /// <summary>
 /// Creates a tuple adapter node if necessary.
 /// </summary>
@@ -838,6 +1042,14 @@ Ref<AstNode> makeTupleAdapter(Ref<AstNode> rNode, AstNode* lType)
     if (lType == rType)
         return rNode;
 
+    //Integer conversions are done by 'C' assignment.
+    if (astIsIntType(lType) && astIsIntType(rType))
+        return rNode;
+
+    //Arrays are copied element by element.
+    if (astIsArrayType(lType) && astIsArrayType(rType))
+        return rNode;
+
     auto adapterNode = astCreateTupleAdapter(rNode);
     adapterNode->setDataType(lType);
 
@@ -903,6 +1115,9 @@ SemanticResult assignCheck(AstNode* lType, Ref<AstNode> rExpr)
     //case AST_TUPLE:
         return assignTupleCheck(lType, rExpr);
 
+    case AST_ARRAY_DECL:
+        return assignArrayCheck(lType, rExpr);
+
     default:
         return assignScalarCheck(lType, rExpr);
     }
@@ -991,14 +1206,24 @@ SemanticResult assignMessageCheck(AstNode* lType, Ref<AstNode> rExpr)
 /// <summary>
 /// Checks an assignment to an scalar value.
 /// </summary>
+/// <remarks>
+/// Integers can be assigned to integer types which can represent all their values.
+/// Integer literals can be assigned to any integer type in which their value fits.
+/// </remarks>
 SemanticResult assignScalarCheck(AstNode* lType, Ref<AstNode> rExpr)
 {
-    //TODO: implement conversion between numeric types... Oh, wait... We have only a
-    //numeric type at this moment :-P
-    auto rType = rExpr->getDataType();
+    auto        rType = rExpr->getDataType();
+    long long   value;
 
     if (astIsCpointer(lType))
         return assignCpointerCheck(lType, rExpr);
+    else if (astIsIntType(lType) && astIsIntType(rType))
+    {
+        if (isIntWidening(lType, rType))
+            return SemanticResult(rExpr);
+        else if (getIntLiteralValue(rExpr, value) && intLiteralFits(value, lType))
+            return SemanticResult(rExpr);
+    }
     else if (lType->getType() == rType->getType())
     {
         if (lType->getName() == rType->getName())
@@ -1008,6 +1233,127 @@ SemanticResult assignScalarCheck(AstNode* lType, Ref<AstNode> rExpr)
     return incompatibleTypesError(lType, rExpr);
 }
 
+/// <summary>
+/// Checks an assignment to an array.
+/// </summary>
+/// <remarks>
+/// The source shall be an array of the same size, whose elements are assignable 
+/// to the destination elements.
+/// </remarks>
+SemanticResult assignArrayCheck(AstNode* lType, Ref<AstNode> rExpr)
+{
+    auto rType = rExpr->getDataType();
+
+    if (astIsArrayType(rType) && astGetArraySize(lType) == astGetArraySize(rType))
+    {
+        auto lItemType = astGetArrayItemType(lType);
+        auto rItemType = astGetArrayItemType(rType);
+
+        if (lItemType == rItemType)
+            return SemanticResult(rExpr);
+        else if (astIsIntType(lItemType) && astIsIntType(rItemType) && isIntWidening(lItemType, rItemType))
+            return SemanticResult(rExpr);
+    }
+
+    return incompatibleTypesError(lType, rExpr);
+}
+
+/// <summary>
+/// Gets the value of an integer literal expression. Negated literals are also
+/// literals.
+/// </summary>
+/// <returns>'false' if the expression is not an integer literal.</returns>
+bool getIntLiteralValue(Ref<AstNode> expr, long long& value)
+{
+    if (expr->getType() == AST_INTEGER)
+    {
+        value = stoll(expr->getValue(), nullptr, 0);
+        return true;
+    }
+    else if (expr->getType() == AST_PREFIXOP && expr->getValue() == "-"
+        && getIntLiteralValue(expr->child(0), value))
+    {
+        value = -value;
+        return true;
+    }
+    else
+        return false;
+}
+
+/// <summary>
+/// Gets the value of a 'select' case: an integer literal, or a reference to a constant
+/// whose initializer is an integer literal.
+/// </summary>
+bool getCaseValue(Ref<AstNode> expr, long long& value)
+{
+    if (getIntLiteralValue(expr, value))
+        return true;
+    else if (expr->getType() != AST_IDENTIFIER)
+        return false;
+
+    auto decl = expr->getReference();
+
+    if (decl == nullptr || decl->getType() != AST_DECLARATION || !decl->hasFlag(ASTF_CONST))
+        return false;
+    else
+        return decl->childExists(1) && getIntLiteralValue(decl->child(1), value);
+}
+
+/// <summary>
+/// Checks if an integer value is in the range of an integer type.
+/// </summary>
+bool intLiteralFits(long long value, AstNode* type)
+{
+    const int bits = astGetIntBits(type);
+
+    if (astIsUnsignedType(type))
+        return value >= 0 && value < (1LL << bits);
+    else
+        return value >= -(1LL << (bits - 1)) && value < (1LL << (bits - 1));
+}
+
+/// <summary>
+/// Checks if all values of an integer type can be represented by another one.
+/// </summary>
+/// <param name="lType">Destination type</param>
+/// <param name="rType">Source type</param>
+bool isIntWidening(AstNode* lType, AstNode* rType)
+{
+    const int lBits = astGetIntBits(lType);
+    const int rBits = astGetIntBits(rType);
+
+    if (astIsUnsignedType(lType))
+        return astIsUnsignedType(rType) && lBits >= rBits;
+    else if (astIsUnsignedType(rType))
+        return lBits > rBits;
+    else
+        return lBits >= rBits;
+}
+
+/// <summary>
+/// Gets the type of a binary operation between two integer expressions.
+/// </summary>
+/// <returns>The promoted type, or 'nullptr' if none can represent both operands.</returns>
+AstNode* getIntPromotion(Ref<AstNode> lexpr, Ref<AstNode> rexpr)
+{
+    auto        lType = lexpr->getDataType();
+    auto        rType = rexpr->getDataType();
+    long long   value;
+
+    if (lType == rType)
+        return lType;
+    else if (getIntLiteralValue(rexpr, value) && intLiteralFits(value, lType))
+        return lType;
+    else if (getIntLiteralValue(lexpr, value) && intLiteralFits(value, rType))
+        return rType;
+    else if (isIntWidening(lType, rType))
+        return lType;
+    else if (isIntWidening(rType, lType))
+        return rType;
+    else
+        return nullptr;
+}
+
 /// <summary>
 /// Checks the assignment of an scalar to an one element tuple.
 /// </summary>
@@ -1121,6 +1467,17 @@ AstNode* getCommonType(AstNode* typeA, AstNode* typeB, SemAnalysisState& state)
 /// <returns></returns>
 bool areTypesCompatible(AstNode* typeA, AstNode* typeB)
 {
+    //Different integer types have different sizes.
+    if (astIsIntType(typeA) && astIsIntType(typeB))
+        return typeA == typeB;
+
+    //Arrays are compatible if their elements are.
+    if (astIsArrayType(typeA) && astIsArrayType(typeB))
+    {
+        return astGetArraySize(typeA) == astGetArraySize(typeB)
+            && areTypesCompatible(astGetArrayItemType(typeA), astGetArrayItemType(typeB));
+    }
+
     auto r = assignCheck(typeA, typeB);
 
     if (!r.ok())
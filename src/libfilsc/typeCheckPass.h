@@ -22,8 +22,11 @@ CompileError typedefTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError tupleTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError declarationTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError ifTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
+CompileError selectTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError functionDefTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError assignmentTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
+CompileError forTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
+CompileError forEachItemTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError callTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError compileTimeCallTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError arrayAccessTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
@@ -36,6 +39,7 @@ CompileError prefixOpTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError postfixOpTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 
 CompileError mathOperatorTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
+CompileError elementWiseOpTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError bitwiseOperatorTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError comparisionOperatorTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
 CompileError equalityOperatorTypeCheck(Ref<AstNode> node, SemAnalysisState& state);
@@ -59,6 +63,7 @@ AstNode* getConnectOutputType(Ref<AstNode> pathNode, SemAnalysisState& state);
 
 Ref<AstNode> tupleRemoveTypedef(Ref<AstNode> node, SemAnalysisState& state);
 Ref<AstNode> addTupleAdapter(Ref<AstNode> node, SemAnalysisState& state);
+Ref<AstNode> addDeclarationTupleAdapter(Ref<AstNode> node, SemAnalysisState& state);
 Ref<AstNode> makeTupleAdapter(Ref<AstNode> rNode, AstNode* lType);
 Ref<AstNode> addReturnTupleAdapter(Ref<AstNode> node, SemAnalysisState& state);
 
@@ -67,12 +72,18 @@ CompileError setVoidType(Ref<AstNode> node, SemAnalysisState& state);
 SemanticResult  assignCheck(AstNode* lType, Ref<AstNode> rExpr);
 CompileError    assignCheck(AstNode* lType, Ref<AstNode> parent, int rightIndex);
 SemanticResult  assignCpointerCheck(AstNode* lType, Ref<AstNode> rExpr);
+SemanticResult  assignArrayCheck(AstNode* lType, Ref<AstNode> rExpr);
 SemanticResult  assignFunctionCheck(AstNode* lType, Ref<AstNode> rExpr);
 SemanticResult  assignMessageCheck(AstNode* lType, Ref<AstNode> rExpr);
 SemanticResult  assignScalarCheck(AstNode* lType, Ref<AstNode> rExpr);
 SemanticResult  assignScalarToTupleCheck(AstNode* lType, Ref<AstNode> rExpr);
 SemanticResult  assignTupleCheck(AstNode* lType, Ref<AstNode> rExpr);
 SemanticResult  incompatibleTypesError(AstNode* lType, Ref<AstNode> rExpr);
+bool            getIntLiteralValue(Ref<AstNode> expr, long long& value);
+bool            getCaseValue(Ref<AstNode> expr, long long& value);
+bool            intLiteralFits(long long value, AstNode* type);
+bool            isIntWidening(AstNode* lType, AstNode* rType);
+AstNode*        getIntPromotion(Ref<AstNode> lexpr, Ref<AstNode> rexpr);
 //CompileError	areTypesCompatible(AstNode* typeA, AstNode* typeB, Ref<AstNode> opNode);
 bool			areTypesCompatible(AstNode* typeA, AstNode* typeB);
 bool			areTuplesCompatible(AstNode* typeA, AstNode* typeB);
@@ -8,8 +8,10 @@
 /// </remarks>
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <memory.h>
+#include <string.h>
 #include <assert.h>
 
 #include "system_interface.h"
@@ -20,13 +22,21 @@ typedef unsigned char byte;
 /// Header of an actor message
 /// </summary>
 typedef struct {
-    EndPointAddress     address;
+    EndPointId          endPoint;
     unsigned short      msgLength;
     byte                flags;
     byte                reserved;
-    byte                params[0];
+#ifdef PCR_ACTOR_MAILBOXES
+    int                 nextMsg;        //Next message in the same mailbox. -1 if last.
+#endif
+    void*               params[0];      //Pointer type, to align the parameters.
 }MessageHeader;
 
+/// <summary>
+/// Rounds up a message length, to keep the headers in the queue aligned.
+/// </summary>
+#define MSG_ALIGN(size) (((size) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
 typedef void (*MessageHandlerFunction)(void *actor, void* params);
 
 
@@ -35,48 +45,446 @@ typedef void (*MessageHandlerFunction)(void *actor, void* params);
 /// </summary>
 enum SystemMsgFlags
 {
-    MSGF_DELETED = 1
+    MSGF_DELETED = 1,
+    MSGF_DISPATCHING = 2,       //The message handler is being executed.
+    MSGF_BLOCK = 4,             //Parameters are a pointer to a pool block, owned by the message.
+    MSGF_RESERVED = 8           //Parameters are being written ('pcr_reserveMessage').
+};
+
+/// <summary>
+/// What 'postMessage' does when the destination queue is full.
+/// </summary>
+enum OverflowPolicy
+{
+    PCR_OVERFLOW_STOP = 0,      //Stops the system (calls 'systemError').
+    PCR_OVERFLOW_DROP_NEWEST,   //Discards the message being posted.
+    PCR_OVERFLOW_DROP_OLDEST,   //Discards the oldest messages in the queue, until it fits.
+    PCR_OVERFLOW_BLOCK          //Waits for the scheduler to make room (see 'PCR_BLOCK_RETRIES').
 };
 
+#ifndef PCR_OVERFLOW_POLICY
+#define PCR_OVERFLOW_POLICY PCR_OVERFLOW_STOP
+#endif
+
+/// <summary>
+/// Number of times a blocked producer yields the CPU waiting for room in the queue,
+/// before giving up and dropping the message. Blocking is only useful for producers 
+/// which run concurrently with the scheduler (interrupt threads of a simulator, 
+/// for example). A message handler never gets room by waiting.
+/// </summary>
+#ifndef PCR_BLOCK_RETRIES
+#define PCR_BLOCK_RETRIES 1000
+#endif
+
+#ifndef SYSTEM_QUEUE_SIZE
 #define SYSTEM_QUEUE_SIZE 512
+#endif
+
+/// <summary>
+/// Size of the end point table. Each (actor instance, input) pair takes an entry.
+/// Programs with a static actor graph ('pcr_setEndPointTable') do not use it, and
+/// may define it as 1.
+/// </summary>
+#ifndef PCR_MAX_ENDPOINTS
+#define PCR_MAX_ENDPOINTS 256
+#endif
+
+/// <summary>
+/// Number of message priority levels. Each one has its own message queue.
+/// It must be greater than the highest input priority accepted by the compiler.
+/// </summary>
+#ifndef PCR_PRIORITY_LEVELS
+#define PCR_PRIORITY_LEVELS 4
+#endif
+
+/// <summary>
+/// Block pool: fixed size blocks for large message parameters. Messages whose parameters
+/// live in a block are posted by reference ('postBlockMessage'), instead of copying the
+/// parameters into the system queue. The block is released after the receiving input 
+/// returns (or when the message is dropped).
+/// 'PCR_BLOCK_COUNT' bounds the number of large messages in flight. Generated code 
+/// reserves them with 'pcr_reserveBlockMessage', which uses the system queue when
+/// the pool is exhausted, or the parameters are larger than 'PCR_BLOCK_SIZE'.
+/// </summary>
+#ifndef PCR_BLOCK_SIZE
+#define PCR_BLOCK_SIZE 256
+#endif
+
+#ifndef PCR_BLOCK_COUNT
+#define PCR_BLOCK_COUNT 8
+#endif
+
+/// <summary>
+/// Pool block. Free blocks are linked in a list.
+/// </summary>
+typedef union PoolBlock_ {
+    union PoolBlock_*   next;
+    double              align;
+    byte                data[PCR_BLOCK_SIZE];
+}PoolBlock;
+
+#ifdef PCR_ACTOR_MAILBOXES
+/// <summary>
+/// Mailboxes mode: Messages are kept in the system queues (which act as
+/// message allocators), but each actor has a mailbox per priority level, which
+/// links its pending messages in order. The scheduler dispatches up to 
+/// 'PCR_MAILBOX_BATCH' messages from a mailbox before moving to the next ready one.
+/// </summary>
+#ifndef PCR_MAX_MAILBOXES
+#define PCR_MAX_MAILBOXES 64
+#endif
+
+#ifndef PCR_MAILBOX_BATCH
+#define PCR_MAILBOX_BATCH 8
+#endif
+
+/// <summary>
+/// Actor mailbox structure.
+/// </summary>
+typedef struct {
+    void*   actorPtr;       //NULL if the mailbox is not in use.
+    int     priority;
+    int     firstMsg;       //Index of first message in the queue. -1 if empty.
+    int     lastMsg;
+    int     nextReady;      //Index of the next mailbox in ready list. -1 if last.
+}ActorMailbox;
+#endif
 
 /// <summary>
 /// System message queue structure.
 /// </summary>
 typedef struct {
-    //TODO: Make queue size configurable. At least, at compile time.
     //Move this to the generated code?
     //A possible solution is to add a 'queue' parameter in message queue functions, 
     //but it may add a little extra overhead.
     byte    data[SYSTEM_QUEUE_SIZE];
     int     readIdx;
     int     writeIdx;
+    int     highWater;      //Maximum number of bytes used.
+    unsigned posted;        //Number of messages posted.
+    unsigned dropped;       //Number of messages dropped on overflow.
+#ifdef PCR_ACTOR_MAILBOXES
+    int     readyHead;      //List of mailboxes with pending messages.
+    int     readyTail;
+#endif
 }SystemMsgQueue;
 
+#ifdef PCR_TRACE
+/// <summary>
+/// Trace mode: post, dispatch and timer events are recorded, with a time stamp from
+/// 'PCR_TRACE_CLOCK', in a ring of 'PCR_TRACE_EVENTS' entries (a power of 2). 
+/// The ring is written to 'PCR_TRACE_FILE' on 'quit' or when 'pcr_writeTrace'
+/// is called. 'filsc --trace2json' converts it to Chrome / Perfetto format.
+/// </summary>
+#ifndef PCR_TRACE_EVENTS
+#define PCR_TRACE_EVENTS 4096
+#endif
+
+#ifndef PCR_TRACE_FILE
+#define PCR_TRACE_FILE "pcr_trace.bin"
+#endif
+
+/// <summary>
+/// Trace time stamp source. Any free running counter is valid: its rate is calibrated
+/// against 'current_time_us' between 'initPcr' and 'pcr_writeTrace'.
+/// </summary>
+#ifndef PCR_TRACE_CLOCK
+#define PCR_TRACE_CLOCK() system_cycles()
+#endif
+
+/// <summary>
+/// Claims the next trace ring slot. Events are recorded without taking the system 
+/// lock, as they are also recorded with it held.
+/// </summary>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TRACE_NEXT_SLOT() ((unsigned)_InterlockedIncrement((volatile long*)&g_traceCount) - 1)
+#else
+#define TRACE_NEXT_SLOT() __atomic_fetch_add(&g_traceCount, 1, __ATOMIC_RELAXED)
+#endif
+
+/// <summary>
+/// Trace event types.
+/// </summary>
+enum TraceEventType
+{
+    TRACE_POST = 1,
+    TRACE_DISPATCH_START,
+    TRACE_DISPATCH_END,
+    TRACE_TIMER,
+    TRACE_DROP
+};
+
+/// <summary>
+/// Trace event record. Its layout has no padding on 32 and 64 bit systems, 
+/// and it is written to trace files as is.
+/// </summary>
+typedef struct {
+    unsigned long long  time;       //'PCR_TRACE_CLOCK' ticks.
+    byte        type;
+    byte        priority;
+    short       reserved;
+    unsigned    padding;
+    void*       actorPtr;
+    void*       inputPtr;
+}TraceEvent;
+
+#define TRACE_EVENT(type, address) traceEvent((type), (address))
+#else
+#define TRACE_EVENT(type, address)
+#endif
+
+#ifdef PCR_TELEMETRY
+/// <summary>
+/// Telemetry mode: besides queue counters, which are always kept, the runtime
+/// counts messages and dispatch time for each end point (actor input), in a hash 
+/// table of 'PCR_TELEMETRY_ENDPOINTS' entries. End points which do not fit in 
+/// the table are not counted.
+/// </summary>
+#ifndef PCR_TELEMETRY_ENDPOINTS
+#define PCR_TELEMETRY_ENDPOINTS 64
+#endif
+
+/// <summary>
+/// End point counters.
+/// </summary>
+typedef struct {
+    void*       actorPtr;       //NULL if the entry is not in use.
+    void*       inputPtr;
+    unsigned    posted;
+    unsigned    conflated;      //Messages which overwrote a pending one.
+    unsigned    dropped;
+    unsigned    dispatched;
+    unsigned    totalTimeUs;    //Time spent in the message handler.
+    unsigned    maxTimeUs;
+}EndPointStats;
+#endif
+
+#ifdef PCR_THREADS
+/// <summary>
+/// Threaded scheduler mode (POSIX threads): up to 'PCR_WORKERS' threads dispatch
+/// messages in parallel. Each actor has a FIFO mailbox, and it is either idle, in the
+/// run queue of one worker, or being run by one worker. So, the message handlers of 
+/// an actor never run concurrently, and its messages are dispatched in post order.
+/// A worker runs up to 'PCR_ACTOR_BATCH' messages of an actor before moving to the 
+/// next ready one. Idle workers steal ready actors from the other run queues.
+/// Messages are allocated from the heap. Input priorities, conflating inputs and
+/// queue overflow policies do not apply in this mode.
+/// </summary>
+#include <pthread.h>
+
+#if defined(PCR_ACTOR_MAILBOXES) || defined(PCR_TELEMETRY)
+#error "PCR_THREADS cannot be combined with PCR_ACTOR_MAILBOXES or PCR_TELEMETRY"
+#endif
+
+#ifndef PCR_WORKERS
+#define PCR_WORKERS 4
+#endif
+
+#ifndef PCR_MAX_ACTORS
+#define PCR_MAX_ACTORS 256
+#endif
+
+#ifndef PCR_ACTOR_BATCH
+#define PCR_ACTOR_BATCH 8
+#endif
+
+/// <summary>
+/// Message in an actor mailbox.
+/// </summary>
+typedef struct ThreadMessage_ {
+    struct ThreadMessage_*  next;
+    EndPointId              endPoint;
+    int                     flags;
+    byte                    params[0];
+}ThreadMessage;
+
+/// <summary>
+/// Actor scheduling states.
+/// </summary>
+enum ActorState
+{
+    ACTOR_IDLE = 0,     //No pending messages.
+    ACTOR_READY,        //In a worker run queue.
+    ACTOR_RUNNING       //A worker is running its messages.
+};
+
+/// <summary>
+/// Actor mailbox and scheduling state.
+/// </summary>
+typedef struct {
+    void*               actorPtr;   //NULL if not in use. Entries are never released.
+    pthread_mutex_t     lock;
+    ThreadMessage*      firstMsg;
+    ThreadMessage*      lastMsg;
+    int                 state;
+}ActorRecord;
+
+/// <summary>
+/// Worker run queue: ring of ready actor indexes. As an actor is in at most one
+/// run queue, it never overflows.
+/// </summary>
+typedef struct {
+    pthread_mutex_t     lock;
+    unsigned            head;
+    unsigned            tail;
+    int                 actors[PCR_MAX_ACTORS];
+}RunQueue;
+#endif
+
 /*******************************
  * GLOBALS
  *******************************/
 
-//System message queue.
-SystemMsgQueue  g_msgQueue;
+//System message queues. One for each priority level.
+SystemMsgQueue  g_msgQueues[PCR_PRIORITY_LEVELS];
+
+//End point table. Entry zero is not used.
+EndPointAddress         g_endPoints[PCR_MAX_ENDPOINTS];
+const EndPointAddress*  g_endPointTable = g_endPoints;
+int                     g_endPointCount = 1;
+
+#ifdef PCR_ACTOR_MAILBOXES
+//Actor mailboxes. Hash table indexed by actor pointer and priority.
+ActorMailbox    g_mailboxes[PCR_MAX_MAILBOXES];
+#endif
+
+//Profile table of instrumented code. Set on the first profiled call.
+PcrProfileEntry*    g_profileTable = NULL;
+
+//Current queue overflow policy.
+int             g_overflowPolicy = PCR_OVERFLOW_POLICY;
+
+//Destination of the parameters of dropped reserved messages.
+void*           g_discardBuffer[SYSTEM_QUEUE_SIZE / sizeof(void*)];
+
+//Block pool.
+PoolBlock       g_blocks[PCR_BLOCK_COUNT];
+PoolBlock*      g_freeBlocks = NULL;
+int             g_blocksUsed = 0;
+int             g_blocksHighWater = 0;
+
+#ifdef PCR_TELEMETRY
+//End point counters. Hash table indexed by actor and input pointers.
+EndPointStats   g_endPointStats[PCR_TELEMETRY_ENDPOINTS];
+#endif
+
+#ifdef PCR_TRACE
+//Trace events ring, and total number of recorded events.
+TraceEvent      g_traceRing[PCR_TRACE_EVENTS];
+unsigned        g_traceCount = 0;
+
+//Trace clock and 'current_time_us' when the runtime was initialized, to calibrate the clock.
+unsigned long long  g_traceClockBase = 0;
+unsigned            g_traceTimeBase = 0;
+#endif
+
+#ifdef PCR_THREADS
+//Actor mailboxes. Hash table indexed by actor pointer.
+ActorRecord     g_actorRecords[PCR_MAX_ACTORS];
+RunQueue        g_runQueues[PCR_WORKERS];
+
+//Number of workers started by 'runScheduler'. From 1 to 'PCR_WORKERS'.
+int             g_workerCount = PCR_WORKERS;
+
+pthread_mutex_t g_systemLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t g_timerLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t g_actorTableLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t g_idleLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  g_idleCond = PTHREAD_COND_INITIALIZER;
+
+int             g_readyActors = 0;      //Actors in run queues.
+int             g_idleWorkers = 0;      //Workers waiting for work.
+int             g_stopWorkers = 0;
+int             g_exitCode = 0;         //Set by 'quit', once the workers are stopped.
+unsigned        g_nextWorker = 0;       //Round robin for posts from non worker threads.
+
+//Index of the worker which runs in the current thread. -1 if not a worker.
+static __thread int t_workerIdx = -1;
+#endif
 
 /**********************************
 * Internal functions declarations.
 ***********************************/
 
-void postMessage(const EndPointAddress* address, const void* params, size_t paramsSize);
-
+void postMessage(EndPointId endPoint, const void* params, size_t paramsSize);
+void postBlockMessage(EndPointId endPoint, void* block);
+void* pcr_reserveMessage(EndPointId endPoint, size_t paramsSize);
+EndPointId pcr_registerActor(void* actorPtr, const PcrInputInfo* inputs, int count);
+EndPointId pcr_registerEndPoint(const EndPointAddress* address);
+void pcr_setEndPointTable(const EndPointAddress* table, int count);
+void pcr_commitMessage(void* params);
+void* pcr_allocBlock(size_t size);
+void* pcr_reserveBlockMessage(EndPointId endPoint, size_t paramsSize);
+void pcr_commitBlockMessage(EndPointId endPoint, void* params);
+void pcr_freeBlock(void* block);
+void pcr_dumpTelemetry();
+void pcr_writeTrace();
+void pcr_indexOutOfRange(int index, int size);
+void pcr_profileExit(PcrProfileEntry* table, int index, unsigned long long start);
+void pcr_dumpProfile();
+
+static const EndPointAddress* getEndPoint(EndPointId endPoint);
+static int queueMessage(EndPointId endPoint, const void* params, size_t paramsSize, int flags);
+static void* reserveMessage(EndPointId endPoint, size_t paramsSize, int flags);
+static void discardPendingMessage(SystemMsgQueue* q, const EndPointAddress* address);
+static void commitMessage(void* params);
+static void initBlockPool();
+static PoolBlock* takeFreeBlock();
+static void releaseBlock(void* block);
+static void* messageParams(MessageHeader* msg);
 static int queueAlloc(SystemMsgQueue* queue, size_t size);
+static int queueUsedBytes(const SystemMsgQueue* q);
+static int handleOverflow(SystemMsgQueue* q, size_t size);
+static int dropOldestMessage(SystemMsgQueue* q);
 static void lockSystemQueue();
 static void unlockSystemQueue();
 
 static void systemError(const char* message);
 
 static int checkTimers();
-static int dispatchActorMessages();
+static void stopSystem(int code);
 
-static MessageHeader* getHeadMessage();
-static void popHeadMessage();
+static MessageHeader* getHeadMessage(SystemMsgQueue* q);
+static void popHeadMessage(SystemMsgQueue* q);
+
+#ifndef PCR_THREADS
+//Single thread dispatcher. In threaded mode, messages are dispatched by the workers.
+static int dispatchActorMessages();
+static SystemMsgQueue* getHighestQueue();
+static void releasePendingMessage(MessageHeader* msg);
+static void callMessageHandler(MessageHeader* msg);
+#endif
+
+#ifdef PCR_ACTOR_MAILBOXES
+static int getMailbox(void* actorPtr, int priority);
+static void mailboxPush(SystemMsgQueue* q, int mailboxIdx, int msgIdx);
+static void mailboxRemove(SystemMsgQueue* q, int mailboxIdx, int msgIdx);
+static int dispatchMailbox(SystemMsgQueue* q);
+#endif
+
+#ifdef PCR_TELEMETRY
+static EndPointStats* getEndPointStats(const EndPointAddress* address);
+#endif
+
+#ifdef PCR_TRACE
+static void traceEvent(int type, const EndPointAddress* address);
+#endif
+
+#ifdef PCR_THREADS
+static void initThreads();
+static void runWorkers();
+static void stopWorkers();
+static void* workerThread(void* param);
+static void workerLoop(int worker);
+static void waitForWork();
+static void* threadedReserve(EndPointId endPoint, size_t paramsSize, int flags);
+static void threadedCommit(void* params);
+static int getActorRecord(void* actorPtr);
+static void runQueuePush(int worker, int actorIdx);
+static int runQueuePop(int worker);
+static int runActor(int worker, int actorIdx);
+#endif
 
 
 /**********************************
@@ -85,24 +493,61 @@ static void popHeadMessage();
 ***********************************/
 void initActors();
 
+#ifdef PCR_TRACE
+extern const PcrTraceSymbol pcr_traceSymbols[];
+#endif
+
 /// <summary>
 /// Initialices PCR globals.
 /// </summary>
 void initPcr()
 {
+    int i;
+
     system_init();
-    g_msgQueue.readIdx = -1;
-    g_msgQueue.writeIdx = -1;
+    for (i = 0; i < PCR_PRIORITY_LEVELS; ++i)
+    {
+        g_msgQueues[i].readIdx = -1;
+        g_msgQueues[i].writeIdx = -1;
+        g_msgQueues[i].highWater = 0;
+        g_msgQueues[i].posted = 0;
+        g_msgQueues[i].dropped = 0;
+#ifdef PCR_ACTOR_MAILBOXES
+        g_msgQueues[i].readyHead = -1;
+        g_msgQueues[i].readyTail = -1;
+#endif
+    }
+#ifdef PCR_ACTOR_MAILBOXES
+    memset(g_mailboxes, 0, sizeof(g_mailboxes));
+#endif
+#ifdef PCR_TELEMETRY
+    memset(g_endPointStats, 0, sizeof(g_endPointStats));
+#endif
+    initBlockPool();
+    g_endPointTable = g_endPoints;
+    g_endPointCount = 1;
+#ifdef PCR_THREADS
+    initThreads();
+#endif
+#ifdef PCR_TRACE
+    g_traceClockBase = PCR_TRACE_CLOCK();
+    g_traceTimeBase = current_time_us();
+#endif
 
     initActors();
 }
 
 /// <summary>
-/// Starts the scheduler. 
-/// This function never returns.
+/// Starts the scheduler. This function never returns.
+/// In threaded mode ('PCR_THREADS'), 'quit' stops the workers, and the system is 
+/// stopped from this thread once all of them have finished.
 /// </summary>
 void runScheduler()
 {
+#ifdef PCR_THREADS
+    runWorkers();
+    stopSystem(g_exitCode);
+#else
     while (1)
     {
         //const MessageHeader* msg = getHeadMessage();
@@ -114,36 +559,54 @@ void runScheduler()
         if (!active)
             system_yield_CPU();
     }
+#endif
 }
 
+#ifndef PCR_THREADS
 /// <summary>
-/// Checks system queue and sends messages to the actors if needed.
+/// Checks system queues and sends messages to the actors if needed.
 /// </summary>
+/// <remarks>
+/// The highest priority non-empty queue is looked up again after each message, 
+/// so a high priority message waits, at most, for the message being dispatched.
+/// </remarks>
 /// <returns></returns>
 static int dispatchActorMessages()
 {
-    MessageHeader*  msg = getHeadMessage();
+    SystemMsgQueue* q = getHighestQueue();
     int             count = 0;
 
-    while (msg)
+    while (q)
     {
-        assert(msg->address.inputPtr != NULL);
-        MessageHandlerFunction  input = (MessageHandlerFunction)msg->address.inputPtr;
-
-        //printf("Dispatching message. Actor: %p Input: %p Message length: %d\n",
-        //    msg->address.actorPtr, 
-        //    msg->address.inputPtr, 
-        //    (int)msg->msgLength);
-
-        input(msg->address.actorPtr, msg->params);
-        ++count;
+#ifdef PCR_ACTOR_MAILBOXES
+        const int       dispatched = dispatchMailbox(q);
+
+        //A message is being written, in an interrupt or other thread.
+        if (dispatched < 0)
+            break;
+        count += dispatched;
+#else
+        MessageHeader*  msg = getHeadMessage(q);
+
+        //A message is being written, in an interrupt or other thread.
+        if (msg->flags & MSGF_RESERVED)
+            break;
+
+        //Discarded pending messages of conflating inputs are not dispatched.
+        if (!(msg->flags & MSGF_DELETED))
+        {
+            callMessageHandler(msg);
+            ++count;
+        }
 
-        popHeadMessage();
-        msg = getHeadMessage();
+        popHeadMessage(q);
+#endif
+        q = getHighestQueue();
     }
 
     return count;
 }
+#endif
 
 /// <summary>
 /// Checks if some timers have reached its scheduled time.
@@ -153,14 +616,29 @@ static int checkTimers()
 {
     unsigned    now = current_time();
     int         count = 0;
-    TimerInfo*  timer = timer_getFirst();
 
-    while (timer != NULL && now - timer->base >= timer->periodMS)
+    while (1)
     {
-        //printf("Executing timer. ID: %d Period: %d\n", timer->id, timer->periodMS);
-        postMessage(&timer->destInput, NULL, 0);
-        timer_schedule(timer);
+        TimerInfo*  timer;
+        EndPointId  destInput = 0;
+
+        //The message is posted after releasing the timer list, as actors (in other 
+        //workers) may be calling 'timer_start' or 'timer_stop'.
+        pcr_lockTimers();
         timer = timer_getFirst();
+        if (timer != NULL && now - timer->base >= timer->periodMS)
+        {
+            //printf("Executing timer. ID: %d Period: %d\n", timer->id, timer->periodMS);
+            destInput = timer->destInput;
+            timer_schedule(timer);
+        }
+        pcr_unlockTimers();
+
+        if (destInput == 0)
+            break;
+
+        TRACE_EVENT(TRACE_TIMER, getEndPoint(destInput));
+        postMessage(destInput, NULL, 0);
         ++count;
     }
 
@@ -168,182 +646,1684 @@ static int checkTimers()
 }
 
 /// <summary>
-/// Posts a new message into the system queue.
+/// Locks the timer list of the system layer. The platform timer functions 
+/// ('timer_start', 'timer_stop'...) and the scheduler access it between 
+/// 'pcr_lockTimers' and 'pcr_unlockTimers'.
 /// </summary>
-/// <param name="address"></param>
-/// <param name="params"></param>
-/// <param name="paramsSize"></param>
-void postMessage(const EndPointAddress* address, const void* params, size_t paramsSize)
+/// <remarks>
+/// It only needs a lock in threaded mode ('PCR_THREADS'), in which timers are serviced 
+/// by worker 0, and actors running in any worker may start or stop timers. 
+/// Calls cannot be nested.
+/// </remarks>
+void pcr_lockTimers()
 {
-    lockSystemQueue();
-
-    assert(address != NULL);
-
-    //printf("Posting message. Actor: %p Input: %p Params size: %d\n",
-    //    address->actorPtr, address->inputPtr, (int)paramsSize);
-
-    MessageHeader   header;
-    const size_t    headerSize = sizeof(header);
-    const size_t    msgLength = paramsSize + headerSize;
-
-    header.address = *address;
-    header.msgLength = (unsigned short)msgLength;
-    header.flags = 0;
-    header.reserved = 0;
-
-    int     idx = queueAlloc(&g_msgQueue, msgLength);
-    byte*   writePtr = g_msgQueue.data + idx;
-    
-    //Copy header.
-    memcpy(writePtr, &header, headerSize);
-    writePtr += headerSize;
-
-    //Copy params
-    memcpy(writePtr, params, paramsSize);
-
-    unlockSystemQueue();
+#ifdef PCR_THREADS
+    pthread_mutex_lock(&g_timerLock);
+#endif
 }
 
 /// <summary>
-/// Gets a pointer to the first message in the queue.
-/// Returns NULL if empty.
+/// Unlocks the timer list. See 'pcr_lockTimers'.
 /// </summary>
-/// <returns></returns>
-static MessageHeader* getHeadMessage()
+void pcr_unlockTimers()
 {
-    //Check if empty
-    if (g_msgQueue.readIdx < 0)
-        return NULL;
-    else
-        return (MessageHeader*)(g_msgQueue.data + g_msgQueue.readIdx);
+#ifdef PCR_THREADS
+    pthread_mutex_unlock(&g_timerLock);
+#endif
 }
 
-
 /// <summary>
-/// Removes the head message, and any invalid messages up to the
-/// next valid message.
+/// Registers the inputs of an actor instance in the end point table. Generated actor
+/// constructors call it with the input table of the actor type.
 /// </summary>
-static void popHeadMessage()
+/// <param name="actorPtr"></param>
+/// <param name="inputs"></param>
+/// <param name="count">Number of inputs.</param>
+/// <returns>End point identifier of the first input. The others follow it.</returns>
+EndPointId pcr_registerActor(void* actorPtr, const PcrInputInfo* inputs, int count)
 {
-    const MessageHeader*  msg = getHeadMessage();
-
-    if (msg == NULL)
-        return;
+    EndPointId  first;
+    int         i;
 
     lockSystemQueue();
 
-    SystemMsgQueue*     q = &g_msgQueue;
+    assert(g_endPointTable == g_endPoints);
+    if (g_endPointCount + count > PCR_MAX_ENDPOINTS)
+    {
+        unlockSystemQueue();
+        systemError("Too many end points!");
+        return 0;
+    }
 
-    q->readIdx = (q->readIdx + msg->msgLength) % SYSTEM_QUEUE_SIZE;
-    if (q->readIdx == q->writeIdx)
-        q->readIdx = q->writeIdx = -1;
-    else
+    first = (EndPointId)g_endPointCount;
+    for (i = 0; i < count; ++i)
     {
-        if (SYSTEM_QUEUE_SIZE - q->readIdx < sizeof(MessageHeader))
-            q->readIdx = 0;
+        EndPointAddress*    address = &g_endPoints[g_endPointCount++];
 
-        //Check for deleted messages
-        //TODO: It would be better to avoid this recursive call.
-        msg = getHeadMessage();
-        if (msg != NULL && msg->flags & MSGF_DELETED)
-            popHeadMessage();
+        address->actorPtr = actorPtr;
+        address->inputPtr = inputs[i].inputPtr;
+        address->priority = inputs[i].priority;
+        if (inputs[i].pendingOffset >= 0)
+            address->pendingIdx = (int*)((byte*)actorPtr + inputs[i].pendingOffset);
+        else
+            address->pendingIdx = NULL;
     }
 
-    //printf("POP head message. ReadIdx: %d WriteIdx: %d\n", q->readIdx, q->writeIdx);
-
     unlockSystemQueue();
+    return first;
 }
 
 /// <summary>
-/// Allocates space in a message queue for a new message.
+/// Registers a single end point. For end points defined in 'C' code.
 /// </summary>
-/// <param name="q"></param>
-/// <param name="size"></param>
-/// <returns>The index in the queue of the new message.</returns>
-static int queueAlloc(SystemMsgQueue* q, size_t size)
+/// <returns>End point identifier.</returns>
+EndPointId pcr_registerEndPoint(const EndPointAddress* address)
 {
+    EndPointId  id;
 
-    if (q->writeIdx > q->readIdx)
-    {
-        const size_t available = SYSTEM_QUEUE_SIZE - q->writeIdx;
-        const int result = q->writeIdx;
-
-        if (size < available)
-            q->writeIdx += size;
-        else if (size == available)
-            q->writeIdx = 0;
-        else
-        {
-            if (available >= sizeof(MessageHeader))
-            {
-                MessageHeader*	header = (MessageHeader*)(q->data + q->writeIdx);
-
-                header->flags = MSGF_DELETED;
-                header->msgLength = (unsigned short)available;
-            }
-            q->writeIdx = 0;
-
-            //Recursive call, once the chunk at the end has been skipped.
-            return queueAlloc(q, size);
-        }
+    lockSystemQueue();
 
-        return result;
-    }
-    else
+    assert(g_endPointTable == g_endPoints);
+    if (g_endPointCount >= PCR_MAX_ENDPOINTS)
     {
-        size_t available = q->readIdx - q->writeIdx;
+        unlockSystemQueue();
+        systemError("Too many end points!");
+        return 0;
+    }
 
-        if (q->readIdx < 0)
-        {
-            available = SYSTEM_QUEUE_SIZE;
-            q->readIdx = q->writeIdx = 0;
-        }
-        const int result = q->writeIdx;
+    id = (EndPointId)g_endPointCount++;
+    g_endPoints[id] = *address;
 
-        if (size > available)
-            systemError("System queue overflow!");
-        else
-            q->writeIdx += size;
+    unlockSystemQueue();
+    return id;
+}
 
-        return result;
-    }
+/// <summary>
+/// Replaces the end point table by a table built at compile time, for programs 
+/// whose actor graph is statically initialized. 
+/// </summary>
+/// <param name="table">End point table. Entry zero is not used.</param>
+/// <param name="count">Number of entries, including entry zero.</param>
+void pcr_setEndPointTable(const EndPointAddress* table, int count)
+{
+    lockSystemQueue();
+    g_endPointTable = table;
+    g_endPointCount = count;
+    unlockSystemQueue();
 }
 
-static void lockSystemQueue()
+/// <summary>
+/// Gets the entry of the end point table of an end point identifier.
+/// </summary>
+static const EndPointAddress* getEndPoint(EndPointId endPoint)
 {
-    system_disableInterrupts();
+    assert(endPoint > 0 && endPoint < g_endPointCount);
+    return &g_endPointTable[endPoint];
 }
 
-static void unlockSystemQueue()
+/// <summary>
+/// Posts a new message into the system queue.
+/// </summary>
+/// <param name="endPoint"></param>
+/// <param name="params"></param>
+/// <param name="paramsSize"></param>
+void postMessage(EndPointId endPoint, const void* params, size_t paramsSize)
 {
-    system_enableInterrupts();
+    queueMessage(endPoint, params, paramsSize, 0);
 }
 
-static void systemError(const char* message)
+/// <summary>
+/// Posts a message whose parameters are in a pool block (see 'pcr_allocBlock').
+/// The parameters are not copied: the message takes the ownership of the block, which
+/// is released after the receiving input returns.
+/// </summary>
+/// <param name="endPoint"></param>
+/// <param name="block"></param>
+void postBlockMessage(EndPointId endPoint, void* block)
 {
-    //TODO: Better logging
-    fprintf(stderr, "System error: %s\n", message);
+    if (!queueMessage(endPoint, &block, sizeof(block), MSGF_BLOCK))
+        pcr_freeBlock(block);
+}
 
-    system_stop(-1);
+/// <summary>
+/// Reserves space for a message in the system queue. The caller writes the parameters 
+/// directly in the returned buffer, and then calls 'pcr_commitMessage'. It avoids 
+/// building the parameters in a temporary and copying them.
+/// </summary>
+/// <remarks>
+/// The scheduler does not dispatch a message (nor messages behind it in the same queue)
+/// until it is committed.
+/// If the message is dropped, a discard buffer is returned, so the caller does not need
+/// to check it.
+/// </remarks>
+/// <param name="endPoint"></param>
+/// <param name="paramsSize"></param>
+/// <returns>Buffer for the message parameters.</returns>
+void* pcr_reserveMessage(EndPointId endPoint, size_t paramsSize)
+{
+    void* params = reserveMessage(endPoint, paramsSize, 0);
+
+    if (params != NULL)
+        return params;
+
+    assert(paramsSize <= sizeof(g_discardBuffer));
+    return g_discardBuffer;
 }
 
-void quit(void* params)
+/// <summary>
+/// Commits a message reserved with 'pcr_reserveMessage'. It can be dispatched from now.
+/// </summary>
+/// <param name="params">Buffer returned by 'pcr_reserveMessage'.</param>
+void pcr_commitMessage(void* params)
 {
-    typedef struct {
-        int code;
-    }ParamsT;
+    if (params != (void*)g_discardBuffer)
+        commitMessage(params);
+}
 
-    ParamsT*    pParams = (ParamsT*)params;
-    system_stop(pParams->code);
+/// <summary>
+/// Posts a new message into the system queue.
+/// </summary>
+/// <param name="endPoint"></param>
+/// <param name="params"></param>
+/// <param name="paramsSize"></param>
+/// <param name="flags">Initial message flags.</param>
+/// <returns>Zero if the message has been dropped.</returns>
+static int queueMessage(EndPointId endPoint, const void* params, size_t paramsSize, int flags)
+{
+    void*   dest = reserveMessage(endPoint, paramsSize, flags);
+
+    if (dest == NULL)
+        return 0;
+
+    if (paramsSize > 0)
+        memcpy(dest, params, paramsSize);
+    commitMessage(dest);
+
+    return 1;
 }
 
-void digitalOut(void* params)
+/// <summary>
+/// Allocates a new message in the system queue, and marks it as reserved. If the 
+/// input is conflating, and has a pending message, it returns the pending message.
+/// </summary>
+/// <param name="endPoint"></param>
+/// <param name="paramsSize"></param>
+/// <param name="flags">Initial message flags.</param>
+/// <returns>Pointer to message parameters. NULL if the message has been dropped.</returns>
+static void* reserveMessage(EndPointId endPoint, size_t paramsSize, int flags)
 {
-    typedef struct {
-        int address;
-        unsigned char value;
-    }ParamsT;
+#ifdef PCR_THREADS
+    return threadedReserve(endPoint, paramsSize, flags);
+#endif
 
-    ParamsT*    pParams = (ParamsT*)params;
-    gpio_write(pParams->address, pParams->value);
-}
\ No newline at end of file
+    lockSystemQueue();
+
+    const EndPointAddress*  address = getEndPoint(endPoint);
+
+    assert(address->priority >= 0 && address->priority < PCR_PRIORITY_LEVELS);
+
+    //printf("Posting message. Actor: %p Input: %p Params size: %d\n",
+    //    address->actorPtr, address->inputPtr, (int)paramsSize);
+    TRACE_EVENT(TRACE_POST, address);
+
+    MessageHeader   header;
+    const size_t    headerSize = offsetof(MessageHeader, params);
+    const size_t    msgLength = MSG_ALIGN(paramsSize + headerSize);
+
+    header.endPoint = endPoint;
+    header.msgLength = (unsigned short)msgLength;
+    header.flags = (byte)(flags | MSGF_RESERVED);
+    header.reserved = 0;
+#ifdef PCR_ACTOR_MAILBOXES
+    header.nextMsg = -1;
+#endif
+
+    SystemMsgQueue* q = &g_msgQueues[address->priority];
+#ifdef PCR_TELEMETRY
+    EndPointStats*  stats = getEndPointStats(address);
+
+    if (stats != NULL)
+        ++stats->posted;
+#endif
+
+    ++q->posted;
+
+    //Conflating input with a pending message: just overwrite its parameters.
+    //Large messages can be posted in a pool block, or in the queue if the pool is 
+    //exhausted. If the pending message has been posted the other way, it is replaced.
+    if (address->pendingIdx != NULL && *address->pendingIdx >= 0)
+    {
+        MessageHeader*  pending = (MessageHeader*)(q->data + *address->pendingIdx);
+
+        if (pending->msgLength != msgLength || (pending->flags & MSGF_BLOCK) != (flags & MSGF_BLOCK))
+            discardPendingMessage(q, address);
+        else
+        {
+            if (pending->flags & MSGF_BLOCK)
+                releaseBlock(messageParams(pending));
+            pending->flags = (byte)((pending->flags & ~MSGF_BLOCK) | (flags & MSGF_BLOCK) | MSGF_RESERVED);
+#ifdef PCR_TELEMETRY
+            if (stats != NULL)
+                ++stats->conflated;
+#endif
+
+            unlockSystemQueue();
+            return pending->params;
+        }
+    }
+
+    int             idx = queueAlloc(q, msgLength);
+
+    if (idx < 0)
+        idx = handleOverflow(q, msgLength);
+
+    if (idx < 0)
+    {
+        TRACE_EVENT(TRACE_DROP, address);
+        ++q->dropped;
+#ifdef PCR_TELEMETRY
+        if (stats != NULL)
+            ++stats->dropped;
+#endif
+        unlockSystemQueue();
+        return NULL;
+    }
+
+    MessageHeader*  msg = (MessageHeader*)(q->data + idx);
+    const int       used = queueUsedBytes(q);
+
+    if (used > q->highWater)
+        q->highWater = used;
+
+    if (address->pendingIdx != NULL)
+        *address->pendingIdx = idx;
+    
+    memcpy(msg, &header, headerSize);
+
+#ifdef PCR_ACTOR_MAILBOXES
+    mailboxPush(q, getMailbox(address->actorPtr, address->priority), idx);
+#endif
+
+    unlockSystemQueue();
+    return msg->params;
+}
+
+/// <summary>
+/// Discards the pending message of a conflating input, which cannot be overwritten by
+/// the new message. Its space is reclaimed when it reaches the head of the queue.
+/// </summary>
+/// <remarks>Must be called with the system queue locked.</remarks>
+/// <param name="q"></param>
+/// <param name="address">End point of the conflating input.</param>
+static void discardPendingMessage(SystemMsgQueue* q, const EndPointAddress* address)
+{
+    MessageHeader*  pending = (MessageHeader*)(q->data + *address->pendingIdx);
+
+    if (pending->flags & MSGF_BLOCK)
+        releaseBlock(messageParams(pending));
+
+#ifdef PCR_ACTOR_MAILBOXES
+    mailboxRemove(q, getMailbox(address->actorPtr, address->priority), *address->pendingIdx);
+#endif
+
+    pending->flags = (byte)((pending->flags & ~MSGF_BLOCK) | MSGF_DELETED);
+    *address->pendingIdx = -1;
+}
+
+/// <summary>
+/// Clears the reserved flag of a message, so it can be dispatched.
+/// </summary>
+/// <param name="params">Message parameters, returned by 'reserveMessage'.</param>
+static void commitMessage(void* params)
+{
+#ifdef PCR_THREADS
+    threadedCommit(params);
+#else
+    MessageHeader*  msg = (MessageHeader*)((byte*)params - offsetof(MessageHeader, params));
+
+    lockSystemQueue();
+    msg->flags &= ~MSGF_RESERVED;
+    unlockSystemQueue();
+#endif
+}
+
+/// <summary>
+/// Links all pool blocks in the free list.
+/// </summary>
+static void initBlockPool()
+{
+    int i;
+
+    g_freeBlocks = NULL;
+    for (i = PCR_BLOCK_COUNT - 1; i >= 0; --i)
+    {
+        g_blocks[i].next = g_freeBlocks;
+        g_freeBlocks = &g_blocks[i];
+    }
+
+    g_blocksUsed = 0;
+    g_blocksHighWater = 0;
+}
+
+/// <summary>
+/// Allocates a pool block, for the parameters of a large message.
+/// The block shall be posted with 'postBlockMessage', or released with 'pcr_freeBlock'.
+/// </summary>
+/// <remarks>
+/// Running out of blocks is a system error (like a full queue in the 'stop' overflow 
+/// policy), so 'PCR_BLOCK_COUNT' shall be sized for the worst case.
+/// </remarks>
+/// <param name="size">Size of the parameters. It cannot exceed 'PCR_BLOCK_SIZE'.</param>
+/// <returns></returns>
+void* pcr_allocBlock(size_t size)
+{
+    PoolBlock*  block;
+
+    if (size > PCR_BLOCK_SIZE)
+    {
+        systemError("Message parameters too large for pool blocks!");
+        return NULL;
+    }
+
+    block = takeFreeBlock();
+    if (block == NULL)
+        systemError("Block pool exhausted!");
+
+    return block;
+}
+
+/// <summary>
+/// Reserves space for the parameters of a large message, preferably in a pool block.
+/// If they do not fit in a block, or the pool is exhausted, the space is reserved in 
+/// the system queue ('pcr_reserveMessage'), so large messages never stop the program.
+/// The message is posted with 'pcr_commitBlockMessage'.
+/// </summary>
+/// <param name="endPoint"></param>
+/// <param name="paramsSize"></param>
+/// <returns>Buffer for the message parameters.</returns>
+void* pcr_reserveBlockMessage(EndPointId endPoint, size_t paramsSize)
+{
+    PoolBlock*  block = NULL;
+
+    if (paramsSize <= PCR_BLOCK_SIZE)
+        block = takeFreeBlock();
+
+    if (block != NULL)
+        return block;
+    else
+        return pcr_reserveMessage(endPoint, paramsSize);
+}
+
+/// <summary>
+/// Posts a message reserved with 'pcr_reserveBlockMessage'.
+/// </summary>
+/// <param name="endPoint"></param>
+/// <param name="params"></param>
+void pcr_commitBlockMessage(EndPointId endPoint, void* params)
+{
+    PoolBlock*  block = (PoolBlock*)params;
+
+    if (block >= g_blocks && block < g_blocks + PCR_BLOCK_COUNT)
+        postBlockMessage(endPoint, params);
+    else
+        pcr_commitMessage(params);
+}
+
+/// <summary>
+/// Takes a block from the free list.
+/// </summary>
+/// <returns>The block, or NULL if the pool is exhausted.</returns>
+static PoolBlock* takeFreeBlock()
+{
+    PoolBlock*  block;
+
+    lockSystemQueue();
+    block = g_freeBlocks;
+    if (block != NULL)
+    {
+        g_freeBlocks = block->next;
+        if (++g_blocksUsed > g_blocksHighWater)
+            g_blocksHighWater = g_blocksUsed;
+    }
+    unlockSystemQueue();
+
+    return block;
+}
+
+/// <summary>
+/// Returns a block to the pool.
+/// </summary>
+void pcr_freeBlock(void* block)
+{
+    PoolBlock*  poolBlock = (PoolBlock*)block;
+
+    if (poolBlock == NULL)
+        return;
+
+    lockSystemQueue();
+    releaseBlock(poolBlock);
+    unlockSystemQueue();
+}
+
+/// <summary>
+/// Returns a block to the pool.
+/// </summary>
+/// <remarks>Must be called with the system queue locked.</remarks>
+static void releaseBlock(void* block)
+{
+    PoolBlock*  poolBlock = (PoolBlock*)block;
+
+    assert(poolBlock >= g_blocks && poolBlock < g_blocks + PCR_BLOCK_COUNT);
+
+    poolBlock->next = g_freeBlocks;
+    g_freeBlocks = poolBlock;
+    --g_blocksUsed;
+}
+
+/// <summary>
+/// Gets the parameters of a message, which are in a pool block for 'MSGF_BLOCK' messages.
+/// </summary>
+static void* messageParams(MessageHeader* msg)
+{
+    if (msg->flags & MSGF_BLOCK)
+        return *(void**)msg->params;
+    else
+        return msg->params;
+}
+
+#ifndef PCR_THREADS
+/// <summary>
+/// Gets the highest priority queue which has pending messages.
+/// Returns NULL if all are empty.
+/// </summary>
+/// <returns></returns>
+static SystemMsgQueue* getHighestQueue()
+{
+    int i;
+
+    for (i = PCR_PRIORITY_LEVELS - 1; i >= 0; --i)
+    {
+#ifdef PCR_ACTOR_MAILBOXES
+        if (g_msgQueues[i].readyHead >= 0)
+#else
+        if (g_msgQueues[i].readIdx >= 0)
+#endif
+            return &g_msgQueues[i];
+    }
+
+    return NULL;
+}
+#endif
+
+/// <summary>
+/// Gets a pointer to the first message in the queue.
+/// Returns NULL if empty.
+/// </summary>
+/// <returns></returns>
+static MessageHeader* getHeadMessage(SystemMsgQueue* q)
+{
+    //Check if empty
+    if (q->readIdx < 0)
+        return NULL;
+    else
+        return (MessageHeader*)(q->data + q->readIdx);
+}
+
+
+#ifndef PCR_THREADS
+/// <summary>
+/// Called before dispatching a message. If it is addressed to a conflating input,
+/// it stops being the pending one, so new messages to that input will be queued.
+/// </summary>
+/// <param name="msg"></param>
+static void releasePendingMessage(MessageHeader* msg)
+{
+    const EndPointAddress*  address = getEndPoint(msg->endPoint);
+
+    if (address->pendingIdx != NULL)
+    {
+        lockSystemQueue();
+        *address->pendingIdx = -1;
+        unlockSystemQueue();
+    }
+}
+
+/// <summary>
+/// Calls the handler function of a message.
+/// </summary>
+/// <param name="msg"></param>
+static void callMessageHandler(MessageHeader* msg)
+{
+    const EndPointAddress*  address = getEndPoint(msg->endPoint);
+    MessageHandlerFunction  input = (MessageHandlerFunction)address->inputPtr;
+    void*                   params = messageParams(msg);
+
+    assert(input != NULL);
+
+    releasePendingMessage(msg);
+
+    lockSystemQueue();
+    msg->flags |= MSGF_DISPATCHING;
+    unlockSystemQueue();
+
+#ifdef PCR_TELEMETRY
+    EndPointStats*  stats = getEndPointStats(address);
+    const unsigned  t0 = current_time_us();
+#endif
+
+    TRACE_EVENT(TRACE_DISPATCH_START, address);
+    input(address->actorPtr, params);
+    TRACE_EVENT(TRACE_DISPATCH_END, address);
+
+    if (msg->flags & MSGF_BLOCK)
+        pcr_freeBlock(params);
+
+#ifdef PCR_TELEMETRY
+    if (stats != NULL)
+    {
+        const unsigned  elapsed = current_time_us() - t0;
+
+        ++stats->dispatched;
+        stats->totalTimeUs += elapsed;
+        if (elapsed > stats->maxTimeUs)
+            stats->maxTimeUs = elapsed;
+    }
+#endif
+}
+#endif
+
+/// <summary>
+/// Removes the head message, and any invalid messages up to the
+/// next valid message.
+/// </summary>
+static void popHeadMessage(SystemMsgQueue* q)
+{
+    const MessageHeader*  msg = getHeadMessage(q);
+
+    if (msg == NULL)
+        return;
+
+    lockSystemQueue();
+
+    q->readIdx = (q->readIdx + msg->msgLength) % SYSTEM_QUEUE_SIZE;
+
+    //Skip the chunk at the end, if too small for a message. The write index may
+    //have already wrapped to the start.
+    if (q->readIdx != q->writeIdx && (size_t)(SYSTEM_QUEUE_SIZE - q->readIdx) < sizeof(MessageHeader))
+        q->readIdx = 0;
+
+    if (q->readIdx == q->writeIdx)
+        q->readIdx = q->writeIdx = -1;
+    else
+    {
+        //Check for deleted messages
+        //TODO: It would be better to avoid this recursive call.
+        msg = getHeadMessage(q);
+        if (msg != NULL && msg->flags & MSGF_DELETED)
+            popHeadMessage(q);
+    }
+
+    //printf("POP head message. ReadIdx: %d WriteIdx: %d\n", q->readIdx, q->writeIdx);
+
+    unlockSystemQueue();
+}
+
+/// <summary>
+/// Allocates space in a message queue for a new message.
+/// </summary>
+/// <param name="q"></param>
+/// <param name="size"></param>
+/// <returns>The index in the queue of the new message. -1 if it does not fit.</returns>
+static int queueAlloc(SystemMsgQueue* q, size_t size)
+{
+
+    if (q->writeIdx > q->readIdx)
+    {
+        const size_t available = SYSTEM_QUEUE_SIZE - q->writeIdx;
+        const int result = q->writeIdx;
+
+        if (size < available)
+            q->writeIdx += size;
+        else if (size == available)
+            q->writeIdx = 0;
+        else
+        {
+            if (available >= sizeof(MessageHeader))
+            {
+                MessageHeader*	header = (MessageHeader*)(q->data + q->writeIdx);
+
+                header->flags = MSGF_DELETED;
+                header->msgLength = (unsigned short)available;
+            }
+            q->writeIdx = 0;
+
+            //Recursive call, once the chunk at the end has been skipped.
+            return queueAlloc(q, size);
+        }
+
+        return result;
+    }
+    else
+    {
+        size_t available = q->readIdx - q->writeIdx;
+
+        if (q->readIdx < 0)
+        {
+            available = SYSTEM_QUEUE_SIZE;
+            q->readIdx = q->writeIdx = 0;
+        }
+        const int result = q->writeIdx;
+
+        if (size > available)
+            return -1;
+        else
+            q->writeIdx += size;
+
+        return result;
+    }
+}
+
+/// <summary>
+/// Gets the number of bytes in use in a message queue.
+/// </summary>
+/// <param name="q"></param>
+/// <returns></returns>
+static int queueUsedBytes(const SystemMsgQueue* q)
+{
+    if (q->readIdx < 0)
+        return 0;
+    else if (q->writeIdx > q->readIdx)
+        return q->writeIdx - q->readIdx;
+    else
+        return SYSTEM_QUEUE_SIZE - (q->readIdx - q->writeIdx);
+}
+
+/// <summary>
+/// Called when a message does not fit in its queue. Applies the current overflow policy.
+/// </summary>
+/// <remarks>Must be called with the system queue locked.</remarks>
+/// <param name="q"></param>
+/// <param name="size"></param>
+/// <returns>The index in the queue of the new message, or -1 if it has to be dropped.</returns>
+static int handleOverflow(SystemMsgQueue* q, size_t size)
+{
+    int idx = -1;
+    int i;
+
+    switch (g_overflowPolicy)
+    {
+    case PCR_OVERFLOW_DROP_NEWEST:
+        break;
+
+    case PCR_OVERFLOW_DROP_OLDEST:
+        while (idx < 0 && dropOldestMessage(q))
+            idx = queueAlloc(q, size);
+        break;
+
+    case PCR_OVERFLOW_BLOCK:
+        for (i = 0; idx < 0 && i < PCR_BLOCK_RETRIES; ++i)
+        {
+            unlockSystemQueue();
+            system_yield_CPU();
+            lockSystemQueue();
+            idx = queueAlloc(q, size);
+        }
+        break;
+
+    default:
+        systemError("System queue overflow!");
+        break;
+    }
+
+    return idx;
+}
+
+/// <summary>
+/// Discards the oldest message in a queue, to make room for new ones.
+/// </summary>
+/// <remarks>Must be called with the system queue locked.</remarks>
+/// <param name="q"></param>
+/// <returns>Non zero if a message has been discarded. The message being dispatched
+/// (or being written) cannot be discarded.</returns>
+static int dropOldestMessage(SystemMsgQueue* q)
+{
+    MessageHeader*  msg = getHeadMessage(q);
+
+    if (msg == NULL || (msg->flags & (MSGF_DISPATCHING | MSGF_RESERVED)))
+        return 0;
+
+    if (msg->flags & MSGF_DELETED)
+    {
+        popHeadMessage(q);
+        return 1;
+    }
+
+    const EndPointAddress*  address = getEndPoint(msg->endPoint);
+
+    if (address->pendingIdx != NULL)
+        *address->pendingIdx = -1;
+
+    if (msg->flags & MSGF_BLOCK)
+        releaseBlock(messageParams(msg));
+
+#ifdef PCR_ACTOR_MAILBOXES
+    //The oldest message of the queue is always the first one of its mailbox.
+    ActorMailbox*   mb = &g_mailboxes[getMailbox(address->actorPtr, address->priority)];
+
+    assert(mb->firstMsg == q->readIdx);
+    mb->firstMsg = msg->nextMsg;
+    if (mb->firstMsg < 0)
+        mb->lastMsg = -1;
+#endif
+
+#ifdef PCR_TELEMETRY
+    EndPointStats*  stats = getEndPointStats(address);
+
+    if (stats != NULL)
+        ++stats->dropped;
+#endif
+
+    TRACE_EVENT(TRACE_DROP, address);
+    ++q->dropped;
+    popHeadMessage(q);
+
+    return 1;
+}
+
+#ifdef PCR_ACTOR_MAILBOXES
+/// <summary>
+/// Gets the index of the mailbox of an actor, for the given priority.
+/// Mailboxes are allocated on first use.
+/// </summary>
+/// <param name="actorPtr"></param>
+/// <param name="priority"></param>
+/// <returns></returns>
+static int getMailbox(void* actorPtr, int priority)
+{
+    const size_t    hash = ((size_t)actorPtr / sizeof(void*)) * PCR_PRIORITY_LEVELS + priority;
+    int             idx = (int)(hash % PCR_MAX_MAILBOXES);
+    int             i;
+
+    for (i = 0; i < PCR_MAX_MAILBOXES; ++i)
+    {
+        ActorMailbox*   mb = &g_mailboxes[idx];
+
+        if (mb->actorPtr == NULL)
+        {
+            mb->actorPtr = actorPtr;
+            mb->priority = priority;
+            mb->firstMsg = mb->lastMsg = mb->nextReady = -1;
+            return idx;
+        }
+        else if (mb->actorPtr == actorPtr && mb->priority == priority)
+            return idx;
+
+        idx = (idx + 1) % PCR_MAX_MAILBOXES;
+    }
+
+    systemError("Too many actor mailboxes!");
+    return -1;
+}
+
+/// <summary>
+/// Appends a message to a mailbox. If the mailbox was empty, it is added at the end
+/// of the queue ready list.
+/// </summary>
+/// <remarks>Must be called with the system queue locked.</remarks>
+/// <param name="q"></param>
+/// <param name="mailboxIdx"></param>
+/// <param name="msgIdx"></param>
+static void mailboxPush(SystemMsgQueue* q, int mailboxIdx, int msgIdx)
+{
+    ActorMailbox*   mb = &g_mailboxes[mailboxIdx];
+
+    if (mb->lastMsg >= 0)
+        ((MessageHeader*)(q->data + mb->lastMsg))->nextMsg = msgIdx;
+    else
+    {
+        mb->firstMsg = msgIdx;
+        mb->nextReady = -1;
+
+        if (q->readyTail >= 0)
+            g_mailboxes[q->readyTail].nextReady = mailboxIdx;
+        else
+            q->readyHead = mailboxIdx;
+        q->readyTail = mailboxIdx;
+    }
+
+    mb->lastMsg = msgIdx;
+}
+
+/// <summary>
+/// Removes a message from an actor mailbox. If the mailbox becomes empty, it is also
+/// removed from the ready list.
+/// </summary>
+/// <remarks>Must be called with the system queue locked.</remarks>
+static void mailboxRemove(SystemMsgQueue* q, int mailboxIdx, int msgIdx)
+{
+    ActorMailbox*   mb = &g_mailboxes[mailboxIdx];
+    int             prev = -1;
+    int             idx = mb->firstMsg;
+
+    while (idx >= 0 && idx != msgIdx)
+    {
+        prev = idx;
+        idx = ((MessageHeader*)(q->data + idx))->nextMsg;
+    }
+
+    if (idx < 0)
+        return;
+
+    const int next = ((MessageHeader*)(q->data + idx))->nextMsg;
+
+    if (prev >= 0)
+        ((MessageHeader*)(q->data + prev))->nextMsg = next;
+    else
+        mb->firstMsg = next;
+
+    if (mb->lastMsg == msgIdx)
+        mb->lastMsg = prev;
+
+    if (mb->firstMsg >= 0)
+        return;
+
+    //Empty mailbox: unlink it from the ready list.
+    prev = -1;
+    for (idx = q->readyHead; idx >= 0 && idx != mailboxIdx; idx = g_mailboxes[idx].nextReady)
+        prev = idx;
+
+    if (idx < 0)
+        return;
+
+    if (prev >= 0)
+        g_mailboxes[prev].nextReady = mb->nextReady;
+    else
+        q->readyHead = mb->nextReady;
+
+    if (q->readyTail == mailboxIdx)
+        q->readyTail = prev;
+    mb->nextReady = -1;
+}
+
+/// <summary>
+/// Dispatches a batch of messages from the first ready mailbox of a queue.
+/// </summary>
+/// <remarks>
+/// The batch ends when the mailbox is empty, 'PCR_MAILBOX_BATCH' messages have been 
+/// dispatched, or a higher priority queue has messages. If the mailbox still has messages,
+/// it is moved to the end of the ready list.
+/// Dispatched messages are marked as deleted, and their space is reclaimed when they 
+/// reach the head of the queue. So, the queues need some extra space, compared to 
+/// the single queue mode, when several actors have pending messages.
+/// </remarks>
+/// <param name="q"></param>
+/// <returns>Number of dispatched messages, which can be 0 if the mailbox was already 
+/// drained. -1 if no message could be dispatched because the next one is still 
+/// being written.</returns>
+static int dispatchMailbox(SystemMsgQueue* q)
+{
+    const int       mailboxIdx = q->readyHead;
+    ActorMailbox*   mb;
+    int             count = 0;
+    int             blocked = 0;
+
+    //Only deleted or reserved messages remain in the queue.
+    if (mailboxIdx < 0)
+        return -1;
+
+    mb = &g_mailboxes[mailboxIdx];
+
+    while (mb->firstMsg >= 0 && count < PCR_MAILBOX_BATCH)
+    {
+        MessageHeader*  msg = (MessageHeader*)(q->data + mb->firstMsg);
+
+        if (msg->flags & MSGF_RESERVED)
+        {
+            blocked = 1;
+            break;
+        }
+
+        callMessageHandler(msg);
+        ++count;
+
+        lockSystemQueue();
+        msg->flags |= MSGF_DELETED;
+        mb->firstMsg = msg->nextMsg;
+        if (mb->firstMsg < 0)
+            mb->lastMsg = -1;
+        unlockSystemQueue();
+
+        //Reclaim the space of dispatched messages.
+        while (q->readIdx >= 0 && (getHeadMessage(q)->flags & MSGF_DELETED))
+            popHeadMessage(q);
+
+        if (getHighestQueue() != q)
+            break;
+    }
+
+    lockSystemQueue();
+
+    //Remove from ready list head. Re-append at the end if not empty.
+    q->readyHead = mb->nextReady;
+    if (q->readyHead < 0)
+        q->readyTail = -1;
+    mb->nextReady = -1;
+
+    if (mb->firstMsg >= 0)
+    {
+        if (q->readyTail >= 0)
+            g_mailboxes[q->readyTail].nextReady = mailboxIdx;
+        else
+            q->readyHead = mailboxIdx;
+        q->readyTail = mailboxIdx;
+    }
+
+    unlockSystemQueue();
+
+    return (blocked && count == 0) ? -1 : count;
+}
+#endif
+
+#ifdef PCR_TELEMETRY
+/// <summary>
+/// Gets the counters of an end point. They are allocated on first use.
+/// </summary>
+/// <param name="address"></param>
+/// <returns>NULL if the table is full.</returns>
+static EndPointStats* getEndPointStats(const EndPointAddress* address)
+{
+    const size_t    hash = (size_t)address->actorPtr / sizeof(void*) + (size_t)address->inputPtr;
+    int             idx = (int)(hash % PCR_TELEMETRY_ENDPOINTS);
+    int             i;
+
+    for (i = 0; i < PCR_TELEMETRY_ENDPOINTS; ++i)
+    {
+        EndPointStats*  stats = &g_endPointStats[idx];
+
+        if (stats->actorPtr == NULL)
+        {
+            stats->actorPtr = address->actorPtr;
+            stats->inputPtr = address->inputPtr;
+            return stats;
+        }
+        else if (stats->actorPtr == address->actorPtr && stats->inputPtr == address->inputPtr)
+            return stats;
+
+        idx = (idx + 1) % PCR_TELEMETRY_ENDPOINTS;
+    }
+
+    return NULL;
+}
+#endif
+
+#ifdef PCR_TRACE
+/// <summary>
+/// Records an event in the trace ring. The oldest events are overwritten.
+/// </summary>
+/// <param name="type"></param>
+/// <param name="address">Event end point.</param>
+static void traceEvent(int type, const EndPointAddress* address)
+{
+    TraceEvent* ev = &g_traceRing[TRACE_NEXT_SLOT() & (PCR_TRACE_EVENTS - 1)];
+
+    ev->time = PCR_TRACE_CLOCK();
+    ev->type = (byte)type;
+    ev->priority = (byte)address->priority;
+    ev->reserved = 0;
+    ev->padding = 0;
+    ev->actorPtr = address->actorPtr;
+    ev->inputPtr = address->inputPtr;
+}
+#endif
+
+#ifdef PCR_THREADS
+/// <summary>
+/// Initializes the threaded scheduler state. Pending messages from a previous run 
+/// are released.
+/// </summary>
+static void initThreads()
+{
+    static int  initialized = 0;
+    int         i;
+
+    for (i = 0; i < PCR_MAX_ACTORS; ++i)
+    {
+        ActorRecord*    rec = &g_actorRecords[i];
+
+        if (!initialized)
+            pthread_mutex_init(&rec->lock, NULL);
+
+        while (rec->firstMsg != NULL)
+        {
+            ThreadMessage*  msg = rec->firstMsg;
+
+            rec->firstMsg = msg->next;
+            free(msg);
+        }
+        rec->lastMsg = NULL;
+        rec->actorPtr = NULL;
+        rec->state = ACTOR_IDLE;
+    }
+
+    for (i = 0; i < PCR_WORKERS; ++i)
+    {
+        if (!initialized)
+            pthread_mutex_init(&g_runQueues[i].lock, NULL);
+        g_runQueues[i].head = g_runQueues[i].tail = 0;
+    }
+
+    if (g_workerCount < 1 || g_workerCount > PCR_WORKERS)
+        g_workerCount = PCR_WORKERS;
+
+    g_readyActors = 0;
+    g_stopWorkers = 0;
+    initialized = 1;
+}
+
+/// <summary>
+/// Starts 'g_workerCount - 1' worker threads, and runs worker 0 in the calling thread.
+/// Worker 0 also services the timers. Returns when 'stopWorkers' is called.
+/// </summary>
+static void runWorkers()
+{
+    pthread_t   threads[PCR_WORKERS];
+    int         i;
+
+    for (i = 1; i < g_workerCount; ++i)
+    {
+        if (pthread_create(&threads[i], NULL, workerThread, (void*)(size_t)i) != 0)
+            systemError("Cannot create worker thread");
+    }
+
+    t_workerIdx = 0;
+    workerLoop(0);
+    t_workerIdx = -1;
+
+    for (i = 1; i < g_workerCount; ++i)
+        pthread_join(threads[i], NULL);
+}
+
+/// <summary>
+/// Makes the workers finish, once they complete the actor they are running.
+/// </summary>
+static void stopWorkers()
+{
+    __atomic_store_n(&g_stopWorkers, 1, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_lock(&g_idleLock);
+    pthread_cond_broadcast(&g_idleCond);
+    pthread_mutex_unlock(&g_idleLock);
+}
+
+static void* workerThread(void* param)
+{
+    t_workerIdx = (int)(size_t)param;
+    workerLoop(t_workerIdx);
+    return NULL;
+}
+
+/// <summary>
+/// Worker main loop. Runs the actors of its run queue, or steals them from the
+/// other workers.
+/// </summary>
+/// <param name="worker"></param>
+static void workerLoop(int worker)
+{
+    while (!__atomic_load_n(&g_stopWorkers, __ATOMIC_ACQUIRE))
+    {
+        int active = 0;
+        int actorIdx = runQueuePop(worker);
+        int i;
+
+        if (worker == 0)
+            active = checkTimers();
+
+        //Steal
+        for (i = 1; actorIdx < 0 && i < g_workerCount; ++i)
+            actorIdx = runQueuePop((worker + i) % g_workerCount);
+
+        if (actorIdx >= 0)
+            runActor(worker, actorIdx);
+        else if (active)
+            continue;
+        else if (worker == 0)
+            system_yield_CPU();
+        else
+            waitForWork();
+    }
+}
+
+/// <summary>
+/// Blocks an idle worker until some actor is ready (or a timeout expires).
+/// </summary>
+static void waitForWork()
+{
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 10 * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_nsec -= 1000000000;
+        ++deadline.tv_sec;
+    }
+
+    pthread_mutex_lock(&g_idleLock);
+
+    //'g_idleWorkers' is incremented before checking 'g_readyActors', and 'runQueuePush'
+    //does it in the opposite order. So, either the worker sees the ready actor, or the
+    //producer sees the idle worker (and signals it after it waits, as it holds the lock).
+    __atomic_add_fetch(&g_idleWorkers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_readyActors, __ATOMIC_SEQ_CST) == 0
+        && !__atomic_load_n(&g_stopWorkers, __ATOMIC_SEQ_CST))
+    {
+        pthread_cond_timedwait(&g_idleCond, &g_idleLock, &deadline);
+    }
+    __atomic_sub_fetch(&g_idleWorkers, 1, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_unlock(&g_idleLock);
+}
+
+/// <summary>
+/// Threaded mode 'reserveMessage'. Allocates the message, which is not visible to the
+/// workers until it is committed.
+/// </summary>
+static void* threadedReserve(EndPointId endPoint, size_t paramsSize, int flags)
+{
+    ThreadMessage*  msg = (ThreadMessage*)malloc(offsetof(ThreadMessage, params) + paramsSize);
+
+    TRACE_EVENT(TRACE_POST, getEndPoint(endPoint));
+
+    if (msg == NULL)
+    {
+        systemError("Out of memory for messages!");
+        return NULL;
+    }
+
+    msg->next = NULL;
+    msg->endPoint = endPoint;
+    msg->flags = flags;
+
+    return msg->params;
+}
+
+/// <summary>
+/// Threaded mode 'commitMessage'. Appends the message to the actor mailbox, and if the
+/// actor was idle, makes it ready in the run queue of the posting worker (or of a 
+/// round robin selected one, if posted from other thread).
+/// </summary>
+static void threadedCommit(void* params)
+{
+    ThreadMessage*  msg = (ThreadMessage*)((byte*)params - offsetof(ThreadMessage, params));
+    int             actorIdx;
+    ActorRecord*    rec;
+    int             schedule = 0;
+
+    actorIdx = getActorRecord(getEndPoint(msg->endPoint)->actorPtr);
+    rec = &g_actorRecords[actorIdx];
+
+    pthread_mutex_lock(&rec->lock);
+    if (rec->lastMsg != NULL)
+        rec->lastMsg->next = msg;
+    else
+        rec->firstMsg = msg;
+    rec->lastMsg = msg;
+
+    if (rec->state == ACTOR_IDLE)
+    {
+        rec->state = ACTOR_READY;
+        schedule = 1;
+    }
+    pthread_mutex_unlock(&rec->lock);
+
+    if (schedule)
+    {
+        int worker = t_workerIdx;
+
+        if (worker < 0)
+            worker = (int)(__atomic_fetch_add(&g_nextWorker, 1, __ATOMIC_RELAXED) % g_workerCount);
+
+        runQueuePush(worker, actorIdx);
+    }
+}
+
+/// <summary>
+/// Gets the index of the mailbox of an actor. Mailboxes are allocated on first use.
+/// </summary>
+/// <remarks>
+/// Lookups do not take locks: entries are never released, and 'actorPtr' is written
+/// (with release semantics) after the entry is initialized.
+/// </remarks>
+static int getActorRecord(void* actorPtr)
+{
+    const size_t    hash = (size_t)actorPtr / sizeof(void*);
+    int             idx = (int)(hash % PCR_MAX_ACTORS);
+    int             i;
+
+    for (i = 0; i < PCR_MAX_ACTORS; ++i)
+    {
+        void*   ptr = __atomic_load_n(&g_actorRecords[idx].actorPtr, __ATOMIC_ACQUIRE);
+
+        if (ptr == actorPtr)
+            return idx;
+        else if (ptr == NULL)
+            break;
+
+        idx = (idx + 1) % PCR_MAX_ACTORS;
+    }
+
+    pthread_mutex_lock(&g_actorTableLock);
+
+    idx = (int)(hash % PCR_MAX_ACTORS);
+    for (i = 0; i < PCR_MAX_ACTORS; ++i)
+    {
+        ActorRecord*    rec = &g_actorRecords[idx];
+
+        if (rec->actorPtr == actorPtr)
+            break;
+        else if (rec->actorPtr == NULL)
+        {
+            rec->firstMsg = rec->lastMsg = NULL;
+            rec->state = ACTOR_IDLE;
+            __atomic_store_n(&rec->actorPtr, actorPtr, __ATOMIC_RELEASE);
+            break;
+        }
+
+        idx = (idx + 1) % PCR_MAX_ACTORS;
+    }
+
+    pthread_mutex_unlock(&g_actorTableLock);
+
+    if (i == PCR_MAX_ACTORS)
+        systemError("Too many actors!");
+
+    return idx;
+}
+
+/// <summary>
+/// Adds a ready actor at the end of a worker run queue, and wakes up an idle worker.
+/// </summary>
+static void runQueuePush(int worker, int actorIdx)
+{
+    RunQueue*   q = &g_runQueues[worker];
+
+    pthread_mutex_lock(&q->lock);
+    q->actors[q->tail % PCR_MAX_ACTORS] = actorIdx;
+    //Atomic stores, as 'runQueuePop' peeks 'head' and 'tail' without the lock.
+    __atomic_store_n(&q->tail, q->tail + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&q->lock);
+
+    __atomic_add_fetch(&g_readyActors, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_idleWorkers, __ATOMIC_SEQ_CST) > 0)
+    {
+        pthread_mutex_lock(&g_idleLock);
+        pthread_cond_signal(&g_idleCond);
+        pthread_mutex_unlock(&g_idleLock);
+    }
+}
+
+/// <summary>
+/// Removes the first actor of a worker run queue.
+/// </summary>
+/// <returns>Actor index, or -1 if the queue is empty.</returns>
+static int runQueuePop(int worker)
+{
+    RunQueue*   q = &g_runQueues[worker];
+    int         actorIdx = -1;
+
+    //Unlocked peek, to avoid taking the locks of empty queues while stealing.
+    if (__atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE))
+        return -1;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->head != q->tail)
+    {
+        actorIdx = q->actors[q->head % PCR_MAX_ACTORS];
+        __atomic_store_n(&q->head, q->head + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    if (actorIdx >= 0)
+        __atomic_sub_fetch(&g_readyActors, 1, __ATOMIC_SEQ_CST);
+
+    return actorIdx;
+}
+
+/// <summary>
+/// Dispatches a batch of messages of a ready actor. If it still has messages, it is
+/// appended again to the worker run queue.
+/// </summary>
+/// <returns>Number of dispatched messages.</returns>
+static int runActor(int worker, int actorIdx)
+{
+    ActorRecord*    rec = &g_actorRecords[actorIdx];
+    int             count;
+    int             requeue;
+
+    pthread_mutex_lock(&rec->lock);
+    rec->state = ACTOR_RUNNING;
+    pthread_mutex_unlock(&rec->lock);
+
+    for (count = 0; count < PCR_ACTOR_BATCH; ++count)
+    {
+        ThreadMessage*          msg;
+        const EndPointAddress*  address;
+        void*                   params;
+
+        pthread_mutex_lock(&rec->lock);
+        msg = rec->firstMsg;
+        if (msg != NULL)
+        {
+            rec->firstMsg = msg->next;
+            if (rec->firstMsg == NULL)
+                rec->lastMsg = NULL;
+        }
+        pthread_mutex_unlock(&rec->lock);
+
+        if (msg == NULL)
+            break;
+
+        params = (msg->flags & MSGF_BLOCK) ? *(void**)msg->params : msg->params;
+
+        address = getEndPoint(msg->endPoint);
+        assert(address->inputPtr != NULL);
+        TRACE_EVENT(TRACE_DISPATCH_START, address);
+        ((MessageHandlerFunction)address->inputPtr)(address->actorPtr, params);
+        TRACE_EVENT(TRACE_DISPATCH_END, address);
+        if (msg->flags & MSGF_BLOCK)
+            pcr_freeBlock(params);
+        free(msg);
+    }
+
+    pthread_mutex_lock(&rec->lock);
+    requeue = rec->firstMsg != NULL;
+    rec->state = requeue ? ACTOR_READY : ACTOR_IDLE;
+    pthread_mutex_unlock(&rec->lock);
+
+    if (requeue)
+        runQueuePush(worker, actorIdx);
+
+    return count;
+}
+#endif
+
+static void lockSystemQueue()
+{
+    system_disableInterrupts();
+#ifdef PCR_THREADS
+    pthread_mutex_lock(&g_systemLock);
+#endif
+}
+
+static void unlockSystemQueue()
+{
+#ifdef PCR_THREADS
+    pthread_mutex_unlock(&g_systemLock);
+#endif
+    system_enableInterrupts();
+}
+
+static void systemError(const char* message)
+{
+    //TODO: Better logging
+    fprintf(stderr, "System error: %s\n", message);
+
+    system_stop(-1);
+}
+
+/// <summary>
+/// Called by generated code when an array index is out of bounds. The program is 
+/// stopped, instead of corrupting memory.
+/// </summary>
+void pcr_indexOutOfRange(int index, int size)
+{
+    fprintf(stderr, "System error: array index %d out of range [0, %d)\n", index, size);
+
+    system_stop(-1);
+}
+
+/// <summary>
+/// Exit hook of instrumented functions and actor inputs ('filsc --instrument').
+/// Counters are not atomic: with 'PCR_THREADS' they are approximate.
+/// </summary>
+/// <param name="table">Profile table of the generated code.</param>
+/// <param name="index">Entry of the function.</param>
+/// <param name="start">Cycle counter on function entry ('system_cycles').</param>
+void pcr_profileExit(PcrProfileEntry* table, int index, unsigned long long start)
+{
+    const unsigned long long    cycles = system_cycles() - start;
+    PcrProfileEntry*            entry = &table[index];
+
+    //The table is written at exit.
+    if (g_profileTable == NULL)
+    {
+        g_profileTable = table;
+        atexit(pcr_dumpProfile);
+    }
+
+    entry->calls++;
+    entry->totalCycles += cycles;
+    if (cycles > entry->maxCycles)
+        entry->maxCycles = cycles;
+}
+
+/// <summary>
+/// Writes the profile counters of instrumented code to the standard error. Functions
+/// and inputs which have not been called are omitted. Called cycles are included.
+/// </summary>
+void pcr_dumpProfile()
+{
+    const PcrProfileEntry*  entry;
+
+    if (g_profileTable == NULL)
+        return;
+
+    fprintf(stderr, "Profile (cycles)\nname\tcalls\ttotal\tavg\tmax\n");
+    for (entry = g_profileTable; entry->name != NULL; ++entry)
+    {
+        if (entry->calls == 0)
+            continue;
+
+        fprintf(stderr, "%s\t%u\t%llu\t%llu\t%llu\n", entry->name, entry->calls,
+            entry->totalCycles, entry->totalCycles / entry->calls, entry->maxCycles);
+    }
+}
+
+void quit(void* params)
+{
+    typedef struct {
+        int code;
+    }ParamsT;
+
+    ParamsT*    pParams = (ParamsT*)params;
+
+#ifdef PCR_THREADS
+    //Other workers may be running handlers. 'runScheduler' stops the system when
+    //they finish.
+    g_exitCode = pParams->code;
+    stopWorkers();
+#else
+    stopSystem(pParams->code);
+#endif
+}
+
+/// <summary>
+/// Writes the diagnostics files and stops the platform.
+/// </summary>
+static void stopSystem(int code)
+{
+#ifdef PCR_TELEMETRY
+    pcr_dumpTelemetry();
+#endif
+#ifdef PCR_TRACE
+    pcr_writeTrace();
+#endif
+    system_stop(code);
+}
+
+/// <summary>
+/// Gets the maximum number of bytes used in a message queue.
+/// </summary>
+int pcr_queueHighWater(void* params)
+{
+    typedef struct {
+        int priority;
+    }ParamsT;
+
+    ParamsT*    pParams = (ParamsT*)params;
+
+    if (pParams->priority < 0 || pParams->priority >= PCR_PRIORITY_LEVELS)
+        return -1;
+    else
+        return g_msgQueues[pParams->priority].highWater;
+}
+
+/// <summary>
+/// Gets the number of messages dropped by a message queue, because of overflow.
+/// </summary>
+int pcr_queueDropped(void* params)
+{
+    typedef struct {
+        int priority;
+    }ParamsT;
+
+    ParamsT*    pParams = (ParamsT*)params;
+
+    if (pParams->priority < 0 || pParams->priority >= PCR_PRIORITY_LEVELS)
+        return -1;
+    else
+        return (int)g_msgQueues[pParams->priority].dropped;
+}
+
+/// <summary>
+/// Sets the queue overflow policy. Invalid values are ignored.
+/// </summary>
+void pcr_setOverflowPolicy(void* params)
+{
+    typedef struct {
+        int policy;
+    }ParamsT;
+
+    ParamsT*    pParams = (ParamsT*)params;
+
+    if (pParams->policy >= PCR_OVERFLOW_STOP && pParams->policy <= PCR_OVERFLOW_BLOCK)
+        g_overflowPolicy = pParams->policy;
+}
+
+/// <summary>
+/// Writes queue and end point counters to the standard error.
+/// </summary>
+void pcr_dumpTelemetry()
+{
+    int i;
+
+    fprintf(stderr, "Queue telemetry (size: %d bytes)\n", SYSTEM_QUEUE_SIZE);
+    for (i = 0; i < PCR_PRIORITY_LEVELS; ++i)
+    {
+        const SystemMsgQueue*   q = &g_msgQueues[i];
+
+        fprintf(stderr, "  priority %d: high water %d bytes, posted %u, dropped %u\n",
+            i, q->highWater, q->posted, q->dropped);
+    }
+    fprintf(stderr, "Block pool (%d x %d bytes): high water %d blocks\n",
+        PCR_BLOCK_COUNT, PCR_BLOCK_SIZE, g_blocksHighWater);
+
+#ifdef PCR_TELEMETRY
+    fprintf(stderr, "End point telemetry\n");
+    for (i = 0; i < PCR_TELEMETRY_ENDPOINTS; ++i)
+    {
+        const EndPointStats*    stats = &g_endPointStats[i];
+
+        if (stats->actorPtr == NULL)
+            continue;
+
+        fprintf(stderr, "  actor %p input %p: posted %u, conflated %u, dropped %u, dispatched %u, "
+            "time total %u us, avg %u us, max %u us\n",
+            stats->actorPtr, stats->inputPtr,
+            stats->posted, stats->conflated, stats->dropped, stats->dispatched,
+            stats->totalTimeUs, 
+            stats->dispatched > 0 ? stats->totalTimeUs / stats->dispatched : 0,
+            stats->maxTimeUs);
+    }
+#endif
+}
+
+void digitalOut(void* params)
+{
+    typedef struct {
+        int address;
+        unsigned char value;
+    }ParamsT;
+
+    ParamsT*    pParams = (ParamsT*)params;
+    gpio_write(pParams->address, pParams->value);
+}
+
+/// <summary>
+/// Writes the trace ring to 'PCR_TRACE_FILE'. It does nothing if the runtime has 
+/// not been compiled with 'PCR_TRACE'.
+/// </summary>
+/// <remarks>
+/// File format (native byte order):
+///     "PCRTRACE", version (uint32), pointer size (uint32), symbol count (uint32),
+///     event count (uint32), clock ticks (uint64), clock microseconds (uint64),
+///     symbols, events.
+/// Clock ticks and microseconds are measured from 'initPcr', to convert event time
+/// stamps. 'current_time_us' wraps, so the calibration is only valid if the trace is
+/// written less than 71 minutes after 'initPcr'.
+/// Each symbol is: address (pointer), name length (uint16), name (without terminator).
+/// Events are 'TraceEvent' records, oldest first. Events recorded while the file is
+/// being written may be incomplete.
+/// </remarks>
+void pcr_writeTrace()
+{
+#ifdef PCR_TRACE
+    FILE*           file = fopen(PCR_TRACE_FILE, "wb");
+    const unsigned  version = 2;
+    const unsigned long long    clockTicks = PCR_TRACE_CLOCK() - g_traceClockBase;
+    const unsigned long long    clockUs = (unsigned)(current_time_us() - g_traceTimeBase);
+    const unsigned  ptrSize = sizeof(void*);
+    unsigned        symbolCount = 0;
+    unsigned        eventCount;
+    unsigned        first;
+    unsigned        i;
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot write trace file: %s\n", PCR_TRACE_FILE);
+        return;
+    }
+
+    lockSystemQueue();
+
+    while (pcr_traceSymbols[symbolCount].address != NULL)
+        ++symbolCount;
+
+    eventCount = g_traceCount < PCR_TRACE_EVENTS ? g_traceCount : PCR_TRACE_EVENTS;
+    first = g_traceCount - eventCount;
+
+    fwrite("PCRTRACE", 1, 8, file);
+    fwrite(&version, sizeof(version), 1, file);
+    fwrite(&ptrSize, sizeof(ptrSize), 1, file);
+    fwrite(&symbolCount, sizeof(symbolCount), 1, file);
+    fwrite(&eventCount, sizeof(eventCount), 1, file);
+    fwrite(&clockTicks, sizeof(clockTicks), 1, file);
+    fwrite(&clockUs, sizeof(clockUs), 1, file);
+
+    for (i = 0; i < symbolCount; ++i)
+    {
+        const PcrTraceSymbol*   symbol = &pcr_traceSymbols[i];
+        const unsigned short    length = (unsigned short)strlen(symbol->name);
+
+        fwrite(&symbol->address, sizeof(void*), 1, file);
+        fwrite(&length, sizeof(length), 1, file);
+        fwrite(symbol->name, 1, length, file);
+    }
+
+    for (i = 0; i < eventCount; ++i)
+        fwrite(&g_traceRing[(first + i) & (PCR_TRACE_EVENTS - 1)], sizeof(TraceEvent), 1, file);
+
+    unlockSystemQueue();
+    fclose(file);
+#endif
+}
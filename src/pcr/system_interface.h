@@ -6,18 +6,58 @@
 
 
 /// <summary>
-/// Message endpoint address structure
+/// Message end point identifier: index in the end point table. Each (actor instance, input)
+/// pair gets a consecutive identifier when the actor is registered ('pcr_registerActor').
+/// Zero is not a valid end point (it is the value of not connected outputs).
+/// </summary>
+typedef unsigned short EndPointId;
+
+/// <summary>
+/// Message endpoint address structure. Entry of the end point table.
 /// </summary>
 typedef struct {
     void *actorPtr;
     void *inputPtr;
+    int  priority;      //Message queue in which messages to this end point are posted.
+    int  *pendingIdx;   //Conflating inputs: index of the pending message in the queue (-1 if none).
+                        //NULL for normal inputs.
 }EndPointAddress;
 
+/// <summary>
+/// Description of an actor input, in the input tables generated for each actor type.
+/// </summary>
+typedef struct {
+    void*   inputPtr;
+    int     priority;
+    int     pendingOffset;  //Conflating inputs: offset of the pending index in the actor. -1 if not.
+}PcrInputInfo;
+
+/// <summary>
+/// Name of an actor input function, for runtime traces ('PCR_TRACE').
+/// The generated code defines the 'pcr_traceSymbols' table, ended by a NULL entry.
+/// </summary>
+typedef struct {
+    const void* address;
+    const char* name;
+}PcrTraceSymbol;
+
+/// <summary>
+/// Profile counters of a function or actor input, for instrumented code 
+/// ('filsc --instrument'). The generated code defines a table of them, ended 
+/// by an entry with a NULL name.
+/// </summary>
+typedef struct {
+    const char*         name;
+    unsigned            calls;
+    unsigned long long  totalCycles;
+    unsigned long long  maxCycles;
+}PcrProfileEntry;
+
 /// <summary>
 /// Timer information structure.
 /// </summary>
 typedef struct _TimerInfo {
-    EndPointAddress     destInput;
+    EndPointId          destInput;
     struct _TimerInfo*  next;
     unsigned            base;
     unsigned            periodMS;
@@ -34,7 +74,14 @@ void system_yield_CPU();
 TimerInfo* timer_getFirst();
 void timer_stop_id(int id);
 void timer_schedule(TimerInfo* timer);
+
+//Implemented by the runtime. Platform timer functions must access the timer list
+//between these calls.
+void pcr_lockTimers();
+void pcr_unlockTimers();
 unsigned current_time();
+unsigned current_time_us();
+unsigned long long system_cycles();
 
 
 void gpio_write(int address, int value);
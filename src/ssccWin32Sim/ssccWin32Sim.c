@@ -4,9 +4,11 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#include <intrin.h>
 
 #include "system_interface.h"
 
@@ -26,6 +28,14 @@ static HANDLE  g_intMutex;
 // Head of the timer queue.
 static TimerInfo * g_headTimer = NULL;
 
+//Virtual time mode. Enabled by 'FILS_VIRTUAL_TIME' environment variable.
+//When there is nothing to do, time jumps to the next timer deadline, instead of
+//waiting for it. So, programs run as fast as the CPU allows, and deterministically.
+static int g_virtualTime = 0;
+
+//Current virtual time, in milliseconds.
+static unsigned g_virtualNow = 0;
+
 
 void system_disableInterrupts()
 {
@@ -46,13 +56,34 @@ void system_stop(int code)
 
 void system_init()
 {
+    const char* virtualTime = getenv("FILS_VIRTUAL_TIME");
+
     g_intMutex = CreateMutex(NULL, FALSE, NULL);
+    g_virtualTime = virtualTime != NULL && virtualTime[0] != 0 && strcmp(virtualTime, "0") != 0;
 }
 
 void system_yield_CPU()
 {
     //TODO: By the moment, is just fine to do nothing on the simulator.
     //but it would be nice a mechanism to really yield the CPU.
+    if (g_virtualTime)
+    {
+        int stop = 0;
+
+        //Nothing else can happen until the next timer expires.
+        pcr_lockTimers();
+        if (g_headTimer == NULL)
+            stop = 1;
+        else if (g_headTimer->base + g_headTimer->periodMS > g_virtualNow)
+            g_virtualNow = g_headTimer->base + g_headTimer->periodMS;
+        pcr_unlockTimers();
+
+        if (stop)
+        {
+            puts("Virtual time: no pending messages nor timers.");
+            system_stop(-2);
+        }
+    }
 }
 
 void gpio_write(int address, int value)
@@ -65,10 +96,13 @@ int timer_start(void* params)
 {
     struct Params {
         int periodMS;               //Timer period, in milliseconds.
-        EndPointAddress endPoint;   //Timer message destination end point.
+        EndPointId      endPoint;   //Timer message destination end point.
         TimerInfo*      info;       //Timer information structure.
     };
     struct Params* pParams = (struct Params*)params;
+    int            id;
+
+    pcr_lockTimers();
 
     if (pParams->info->id >= 0)
         timer_stop_id(pParams->info->id);
@@ -80,8 +114,11 @@ int timer_start(void* params)
     pParams->info->next = NULL;
 
     g_headTimer = schedule_timer_int(g_headTimer, pParams->info);
+    id = pParams->info->id;
+
+    pcr_unlockTimers();
 
-    return pParams->info->id;
+    return id;
 }
 
 void timer_stop(void* params)
@@ -91,6 +128,9 @@ void timer_stop(void* params)
     };
     struct Params* pParams = (struct Params*)params;
 
+    pcr_lockTimers();
+    timer_stop_id(pParams->timerID);
+    pcr_unlockTimers();
 }
 
 //Returns the first timer in timer queue.
@@ -101,10 +141,11 @@ TimerInfo* timer_getFirst()
 
 
 //Internal version of timer ID. Receives an integer timer ID parameter.
+//The caller must hold the timer list lock ('pcr_lockTimers').
 void timer_stop_id(int id)
 {
-    TimerInfo*  prev = g_headTimer;
-    TimerInfo*  timer = NULL;
+    TimerInfo*  prev = NULL;
+    TimerInfo*  timer = g_headTimer;
 
     //look for timer.
     while (timer != NULL && timer->id != id)
@@ -170,7 +211,7 @@ static int new_timer_id(TimerInfo* head)
     
     for (TimerInfo* t = head; t != NULL; t = t->next)
     {
-        if (t->id > id)
+        if (t->id >= id)
             id = t->id + 1;
     }
 
@@ -180,9 +221,33 @@ static int new_timer_id(TimerInfo* head)
 // Gets current time, in milliseconds.
 unsigned current_time()
 {
+    if (g_virtualTime)
+        return g_virtualNow;
+
     return GetTickCount();
 }
 
+// Gets current time, in microseconds. Used to measure message dispatch times.
+unsigned current_time_us()
+{
+    if (g_virtualTime)
+        return g_virtualNow * 1000;
+
+    LARGE_INTEGER   freq;
+    LARGE_INTEGER   counter;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+
+    return (unsigned)(unsigned long long)(counter.QuadPart * (1000000.0 / freq.QuadPart));
+}
+
+// Reads the CPU time stamp counter. Used by instrumented code.
+unsigned long long system_cycles()
+{
+    return __rdtsc();
+}
+
 //Compares 2 timer times.
 //Returns:
 //  >0 if t1 is greater.
@@ -20,3 +20,39 @@ TEST(Builder, buildModule)
 
     //ASSERT_TRUE(r.ok());
 }
+
+/// <summary>
+/// Tests 'checkMemoryBudgets' function
+/// </summary>
+TEST(Builder, checkMemoryBudgets)
+{
+    MemoryUsage     usage;
+    BuilderConfig   cfg;
+    StackUsage      handler;
+
+    handler.name = "_Main.tick";
+    handler.frame = 32;
+    handler.worst = 128;
+    usage.handlers.push_back(handler);
+    usage.actorsRam = 100;
+    usage.runtimeRam = 900;
+
+    //No limits
+    EXPECT_NO_THROW(checkMemoryBudgets(usage, cfg));
+
+    cfg.StackBudget = 128;
+    cfg.RamBudget = 1000;
+    EXPECT_NO_THROW(checkMemoryBudgets(usage, cfg));
+
+    cfg.StackBudget = 127;
+    EXPECT_THROW(checkMemoryBudgets(usage, cfg), CompileError);
+
+    cfg.StackBudget = 128;
+    cfg.RamBudget = 999;
+    EXPECT_THROW(checkMemoryBudgets(usage, cfg), CompileError);
+
+    //Recursive handlers never fit in a budget.
+    cfg.RamBudget = 0;
+    usage.handlers[0].bounded = false;
+    EXPECT_THROW(checkMemoryBudgets(usage, cfg), CompileError);
+}
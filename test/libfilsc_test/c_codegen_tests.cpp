@@ -8,10 +8,23 @@
 #include "semanticAnalysis.h"
 #include "utils.h"
 
+#include <regex>
 //#include <time.h>
 
 using namespace std;
 
+/// <summary>
+/// Counts the occurrences of a pattern in a text (usually, generated code).
+/// </summary>
+static size_t countText(const string& text, const string& pattern)
+{
+    size_t count = 0;
+
+    for (size_t pos = text.find(pattern); pos != string::npos; pos = text.find(pattern, pos + 1))
+        ++count;
+    return count;
+}
+
 /// <summary>
 /// Fixture for code generation tests.
 /// </summary>
@@ -30,8 +43,9 @@ protected:
     /// </summary>
     /// <param name="name"></param>
     /// <param name="code"></param>
+    /// <param name="compilerFlags">Additional 'C' compiler flags</param>
     /// <returns></returns>
-    int runTest(const char* name, const char* code)
+    int runTest(const char* name, const char* code, const char* compilerFlags = "")
     {
         //clock_t		t0 = clock();
         auto parseRes = testParse(code);
@@ -56,7 +70,7 @@ protected:
         //cout << "FIL-S compile time: " << double(t1 - t0)*1000 / CLOCKS_PER_SEC << " msegs.\n";
         //t0 = t1;
 
-        compileC(name);
+        compileC(name, compilerFlags);
         //t1 = clock();
         //cout << "'C' compile time: " << double(t1 - t0)*1000 / CLOCKS_PER_SEC << " msegs.\n";
         //t0 = t1;
@@ -113,11 +127,19 @@ private:
     {
         static const char * prolog =
             "#include <stdio.h>\n"
+            "#include <stdint.h>\n"
+            "#include <stdlib.h>\n"
             "//************ Prolog\n"
             "\n"
             "typedef unsigned char bool;\n"
             "static const bool true = 1;\n"
             "static const bool false = 0;\n"
+            "\n"
+            "void pcr_indexOutOfRange(int index, int size)\n"
+            "{\n"
+            "	printf (\"Array index %d out of range [0, %d)\\n\", index, size);\n"
+            "	exit (99);\n"
+            "}\n"
             "\n";
         static const char * epilog =
             "\n//************ Epilog\n"
@@ -177,9 +199,9 @@ private:
         return system(command.c_str());
     }
 
-    void compileC(const char* testName)
+    void compileC(const char* testName, const char* compilerFlags)
     {
-        string scriptPath = createCompileScript(testName);
+        string scriptPath = createCompileScript(testName, compilerFlags);
 
         string command = "cmd /C \"" + scriptPath + "\" >NUL";
 
@@ -197,14 +219,14 @@ private:
         return m_resultsDir + "/" + testName + extension;
     }
 
-    string createCompileScript(const char* testName)
+    string createCompileScript(const char* testName, const char* compilerFlags)
     {
         //TODO: This function is very system dependent.
         static const char* base =
             "call \"H:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\Community\\VC\\Auxiliary\\Build\\vcvars32.bat\"\n"
             "cd \"%s\"\n"
             "%s\n"
-            "cl %s.c -nologo /FAs /Ox >%s.compiler.out\n";
+            "cl %s.c -nologo /FAs /Ox %s >%s.compiler.out\n";
 
         char buffer[4096];
         string absPath = joinPaths(getCurrentDirectory(), m_resultsDir);
@@ -214,7 +236,7 @@ private:
         absPath = normalizePath(absPath);
         scriptPath = normalizePath(scriptPath);
 
-        sprintf_s(buffer, base, absPath.c_str(), drive.c_str(), testName, testName);
+        sprintf_s(buffer, base, absPath.c_str(), drive.c_str(), testName, compilerFlags, testName);
 
         if (!writeTextFile(scriptPath, buffer))
         {
@@ -320,6 +342,33 @@ TEST_F(C_CodegenTests, tupleCodegen)
     );
 }
 
+/// <summary>
+/// Test code generation for copies between compatible tuples with different 'C' 
+/// layouts: 'struct[C]' types keep declaration order, other tuples are reordered.
+/// </summary>
+TEST_F(C_CodegenTests, tupleAdapterCodegen)
+{
+    EXPECT_RUN_OK("tupleAdapter1",
+        "struct[C] CT(x:bool, y:int, z:bool)\n"
+        "struct[C] Outer(i:CT, w:int)\n"
+        "function test ():int {\n"
+        "  var o:Outer = ((true, 7, false), 9)\n"
+        "  var t:(a:(p:bool, q:int, r:bool), w:int) = o\n"
+        "  if (t.a.q != 7) return 1010\n"
+        "  if (t.w != 9) return 1020\n"
+        "  if (!t.a.p) return 1030\n"
+        "  if (t.a.r) return 1040\n"
+        "  t.a.q = 5\n"
+        "  t.w = 3\n"
+        "  o = t\n"
+        "  if (o.i.y != 5) return 1050\n"
+        "  if (o.w != 3) return 1060\n"
+        "  if (!o.i.x) return 1070\n"
+        "  0\n"
+        "}\n"
+    );
+}
+
 
 /// <summary>
 /// Test code generation for return statements.
@@ -401,6 +450,407 @@ TEST_F(C_CodegenTests, callCodegen)
 }
 
 
+/// <summary>
+/// Tests how messages are posted: in the queue, or in a pool block, depending on
+/// the size of their parameters.
+/// </summary>
+TEST_F(C_CodegenTests, messagePostCodegen)
+{
+    auto parseRes = testParse(
+        "actor _Main {\n"
+        "  output small(x:int)\n"
+        "  output medium(p:int, q:int)\n"
+        "  output large(a:int, b:int, c:int, d:int, e:int)\n"
+        "  input run() {\n"
+        "    small(1)\n"
+        "    medium(1, 2)\n"
+        "    large(1, 2, 3, 4, 5)\n"
+        "  }\n"
+        "}\n"
+    );
+    ASSERT_TRUE(parseRes.ok());
+
+    auto semanticRes = semanticAnalysis(parseRes.result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    CodeGeneratorConfig config;
+
+    config.blockParamsThreshold = 4;
+    config.blockSize = 16;
+
+    string cCode = generateCode(semanticRes.result, config);
+
+    //Only 'medium' fits in a pool block. 'large' is too big for them.
+    EXPECT_EQ(1, countText(cCode, "pcr_reserveBlockMessage ("));
+    EXPECT_EQ(1, countText(cCode, "pcr_commitBlockMessage ("));
+    EXPECT_EQ(2, countText(cCode, "pcr_reserveMessage ("));
+    EXPECT_EQ(2, countText(cCode, "pcr_commitMessage ("));
+    EXPECT_EQ(0, countText(cCode, "pcr_allocBlock"));
+
+    //With default configuration, all of them are copied to the queue.
+    cCode = generateCode(semanticRes.result, CodeGeneratorConfig());
+    EXPECT_EQ(0, countText(cCode, "pcr_reserveBlockMessage ("));
+    EXPECT_EQ(3, countText(cCode, "pcr_reserveMessage ("));
+}
+
+/// <summary>
+/// Tests 'estimateTypeSize' function, which selects when messages are posted in
+/// pool blocks.
+/// </summary>
+TEST_F(C_CodegenTests, estimateTypeSize)
+{
+    auto parseRes = testParse(
+        "function f(a:int, b:bool, c:(x:int, y:int)):int {0}\n"
+        "function g(a:int, b:bool) {\n"
+        "  var arr[10]:int\n"
+        "}\n"
+    );
+    ASSERT_TRUE(parseRes.ok());
+
+    auto semanticRes = semanticAnalysis(parseRes.result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    auto functions = astGatherFunctions(semanticRes.result.getPointer());
+    ASSERT_EQ(2, functions.size());
+
+    //'astGatherFunctions' does not keep declaration order.
+    if (functions[0]->getName() != "f")
+        swap(functions[0], functions[1]);
+
+    EXPECT_EQ(16, estimateTypeSize(astGetParameters(functions[0]->getDataType())));
+    EXPECT_EQ(8, estimateTypeSize(astGetParameters(functions[1]->getDataType())));
+    EXPECT_EQ(4, estimateTypeSize(astGetInt()));
+    EXPECT_EQ(1, estimateTypeSize(astGetBool()));
+
+    for (auto type : astGatherTypes(semanticRes.result))
+    {
+        if (type->getType() == AST_ARRAY_DECL)
+            EXPECT_EQ(40, estimateTypeSize(type));
+    }
+}
+
+/// <summary>
+/// Tests 'estimateTypeLayout' function, which estimates struct sizes with and
+/// without field reordering.
+/// </summary>
+TEST_F(C_CodegenTests, estimateTypeLayout)
+{
+    auto parseRes = testParse(
+        "function f(a:bool, b:int, c:bool) {}\n"
+        "actor A {\n"
+        "  var x:bool\n"
+        "  var y:int\n"
+        "  var z:bool\n"
+        "  output o()\n"
+        "}\n"
+    );
+    ASSERT_TRUE(parseRes.ok());
+
+    auto semanticRes = semanticAnalysis(parseRes.result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    auto functions = astGatherFunctions(semanticRes.result.getPointer());
+    auto actors = astGatherActors(semanticRes.result.getPointer());
+    ASSERT_EQ(1, actors.size());
+
+    auto params = astGetParameters(functions[0]->getDataType());
+
+    EXPECT_EQ(12, estimateTypeLayout(params, false).size);
+    EXPECT_EQ(8, estimateTypeLayout(params, true).size);
+    EXPECT_EQ(4, estimateTypeLayout(params, true).align);
+
+    EXPECT_EQ(12, estimateTypeLayout(actors[0], false).size);
+    EXPECT_EQ(8, estimateTypeLayout(actors[0], true).size);
+
+    auto report = generateLayoutReport(semanticRes.result);
+    EXPECT_NE(string::npos, report.find("A\t12\t8\n"));
+}
+
+/// <summary>
+/// Tests stack and static RAM usage estimation.
+/// </summary>
+TEST_F(C_CodegenTests, memoryUsage)
+{
+    auto parseRes = testParse(
+        "function[C] cfn(a:int):int\n"
+        "function leaf(a:int):int {\n"
+        "  var buf[16]:int\n"
+        "  buf[0] = a\n"
+        "  buf[0]\n"
+        "}\n"
+        "function middle(a:int):int {leaf(a)}\n"
+        "actor _Main {\n"
+        "  var total = 0\n"
+        "  input deep(x:int) {total = middle(x)}\n"
+        "  input flat(x:int) {total = x}\n"
+        "  input external(x:int) {total = cfn(x)}\n"
+        "}\n"
+    );
+    ASSERT_TRUE(parseRes.ok());
+
+    auto semanticRes = semanticAnalysis(parseRes.result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    MemoryUsage usage;
+    generateCode(semanticRes.result, CodeGeneratorConfig(), usage);
+
+    map<string, StackUsage> handlers;
+    for (auto& handler : usage.handlers)
+        handlers[handler.name] = handler;
+
+    ASSERT_EQ(4, handlers.size());
+
+    //'leaf' frame holds the array.
+    auto& deep = handlers["_Main.deep"];
+    EXPECT_TRUE(deep.bounded);
+    EXPECT_GE(deep.worst, deep.frame + 64 + 2 * 16);
+
+    auto& flat = handlers["_Main.flat"];
+    EXPECT_TRUE(flat.bounded);
+    EXPECT_EQ(flat.frame, flat.worst);
+    EXPECT_LT(flat.worst, deep.worst);
+
+    auto& external = handlers["_Main.external"];
+    EXPECT_TRUE(external.bounded);
+    EXPECT_TRUE(external.callsC);
+    EXPECT_FALSE(deep.callsC);
+
+    auto actors = astGatherActors(semanticRes.result.getPointer());
+    EXPECT_EQ(estimateTypeLayout(actors[0], true).size, usage.actorsRam);
+    EXPECT_EQ(usage.actorsRam + estimateRuntimeRam(), usage.totalRam());
+
+    auto report = generateMemoryReport(usage);
+    EXPECT_NE(string::npos, report.find("_Main.flat\t"));
+    EXPECT_NE(string::npos, report.find("+C\n"));
+
+    //Frame size estimation.
+    StackFrameInfo  frame;
+
+    EXPECT_EQ(16, estimateFrameSize(frame, true));
+
+    frame.pointers = 2;
+    frame.variables.push_back(astGetInt());
+    frame.variables.push_back(astGetBool());
+    EXPECT_EQ(16 + 8 + 4 + 4, estimateFrameSize(frame, true));
+}
+
+/// <summary>
+/// Tests the generation of profiling hooks ('instrument' option).
+/// </summary>
+TEST_F(C_CodegenTests, instrumentCodegen)
+{
+    auto parseRes = testParse(
+        "function[C] cfn(a:int):int\n"
+        "function clamp(a:int):int {\n"
+        "  if (a > 10) return 10\n"
+        "  a\n"
+        "}\n"
+        "actor _Main {\n"
+        "  var total = 0\n"
+        "  input add(x:int) {total = total + clamp(x)}\n"
+        "}\n"
+    );
+    ASSERT_TRUE(parseRes.ok());
+
+    auto semanticRes = semanticAnalysis(parseRes.result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    CodeGeneratorConfig config;
+    string              cCode = generateCode(semanticRes.result, config);
+
+    EXPECT_EQ(0, countText(cCode, "_gen_profileTable"));
+
+    config.instrument = true;
+    cCode = generateCode(semanticRes.result, config);
+
+    //'C' functions are not profiled.
+    EXPECT_NE(string::npos, cCode.find("{\"clamp\", 0, 0, 0},\n{\"_Main.add\", 0, 0, 0},\n{NULL, 0, 0, 0}"));
+    EXPECT_EQ(2, countText(cCode, "_gen_profileStart = system_cycles();"));
+
+    //Exit hooks: the early return and the end of 'clamp', and the end of 'add'.
+    EXPECT_EQ(2, countText(cCode, "pcr_profileExit (_gen_profileTable, 0,"));
+    EXPECT_EQ(1, countText(cCode, "pcr_profileExit (_gen_profileTable, 1,"));
+}
+
+/// <summary>
+/// Tests 'isStaticActor' function, which decides if the actor graph is emitted as
+/// constant initialized data.
+/// </summary>
+TEST_F(C_CodegenTests, isStaticActor)
+{
+    auto parseRes = testParse(
+        "function f(a:int):int {a}\n"
+        "actor Leaf(var p:int) {\n"
+        "  var x = f(p)\n"
+        "}\n"
+        "actor Fixed {\n"
+        "  const a = Leaf(10)\n"
+        "  const b = Leaf(20)\n"
+        "}\n"
+        "actor Computed {\n"
+        "  const a = Leaf(f(3))\n"
+        "}\n"
+        "actor Nested {\n"
+        "  const c = Computed()\n"
+        "}\n"
+    );
+    ASSERT_TRUE(parseRes.ok());
+
+    auto semanticRes = semanticAnalysis(parseRes.result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    //'astGatherActors' only guarantees dependency order, so they are found by name.
+    map<string, AstNode*> actors;
+    for (auto actor : astGatherActors(semanticRes.result.getPointer()))
+        actors[actor->getName()] = actor;
+    ASSERT_EQ(4, actors.size());
+
+    EXPECT_TRUE(isStaticActor(actors["Leaf"]));
+    EXPECT_TRUE(isStaticActor(actors["Fixed"]));
+    EXPECT_FALSE(isStaticActor(actors["Computed"]));
+    EXPECT_FALSE(isStaticActor(actors["Nested"]));
+}
+
+/// <summary>
+/// Tests 'generateStaticActorGraph' function: the static initializer of the actor
+/// instances, and the end point table, for nested actors.
+/// </summary>
+TEST_F(C_CodegenTests, staticActorGraphCodegen)
+{
+    auto parseRes = testParse(
+        "actor Ticker(var period: int, var on: bool) {\n"
+        "  output tick(v: int)\n"
+        "  var base = 100\n"
+        "  input[conflate] go(x: int) {\n"
+        "    tick(x + period + base)\n"
+        "  }\n"
+        "}\n"
+        "actor Pair {\n"
+        "  const a = Ticker(10, true)\n"
+        "  const b = Ticker(20, false)\n"
+        "  output sum(v: int)\n"
+        "  a.tick -> (u: int) { sum(u) }\n"
+        "  b.tick -> (w: int) { sum(w) }\n"
+        "}\n"
+        "actor _Main {\n"
+        "  const p = Pair()\n"
+        "  var n = 0\n"
+        "  p.sum -> (s: int) { n = n + s }\n"
+        "  input[priority=2] start() { n = 0 }\n"
+        "}\n"
+    );
+    ASSERT_TRUE(parseRes.ok());
+
+    auto semanticRes = semanticAnalysis(parseRes.result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    //Unique suffixes are removed from 'C' names ('go_001D' -> 'go').
+    string cCode = generateCode(semanticRes.result, CodeGeneratorConfig());
+    cCode = regex_replace(cCode, regex("_[0-9A-F]{4}(?![0-9A-Za-z])"), "");
+
+    //End points are numbered in pre-order: '_Main' (1, 2), 'p' (3, 4), 'p.a' (5)
+    //and 'p.b' (6). Outputs are initialized with the end point they are connected to.
+    EXPECT_NE(string::npos, cCode.find(
+        "static _Main _gen_mainActor = {\n"
+        ".p = {\n"
+        ".a = {\n"
+        ".params = {.period = 10, .on = 1},\n"
+        ".tick = 3,\n"
+        ".base = 100,\n"
+        ".go_pending = -1,\n"
+        "._gen_firstEndPoint = 5\n"
+        "},\n"
+        ".b = {\n"
+        ".params = {.period = 20, .on = 0},\n"
+        ".tick = 4,\n"
+        ".base = 100,\n"
+        ".go_pending = -1,\n"
+        "._gen_firstEndPoint = 6\n"
+        "},\n"
+        ".sum = 1,\n"
+        "._gen_firstEndPoint = 3\n"
+        "},\n"
+        ".n = 0,\n"
+        "._gen_firstEndPoint = 1\n"
+        "};\n"
+    ));
+
+    EXPECT_NE(string::npos, cCode.find(
+        "static const PcrEndPoint _gen_endPoints[] = {\n"
+        "{NULL, NULL, 0, NULL},\n"
+        "{(void*)&_gen_mainActor, (void*)_unnamed, 0, NULL},\n"
+        "{(void*)&_gen_mainActor, (void*)start, 2, NULL},\n"
+        "{(void*)&_gen_mainActor.p, (void*)_unnamed, 0, NULL},\n"
+        "{(void*)&_gen_mainActor.p, (void*)_unnamed, 0, NULL},\n"
+        "{(void*)&_gen_mainActor.p.a, (void*)go, 0, &_gen_mainActor.p.a.go_pending},\n"
+        "{(void*)&_gen_mainActor.p.b, (void*)go, 0, &_gen_mainActor.p.b.go_pending},\n"
+        "};\n"
+        "#define PCR_STATIC_ACTOR_GRAPH\n"
+    ));
+
+    //Without static actor graph, actors are built by their constructors at boot.
+    CodeGeneratorConfig config;
+
+    config.staticActorGraph = false;
+    cCode = generateCode(semanticRes.result, config);
+    EXPECT_EQ(string::npos, cCode.find("_gen_endPoints"));
+    EXPECT_EQ(string::npos, cCode.find("#define PCR_STATIC_ACTOR_GRAPH"));
+}
+
+/// <summary>
+/// Tests 'isConstantData' function, and the generation of constant data as
+/// 'static const' objects, instead of actor members.
+/// </summary>
+TEST_F(C_CodegenTests, constantDataCodegen)
+{
+    auto parseRes = testParse(
+        "type Range is (lo:int, hi:int)\n"
+        "actor _Main {\n"
+        "  const limit = 100\n"
+        "  const offsets:Range = (-3, 2)\n"
+        "  const enabled = true\n"
+        "  var total = 0\n"
+        "  const computed = total + 1\n"
+        "  input add(x:int) {\n"
+        "    const local:Range = (1, 2)\n"
+        "    const scalar = 5\n"
+        "    if (enabled) total = total + x + limit + offsets.lo + local.hi + scalar\n"
+        "  }\n"
+        "}\n"
+    );
+    ASSERT_TRUE(parseRes.ok());
+
+    auto semanticRes = semanticAnalysis(parseRes.result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    auto root = semanticRes.result;
+    auto isConstant = [root](const char* name) {
+        return isConstantData(findNode(root, name).getPointer());
+    };
+
+    EXPECT_TRUE(isConstant("limit"));
+    EXPECT_TRUE(isConstant("offsets"));
+    EXPECT_TRUE(isConstant("enabled"));
+    EXPECT_TRUE(isConstant("local"));
+    EXPECT_FALSE(isConstant("total"));
+    EXPECT_FALSE(isConstant("computed"));
+    EXPECT_FALSE(isConstant("scalar"));
+
+    MemoryUsage usage;
+    string      cCode = generateCode(root, CodeGeneratorConfig(), usage);
+
+    EXPECT_NE(string::npos, cCode.find("#ifndef PCR_CONST_DATA\n"));
+    EXPECT_NE(string::npos, cCode.find(" = 100;\n"));
+    EXPECT_NE(string::npos, cCode.find(" = -3, ."));
+    EXPECT_NE(string::npos, cCode.find(" = 1, ."));
+    EXPECT_EQ(string::npos, cCode.find("_gen_actor->limit"));
+
+    //Only 'total', 'computed' and the first end point are stored in the actor.
+    auto actors = astGatherActors(root.getPointer());
+    EXPECT_EQ(4 + 4 + 4, estimateTypeLayout(actors[0], true).size);
+    EXPECT_EQ(4 + 8 + 1 + 8, usage.constData);
+}
+
 /// <summary>
 /// Test code generation for literal expressions.
 /// Also tests 'varAccessCodegen'
@@ -470,6 +920,239 @@ TEST_F(C_CodegenTests, postfixOpCodegen)
     );
 }
 
+/// <summary>
+/// Test code generation for sized integer types.
+/// </summary>
+TEST_F(C_CodegenTests, sizedIntCodegen)
+{
+    EXPECT_RUN_OK("sizedInt1",
+        "function test ():int {\n"
+        "  var a:uint8 = 250\n"
+        "  var b:int8 = -100\n"
+        "  var c:int16\n"
+        "  var arr[4]:uint16\n"
+        "  a = a + 10\n"
+        "  if (a != 4) return 1010\n"
+        "  c = b\n"
+        "  c = c * 300\n"
+        "  if (c != (-30000)) return 1020\n"
+        "  arr[1] = 65535\n"
+        "  ++arr[1]\n"
+        "  if (arr[1] != 0) return 1030\n"
+        "  0\n"
+        "}\n"
+    );
+}
+
+/// <summary>
+/// Test code generation for 'for' and 'for each' loops.
+/// </summary>
+TEST_F(C_CodegenTests, forCodegen)
+{
+    EXPECT_RUN_OK("for1",
+        "function test ():int {\n"
+        "  var a[64]:int\n"
+        "  var b[64]:int\n"
+        "  var s:int = 0\n"
+        "  for (var i = 0; i < 64; ++i)\n"
+        "    a[i] = i\n"
+        "  for (var i = 0; i < 64; i++) {\n"
+        "    b[i] = (a[i] * 2) + 1\n"
+        "  }\n"
+        "  for (x in b) s = s + x\n"
+        "  if (s != 4096) return 1010\n"
+        "  var n:int = 0\n"
+        "  for (var j = 10; (j > 0) && (s > 0); --j) n = n + j\n"
+        "  if (n != 55) return 1020\n"
+        "  0\n"
+        "}\n"
+    );
+}
+
+/// <summary>
+/// Test code generation for element-wise array operations.
+/// </summary>
+TEST_F(C_CodegenTests, elementWiseCodegen)
+{
+    EXPECT_RUN_OK("elementWise1",
+        "function test ():int {\n"
+        "  var arr[7]:int\n"
+        "  var arr'[7]:int\n"
+        "  var b[7]:int\n"
+        "  for (var i = 0; i < 7; ++i) arr[i] = i\n"
+        "  arr' = arr * 2\n"
+        "  if (arr'[6] != 12) return 1010\n"
+        "  b = arr + arr'\n"
+        "  if (b[5] != 15) return 1020\n"
+        "  b = (b - arr) << 1\n"
+        "  if (b[4] != 16) return 1030\n"
+        "  var c = 100 - b\n"
+        "  if (c[4] != 84) return 1040\n"
+        "  var s[4]:uint8\n"
+        "  var t[4]:uint16\n"
+        "  s[0] = 200\n"
+        "  s = (s + 100) >> 1\n"
+        "  if (s[0] != 22) return 1050\n"
+        "  t = s\n"
+        "  if (t[0] != 22) return 1060\n"
+        "  0\n"
+        "}\n"
+    );
+
+    //Element-wise results which are not assigned to a variable need array temporaries.
+    EXPECT_RUN_OK("elementWise2",
+        "function test ():int {\n"
+        "  var a[5]:int\n"
+        "  var b[5]:int\n"
+        "  for (var i = 0; i < 5; ++i) {\n"
+        "    a[i] = i\n"
+        "    b[i] = i * 10\n"
+        "  }\n"
+        "  const x = (a + b)[2]\n"
+        "  if (x != 22) return 1010\n"
+        "  if ((b - (a * 2))[4] != 32) return 1020\n"
+        "  var s = 0\n"
+        "  for (v in a + b) s = s + v\n"
+        "  if (s != 110) return 1030\n"
+        "  for (v in (a + b) * 2) s = s + v\n"
+        "  if (s != 330) return 1040\n"
+        "  0\n"
+        "}\n"
+    );
+}
+
+/// <summary>
+/// Test code generation for array index checks.
+/// </summary>
+TEST_F(C_CodegenTests, indexCheckCodegen)
+{
+    const char* code =
+        "function test ():int {\n"
+        "  var a[8]:int\n"
+        "  var j = 3\n"
+        "  for (var i = 0; i < 8; ++i) a[i] = i\n"
+        "  a[j] = a[j + 4]\n"
+        "  if (a[3] != 7) return 1010\n"
+        "  0\n"
+        "}\n";
+
+    EXPECT_RUN_OK("indexCheck1", code);
+
+    //Only the accesses with 'j' are checked.
+    auto semanticRes = semanticAnalysis(testParse(code).result);
+    ASSERT_TRUE(semanticRes.ok());
+
+    string  cCode = generateCode(semanticRes.result);
+
+    EXPECT_EQ(2, countText(cCode, "pcr_indexOutOfRange"));
+
+    EXPECT_EQ(99, runTest("indexCheck2",
+        "function test ():int {\n"
+        "  var a[4]:int\n"
+        "  var i = 4\n"
+        "  a[i] = 1\n"
+        "  0\n"
+        "}\n"
+    ));
+}
+
+/// <summary>
+/// Test code generation of constant tuples in functions.
+/// </summary>
+TEST_F(C_CodegenTests, constantDataRun)
+{
+    //Compiled with warnings as errors: references to constant data shall keep the
+    //'const' qualifier (C4090 otherwise).
+    EXPECT_EQ(0, runTest("constData1",
+        "type Weights is (a:int, b:int, c:int)\n"
+        "type Range is (lo:int, hi:int)\n"
+        "function sum(x:int):int {\n"
+        "  const weights:Weights = (3, 2, 1)\n"
+        "  const limits:Range = (-10, 10)\n"
+        "  var total = (weights.a * x) + (weights.b * x) + (weights.c * x)\n"
+        "  total = total * 8\n"
+        "  if (total < limits.lo) limits.lo else total\n"
+        "}\n"
+        "type Box is (min:Range, max:Range)\n"
+        "function width(scale:int):int {\n"
+        "  const box:Box = ((0, 1), (-5, 5))\n"
+        "  (box.max.hi - box.max.lo) * scale\n"
+        "}\n"
+        "function test ():int {\n"
+        "  if (sum(2) != 96) return 1010\n"
+        "  if ((sum(-1) + 10) != 0) return 1020\n"
+        "  if (width(2) != 20) return 1030\n"
+        "  0\n"
+        "}\n",
+        "/WX"
+    ));
+}
+
+/// <summary>
+/// Test code generation of 'select' expressions.
+/// </summary>
+TEST_F(C_CodegenTests, selectCodegen)
+{
+    EXPECT_RUN_OK("select1",
+        "function classify(a:int):int {\n"
+        "  select (a) {\n"
+        "    -1: {const b = a * 3; b}\n"
+        "    0: 10\n"
+        "    1, 2: 20\n"
+        "    else: 40\n"
+        "  }\n"
+        "}\n"
+        "function test ():int {\n"
+        "  var count = 0\n"
+        "  if (classify(0) != 10) return 1010\n"
+        "  if (classify(2) != 20) return 1020\n"
+        "  if ((classify(-1) + 3) != 0) return 1030\n"
+        "  if (classify(7) != 40) return 1040\n"
+        "  select (count) {1: count = 5; 0: count = 7}\n"
+        "  if (count != 7) return 1050\n"
+        "  0\n"
+        "}\n"
+    );
+
+    EXPECT_RUN_OK("select2",
+        "const IDLE = 0\n"
+        "const BUSY = 0x10\n"
+        "function state(a:int):int {\n"
+        "  select (a) {IDLE: 1; BUSY: 2; else: 3}\n"
+        "}\n"
+        "function test ():int {\n"
+        "  if (state(0) != 1) return 1010\n"
+        "  if (state(16) != 2) return 1020\n"
+        "  if (state(1) != 3) return 1030\n"
+        "  0\n"
+        "}\n"
+    );
+}
+
+/// <summary>
+/// Test code generation of generic function instances.
+/// </summary>
+TEST_F(C_CodegenTests, genericCodegen)
+{
+    EXPECT_RUN_OK("generic1",
+        "function maxOf[T](a:T, b:T):T {\n"
+        "  if (a > b) a else b\n"
+        "}\n"
+        "function times[T, N:int](a:T):T {\n"
+        "  var total:T = 0\n"
+        "  for (var i = 0; i < N; ++i) total = total + a\n"
+        "  total\n"
+        "}\n"
+        "function test ():int {\n"
+        "  if (maxOf[int](3, 7) != 7) return 1010\n"
+        "  if (maxOf[uint8](200, 100) != 200) return 1020\n"
+        "  if (times[int, 3](5) != 15) return 1030\n"
+        "  if (times[uint8, 3](100) != 44) return 1040\n"
+        "  0\n"
+        "}\n"
+    );
+}
+
 /// <summary>
 /// Test actor code generation
 /// </summary>
@@ -0,0 +1,275 @@
+/// <summary>
+/// Tests for the generics instantiation compiler pass.
+/// </summary>
+
+#include "libfilsc_test_pch.h"
+#include "genericsPass.h"
+#include "moduleAssembler.h"
+
+using namespace std;
+
+/// <summary>
+/// Finds a function or actor definition by name.
+/// </summary>
+static Ref<AstNode> findDefinition(Ref<AstNode> root, const string& name)
+{
+    return findNode(root, [&name](auto node) {
+        return node->getName() == name && (node->getType() == AST_FUNCTION || node->getType() == AST_ACTOR);
+    });
+}
+
+/// <summary>
+/// Tests generic functions instantiation.
+/// </summary>
+TEST(GenericsPass, genericFunctions)
+{
+    auto r = semAnalysisCheck(
+        "function maxOf[T](a:T, b:T):T {\n"
+        "  if (a > b) a else b\n"
+        "}\n"
+        "function scale[N:int](a:int):int {\n"
+        "  a * N\n"
+        "}\n"
+        "function test(x:int, y:uint8):int {\n"
+        "  const a = maxOf[int](x, 3)\n"
+        "  const b = maxOf[uint8](y, 4)\n"
+        "  maxOf[int](a, scale[2](b))\n"
+        "}\n"
+    );
+    ASSERT_SEM_OK(r);
+
+    auto script = r.result;
+    vector<string> names;
+
+    for (auto item : script->children())
+        names.push_back(item->getName());
+
+    //Instances are placed before the function which uses them.
+    auto testPos = find(names.begin(), names.end(), "test");
+
+    ASSERT_NE(names.end(), testPos);
+    EXPECT_EQ(1, count(names.begin(), testPos, "maxOf[int]"));
+    EXPECT_EQ(1, count(names.begin(), testPos, "maxOf[uint8]"));
+    EXPECT_EQ(1, count(names.begin(), testPos, "scale[2]"));
+
+    auto instance = findDefinition(script, "maxOf[uint8]");
+    ASSERT_TRUE(instance.notNull());
+    EXPECT_EQ(AST_FUNCTION, instance->getType());
+    EXPECT_DATATYPE_STR("uint8", astGetReturnType(instance.getPointer()));
+
+    //No compile time calls shall remain in 'test' function.
+    auto calls = findNodes(findDefinition(script, "test"), [](auto node) {
+        return node->getType() == AST_CTCALL;
+    });
+    EXPECT_EQ(0, calls.size());
+}
+
+/// <summary>
+/// Tests generic actors instantiation.
+/// </summary>
+TEST(GenericsPass, genericActors)
+{
+    auto r = semAnalysisCheck(
+        "actor Fifo[T, N:int] {\n"
+        "  var items[N]:T\n"
+        "  var count = 0\n"
+        "  output o1(value:T)\n"
+        "  input push(v:T) {\n"
+        "    if (count < N) {items[count] = v; count = count + 1}\n"
+        "    o1(items[0])\n"
+        "  }\n"
+        "}\n"
+        "actor Pair[A, B] {\n"
+        "  const first = A()\n"
+        "  const second = B()\n"
+        "}\n"
+        "actor _Main {\n"
+        "  const small = Fifo[uint8, 4]()\n"
+        "  const pair = Pair[Fifo[int, 8], Fifo[uint8, 4]]()\n"
+        "}\n"
+    );
+    ASSERT_SEM_OK(r);
+
+    auto script = r.result;
+
+    auto fifo = findDefinition(script, "Fifo[int,8]");
+    ASSERT_TRUE(fifo.notNull());
+    EXPECT_EQ(AST_ACTOR, fifo->getType());
+
+    auto buffer = findNode(fifo, "items");
+    ASSERT_TRUE(buffer.notNull());
+    EXPECT_TRUE(astIsArrayType(buffer->getDataType()));
+    EXPECT_EQ(8, astGetArraySize(buffer->getDataType()));
+    EXPECT_DATATYPE_STR("int", astGetArrayItemType(buffer->getDataType()));
+
+    auto& items = script->children();
+    EXPECT_EQ(1, count_if(items.begin(), items.end(), [](auto node) {
+        return node->getName() == "Fifo[uint8,4]";
+    }));
+
+    auto pair = findDefinition(script, "Pair[Fifo[int,8],Fifo[uint8,4]]");
+    ASSERT_TRUE(pair.notNull());
+    EXPECT_EQ(fifo.getPointer(), findNode(pair, "first")->getDataType());
+}
+
+/// <summary>
+/// Checks that constant parameters are compared by value, not by spelling.
+/// </summary>
+TEST(GenericsPass, constantParamsValue)
+{
+    auto r = semAnalysisCheck(
+        "function scale[N:int](a:int):int {\n"
+        "  a * N\n"
+        "}\n"
+        "function test(x:int):int {\n"
+        "  scale[16](x) + scale[0x10](x)\n"
+        "}\n"
+    );
+    ASSERT_SEM_OK(r);
+
+    auto& items = r.result->children();
+    EXPECT_EQ(1, count_if(items.begin(), items.end(), [](auto node) {
+        return node->getName().find("scale[") == 0;
+    }));
+    EXPECT_TRUE(findDefinition(r.result, "scale[16]").notNull());
+}
+
+/// <summary>
+/// Tests 'getGenericInstance' error detection.
+/// </summary>
+TEST(GenericsPass, genericInstanceErrors)
+{
+    const char* definition =
+        "function fill[T, N:int, B:bool](a:T):T {\n"
+        "  a\n"
+        "}\n";
+
+    auto check = [definition](const char* call) {
+        string code = string(definition) + "function test():int {" + call + "}\n";
+        return semAnalysisCheck(code.c_str());
+    };
+
+    EXPECT_SEM_OK(check("fill[int, 4, true](3)"));
+
+    auto r = check("fill[int, 4](3)");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_WRONG_GENERIC_PARAMS_COUNT_3, r.errors[0].type());
+
+    r = check("fill[7, 4, true](3)");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_GENERIC_TYPE_PARAMETER_1, r.errors[0].type());
+
+    r = check("fill[int, int, true](3)");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_GENERIC_CONST_PARAMETER_2, r.errors[0].type());
+
+    r = check("fill[int, 4, 1](3)");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_GENERIC_CONST_PARAMETER_2, r.errors[0].type());
+
+    //Does not fit in 64 bits.
+    r = check("fill[int, 99999999999999999999, true](3)");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_GENERIC_CONST_PARAMETER_2, r.errors[0].type());
+}
+
+/// <summary>
+/// Checks that instances are shared between modules.
+/// </summary>
+TEST(GenericsPass, sharedInstances)
+{
+    auto parseModule = [](const char* name, const char* code, const AstStr2NodesMap& modules) {
+        auto script = parseScript(code, SourceFilePtr()).result;
+        auto module = assembleModule(name, { script }).result;
+
+        return assignImportedModules(module, modules).result;
+    };
+
+    AstStr2NodesMap	modules;
+
+    modules["A"] = parseModule("A",
+        "function maxOf[T](a:T, b:T):T {\n"
+        "  if (a > b) a else b\n"
+        "}\n",
+        modules);
+
+    modules["B"] = parseModule("B",
+        "import \"A\"\n"
+        "function maxB(a:int, b:int):int {\n"
+        "  maxOf[int](a, b)\n"
+        "}\n",
+        modules);
+
+    auto moduleC = parseModule("C",
+        "import \"A\"\n"
+        "import \"B\"\n"
+        "function test():int {\n"
+        "  maxOf[int](maxB(1, 2), 3)\n"
+        "}\n",
+        modules);
+
+    auto r = semanticAnalysis(moduleC);
+    ASSERT_SEM_OK(r);
+
+    //The instance belongs to module 'B', and 'C' shall reference it.
+    auto instance = findDefinition(modules["B"], "maxOf[int]");
+    ASSERT_TRUE(instance.notNull());
+    EXPECT_TRUE(findDefinition(moduleC, "maxOf[int]").isNull());
+
+    auto reference = findNode(findDefinition(moduleC, "test"), [](auto node) {
+        return node->getType() == AST_IDENTIFIER && node->getName() == "maxOf[int]";
+    });
+    ASSERT_TRUE(reference.notNull());
+    EXPECT_EQ(instance.getPointer(), reference->getReference());
+}
+
+/// <summary>
+/// Checks that modules which pass different types with the same name to a generic
+/// do not share the instance.
+/// </summary>
+TEST(GenericsPass, sameNameTypesInstances)
+{
+    auto parseModule = [](const char* name, const char* code, const AstStr2NodesMap& modules) {
+        auto script = parseScript(code, SourceFilePtr()).result;
+        auto module = assembleModule(name, { script }).result;
+
+        return assignImportedModules(module, modules).result;
+    };
+
+    AstStr2NodesMap	modules;
+
+    modules["A"] = parseModule("A",
+        "function first[T](a:T, b:T):T {\n"
+        "  a\n"
+        "}\n",
+        modules);
+
+    modules["B"] = parseModule("B",
+        "import \"A\"\n"
+        "type Point is (x:int, y:int)\n"
+        "function firstB(p:Point):int {\n"
+        "  first[Point](p, p).x\n"
+        "}\n",
+        modules);
+
+    modules["D"] = parseModule("D",
+        "import \"A\"\n"
+        "type Point is (z:bool, w:int)\n"
+        "function firstD(p:Point):int {\n"
+        "  first[Point](p, p).w\n"
+        "}\n",
+        modules);
+
+    auto r = semanticAnalysis(modules["B"]);
+    ASSERT_SEM_OK(r);
+    r = semanticAnalysis(modules["D"]);
+    ASSERT_SEM_OK(r);
+
+    auto instanceB = findDefinition(modules["B"], "first[Point]");
+    auto instanceD = findDefinition(modules["D"], "first[Point]#2");
+
+    ASSERT_TRUE(instanceB.notNull());
+    ASSERT_TRUE(instanceD.notNull());
+    EXPECT_EQ(findNode(modules["B"], "Point")->getDataType(), astGetReturnType(instanceB.getPointer()));
+    EXPECT_EQ(findNode(modules["D"], "Point")->getDataType(), astGetReturnType(instanceD.getPointer()));
+}
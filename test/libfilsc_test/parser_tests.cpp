@@ -365,6 +365,93 @@ TEST(Parser, parseIf)
     EXPECT_EQ(AST_PREFIXOP, ifNode->children()[2]->getType());
 }
 
+/// <summary>
+/// Tests 'parseSelect' function
+/// </summary>
+TEST(Parser, parseSelect)
+{
+    auto parseSelect_ = [](const char* code)
+    {
+        return checkAllParsed(code, parseSelect);
+    };
+
+    EXPECT_PARSE_OK(parseSelect_("select (a) {}"));
+    EXPECT_PARSE_OK(parseSelect_("select (a) {1: b}"));
+    EXPECT_PARSE_OK(parseSelect_("select (a) {1: b; 2, 3: c; else: d}"));
+    EXPECT_PARSE_OK(parseSelect_("select (a) {\n-2: {c; d}\n1: b\nelse: e\n}"));
+
+    EXPECT_PARSE_ERROR(parseSelect_("select a {1: b}"));
+    EXPECT_PARSE_ERROR(parseSelect_("select (a) {1 b}"));
+    EXPECT_PARSE_ERROR(parseSelect_("select (a) {1: b 2: c}"));
+    EXPECT_PARSE_ERROR(parseSelect_("select (a) {1,: b}"));
+    EXPECT_PARSE_ERROR(parseSelect_("select (a) {else: b; else: c}"));
+    EXPECT_PARSE_ERROR(parseSelect_("select (a) {1: b"));
+
+    auto result = parseSelect_("select (a+1) {1, 2: a; else: 0}");
+    ASSERT_PARSE_OK(result);
+
+    auto selectNode = result.result;
+
+    EXPECT_EQ(AST_SELECT, selectNode->getType());
+    ASSERT_EQ(3, selectNode->childCount());
+    EXPECT_EQ(AST_BINARYOP, selectNode->child(0)->getType());
+
+    auto firstCase = selectNode->child(1);
+    EXPECT_EQ(AST_CASE, firstCase->getType());
+    ASSERT_TRUE(firstCase->childExists(0));
+    EXPECT_EQ(2, firstCase->child(0)->childCount());
+    EXPECT_EQ(AST_IDENTIFIER, firstCase->child(1)->getType());
+
+    auto defaultCase = selectNode->child(2);
+    EXPECT_FALSE(defaultCase->childExists(0));
+    EXPECT_EQ(AST_INTEGER, defaultCase->child(1)->getType());
+}
+
+/// <summary>
+/// Tests 'parseFor' and 'parseForEach' functions
+/// </summary>
+TEST(Parser, parseFor)
+{
+    auto parseFor_ = [](const char* code)
+    {
+        return checkAllParsed(code, parseFor);
+    };
+
+    EXPECT_PARSE_OK(parseFor_("for (var i = 0; i < 10; ++i) a[i] = i"));
+    EXPECT_PARSE_OK(parseFor_("for (i = 0; i < 10; i++) {a[i] = i; b[i] = 0}"));
+    EXPECT_PARSE_OK(parseFor_("for (;;) x"));
+    EXPECT_PARSE_OK(parseFor_("for (x in a) s = s + x"));
+
+    EXPECT_PARSE_ERROR(parseFor_("for (i = 0; i < 10) x"));
+    EXPECT_PARSE_ERROR(parseFor_("for i = 0; i < 10; ++i) x"));
+    EXPECT_PARSE_ERROR(parseFor_("for (x in) x"));
+    EXPECT_PARSE_ERROR(parseFor_("for (x in a x"));
+
+    auto result = parseFor_("for (var i = 0; i < 10; ++i) i");
+    ASSERT_PARSE_OK(result);
+
+    auto forNode = result.result;
+
+    EXPECT_EQ(AST_FOR, forNode->getType());
+    ASSERT_EQ(4, forNode->children().size());
+    EXPECT_EQ(AST_DECLARATION, forNode->child(0)->getType());
+    EXPECT_EQ(AST_BINARYOP, forNode->child(1)->getType());
+    EXPECT_EQ(AST_PREFIXOP, forNode->child(2)->getType());
+    EXPECT_EQ(AST_IDENTIFIER, forNode->child(3)->getType());
+
+    result = parseFor_("for (x in a) x");
+    ASSERT_PARSE_OK(result);
+
+    auto eachNode = result.result;
+
+    EXPECT_EQ(AST_FOR_EACH, eachNode->getType());
+    ASSERT_EQ(3, eachNode->children().size());
+    EXPECT_EQ(AST_IDENTIFIER, eachNode->child(0)->getType());
+    EXPECT_EQ(AST_DECLARATION, eachNode->child(1)->getType());
+    EXPECT_TRUE(eachNode->child(1)->hasFlag(ASTF_CONST));
+    EXPECT_EQ(AST_IDENTIFIER, eachNode->child(2)->getType());
+}
+
 
 /// <summary>
 /// Tests 'parseExpression' function
@@ -697,6 +784,49 @@ TEST(Parser, parseFunctionDef)
     EXPECT_EQ(2, children[0]->children().size());
 }
 
+/// <summary>
+/// Tests for 'parseGenericParams' function, and its use in function and actor definitions.
+/// </summary>
+TEST(Parser, parseGenericParams)
+{
+    EXPECT_PARSE_OK(checkAllParsed("[T]", parseGenericParams));
+    EXPECT_PARSE_OK(checkAllParsed("[T, N:int, B:bool]", parseGenericParams));
+    EXPECT_PARSE_ERROR(checkAllParsed("[]", parseGenericParams));
+    EXPECT_PARSE_ERROR(checkAllParsed("[3]", parseGenericParams));
+    EXPECT_PARSE_ERROR(checkAllParsed("[N:int = 3]", parseGenericParams));
+
+    EXPECT_PARSE_ERROR(checkAllParsed("function[C] maxOf[T] (a:T, b:T):T", parseFunctionDef));
+    EXPECT_PARSE_ERROR(checkAllParsed("function [T] (a:T, b:T):T {a}", parseFunctionDef));
+
+    auto r = checkAllParsed("function maxOf[T] (a:T, b:T):T {if (a > b) a else b}", parseFunctionDef);
+    ASSERT_PARSE_OK(r);
+    EXPECT_EQ(AST_GENERIC, r.result->getType());
+    EXPECT_EQ("maxOf", r.result->getName());
+    ASSERT_EQ(4, r.result->childCount());
+    EXPECT_EQ(1, r.result->child(0)->childCount());
+    EXPECT_EQ(AST_FUNCTION, r.result->child(1)->getType());
+    EXPECT_EQ("maxOf", r.result->child(1)->getName());
+
+    r = checkAllParsed(
+        "actor Fifo[T, N:int] (limit:int) {\n"
+        "  var items[N]:T\n"
+        "  input push(v:T) {items[0] = v}\n"
+        "}",
+        parseActorDef);
+    ASSERT_PARSE_OK(r);
+    EXPECT_EQ(AST_GENERIC, r.result->getType());
+    EXPECT_EQ("Fifo", r.result->getName());
+
+    auto params = r.result->child(0);
+    ASSERT_EQ(2, params->childCount());
+    EXPECT_FALSE(params->child(0)->childExists(0));
+    EXPECT_EQ(AST_TYPE_NAME, params->child(1)->child(0)->getType());
+
+    auto actor = r.result->child(1);
+    EXPECT_EQ(AST_ACTOR, actor->getType());
+    EXPECT_EQ(1, actor->child(0)->childCount());
+}
+
 /// <summary>
 /// Tests for 'parseFunctionType' function
 /// </summary>
@@ -966,6 +1096,61 @@ TEST(Parser, parseActorDef)
     EXPECT_EQ(AST_INPUT, r.result->child(2)->getType());
 }
 
+/// <summary>
+/// Tests for 'parseInputAttributes' function, and its use in input message declarations.
+/// </summary>
+TEST(Parser, parseInputAttributes)
+{
+    auto parseInputAttributes_ = [](const char* code)
+    {
+        return checkAllParsed(code, parseInputAttributes);
+    };
+    auto parseInputMsg_ = [](const char* code)
+    {
+        return checkAllParsed(code, parseInputMsg);
+    };
+
+    EXPECT_PARSE_OK(parseInputAttributes_("[priority=2]"));
+    EXPECT_PARSE_OK(parseInputAttributes_("[priority = 0]"));
+    EXPECT_PARSE_OK(parseInputAttributes_("[conflate]"));
+    EXPECT_PARSE_OK(parseInputAttributes_("[priority=1, conflate]"));
+    EXPECT_PARSE_OK(parseInputAttributes_("[conflate, priority=3]"));
+
+    EXPECT_PARSE_ERROR(parseInputAttributes_("[priority=-1]"));
+    EXPECT_PARSE_ERROR(parseInputAttributes_("[priority=4]"));
+    EXPECT_PARSE_ERROR(parseInputAttributes_("[priority=high]"));
+    EXPECT_PARSE_ERROR(parseInputAttributes_("[prio=1]"));
+    EXPECT_PARSE_ERROR(parseInputAttributes_("[C]"));
+    EXPECT_PARSE_ERROR(parseInputAttributes_("[]"));
+    EXPECT_PARSE_ERROR(parseInputAttributes_("[conflate,]"));
+    EXPECT_PARSE_ERROR(parseInputAttributes_("[conflate priority=1]"));
+
+    //Values which do not fit in an integer are also reported as invalid priorities.
+    auto r = parseInputAttributes_("[priority=99999999999]");
+    ASSERT_PARSE_ERROR(r);
+    EXPECT_EQ(ETYPE_INVALID_INPUT_PRIORITY_2, r.errorDesc.type());
+
+    r = parseInputMsg_("input[priority=3] alarm(code: int){}");
+    ASSERT_PARSE_OK(r);
+    EXPECT_EQ(AST_INPUT, r.result->getType());
+    EXPECT_STREQ("alarm", r.result->getName().c_str());
+    EXPECT_EQ(3, astGetInputPriority(r.result.getPointer()));
+    EXPECT_FALSE(r.result->hasFlag(ASTF_CONFLATE));
+
+    r = parseInputMsg_("input[conflate] temperature(value: int){}");
+    ASSERT_PARSE_OK(r);
+    EXPECT_EQ(0, astGetInputPriority(r.result.getPointer()));
+    EXPECT_TRUE(r.result->hasFlag(ASTF_CONFLATE));
+
+    r = parseInputMsg_("input normal(){}");
+    ASSERT_PARSE_OK(r);
+    EXPECT_EQ(0, astGetInputPriority(r.result.getPointer()));
+    EXPECT_FALSE(r.result->hasFlag(ASTF_CONFLATE));
+
+    EXPECT_PARSE_ERROR(parseInputMsg_("input[priority=9] alarm(){}"));
+    EXPECT_PARSE_ERROR(parseInputMsg_("input[C] alarm(){}"));
+}
+
 /// <summary>
 /// Tests for 'parseMsgHeader' function.
 /// </summary>
@@ -0,0 +1,86 @@
+/// <summary>
+/// Tests for array index range analysis.
+/// </summary>
+
+#include "libfilsc_test_pch.h"
+#include "rangeAnalysis.h"
+
+using namespace std;
+
+/// <summary>
+/// Tests 'findSafeArrayAccesses' function.
+/// Accesses to arrays whose name starts by 's' shall be found safe, and the
+/// accesses to arrays whose name starts by 'u' shall not.
+/// </summary>
+TEST(RangeAnalysis, findSafeArrayAccesses)
+{
+    auto r = semAnalysisCheck(
+        "function test(k:int, b:uint8):int {\n"
+        "  var s1[8]:int\n"
+        "  var s2[256]:int\n"
+        "  var s3[16]:int\n"
+        "  var u1[8]:int\n"
+        "  var u2[255]:int\n"
+        "  s1[0] = 1; s1[7] = 2\n"
+        "  s2[b] = 3; u2[b] = 4\n"
+        "  u1[k] = 5\n"
+        "  s3[k & 15] = 6; u1[k & 15] = 7\n"
+        "  for (var i = 0; i < 8; ++i) {s1[i] = i; u1[i + 1] = i; s3[i + 8] = i}\n"
+        "  for (var i = 7; i >= 0; --i) s1[i] = i\n"
+        "  for (var i = 0; i <= 8; ++i) u1[i] = i\n"
+        "  for (var i = 0; i < 8; ++i) {u1[i] = i; i = i + 1}\n"
+        "  for (var i:int8 = 0; i < 8; i++) s1[i] = i\n"
+        "  u1[k]\n"
+        "}\n"
+    );
+    ASSERT_SEM_OK(r);
+
+    auto safe = findSafeArrayAccesses(r.result);
+    auto accesses = findNodes(r.result, [](auto node) {
+        return node->getType() == AST_CTCALL;
+    });
+
+    ASSERT_EQ(15, accesses.size());
+
+    for (auto access : accesses)
+    {
+        const string name = access->child(0)->getName();
+
+        EXPECT_EQ(name[0] == 's', safe.count(access.getPointer()) > 0) << "Array: " << name;
+    }
+}
+
+/// <summary>
+/// Tests 'getInductionRange' function.
+/// </summary>
+TEST(RangeAnalysis, getInductionRange)
+{
+    auto r = semAnalysisCheck(
+        "function test(n:int) {\n"
+        "  for (var i = 2; i < 10; ++i) n\n"
+        "  for (var i = 9; i >= 0; i--) n\n"
+        "  for (var i:uint8 = 0; i <= 255; ++i) n\n"
+        "  for (var i = 0; i < n; ++i) n\n"
+        "}\n"
+    );
+    ASSERT_SEM_OK(r);
+
+    auto loops = findNodes(r.result, [](auto node) {
+        return node->getType() == AST_FOR;
+    });
+    ASSERT_EQ(4, loops.size());
+
+    IntRange range;
+
+    ASSERT_TRUE(getInductionRange(loops[0].getPointer(), range));
+    EXPECT_EQ(2, range.min);
+    EXPECT_EQ(9, range.max);
+
+    ASSERT_TRUE(getInductionRange(loops[1].getPointer(), range));
+    EXPECT_EQ(0, range.min);
+    EXPECT_EQ(9, range.max);
+
+    //Never ends: 'uint8' is always <= 255.
+    EXPECT_FALSE(getInductionRange(loops[2].getPointer(), range));
+    EXPECT_FALSE(getInductionRange(loops[3].getPointer(), range));
+}
@@ -0,0 +1,149 @@
+/// <summary>
+/// Tests for runtime trace converter.
+/// </summary>
+
+#include "libfilsc_test_pch.h"
+#include "traceConverter.h"
+#include "json11.hpp"
+
+using namespace std;
+using json11::Json;
+
+/// <summary>
+/// Builds binary trace files, in the format written by 'pcr_writeTrace'.
+/// </summary>
+class TraceBuilder
+{
+public:
+    void addSymbol(const void* address, const string& name)
+    {
+        const unsigned short length = (unsigned short)name.size();
+
+        write(&address, sizeof(address), m_symbols);
+        write(&length, sizeof(length), m_symbols);
+        m_symbols += name;
+        ++m_symbolCount;
+    }
+
+    void addEvent(unsigned long long time, unsigned char type, const void* actor, const void* input)
+    {
+        const unsigned char priority = 1;
+        const short         reserved = 0;
+        const unsigned      padding = 0;
+
+        write(&time, sizeof(time), m_events);
+        write(&type, sizeof(type), m_events);
+        write(&priority, sizeof(priority), m_events);
+        write(&reserved, sizeof(reserved), m_events);
+        write(&padding, sizeof(padding), m_events);
+        write(&actor, sizeof(actor), m_events);
+        write(&input, sizeof(input), m_events);
+        ++m_eventCount;
+    }
+
+    void setClock(unsigned long long ticks, unsigned long long us)
+    {
+        m_clockTicks = ticks;
+        m_clockUs = us;
+    }
+
+    string build()const
+    {
+        const unsigned  version = 2;
+        const unsigned  ptrSize = sizeof(void*);
+        string          result = "PCRTRACE";
+
+        write(&version, sizeof(version), result);
+        write(&ptrSize, sizeof(ptrSize), result);
+        write(&m_symbolCount, sizeof(m_symbolCount), result);
+        write(&m_eventCount, sizeof(m_eventCount), result);
+        write(&m_clockTicks, sizeof(m_clockTicks), result);
+        write(&m_clockUs, sizeof(m_clockUs), result);
+
+        return result + m_symbols + m_events;
+    }
+
+private:
+    static void write(const void* data, size_t size, string& dest)
+    {
+        dest.append((const char*)data, size);
+    }
+
+    string              m_symbols;
+    string              m_events;
+    unsigned            m_symbolCount = 0;
+    unsigned            m_eventCount = 0;
+    unsigned long long  m_clockTicks = 0;
+    unsigned long long  m_clockUs = 0;
+};
+
+/// <summary>
+/// Tests 'traceToJson' function.
+/// </summary>
+TEST(TraceConverter, traceToJson)
+{
+    int             actor1, actor2;
+    const void*     input1 = (void*)0x1000;
+    const void*     input2 = (void*)0x2000;
+    TraceBuilder    builder;
+
+    builder.setClock(2000, 1000);                                 //2 ticks per microsecond.
+    builder.addSymbol(input1, "Main.alarm");
+    builder.addEvent(10, 3, &actor1, input1);                     //Unmatched end: skipped.
+    builder.addEvent(20, 1, &actor1, input1);
+    builder.addEvent(30, 2, &actor1, input1);
+    builder.addEvent(40, 3, &actor1, input1);
+    builder.addEvent(50, 4, &actor2, input2);
+    builder.addEvent(0x100000010ull, 5, &actor2, input2);         //Beyond 32 bits.
+
+    string  error;
+    Json    doc = Json::parse(traceToJson(builder.build()), error);
+
+    ASSERT_TRUE(error.empty()) << error;
+
+    auto events = doc["traceEvents"].array_items();
+
+    //2 thread names + 5 events.
+    ASSERT_EQ(7, events.size());
+
+    EXPECT_EQ("M", events[0]["ph"].string_value());
+    EXPECT_EQ("Main @", events[0]["args"]["name"].string_value().substr(0, 6));
+    EXPECT_EQ("post Main.alarm", events[1]["name"].string_value());
+    EXPECT_EQ(10.0, events[1]["ts"].number_value());
+    EXPECT_EQ("B", events[2]["ph"].string_value());
+    EXPECT_EQ("Main.alarm", events[2]["name"].string_value());
+    EXPECT_EQ(1, events[2]["args"]["priority"].int_value());
+    EXPECT_EQ("E", events[3]["ph"].string_value());
+    EXPECT_EQ(events[2]["tid"].int_value(), events[3]["tid"].int_value());
+    EXPECT_EQ("M", events[4]["ph"].string_value());
+    EXPECT_EQ("timer 0x2000", events[5]["name"].string_value());
+    EXPECT_EQ(0, events[5]["tid"].int_value());
+    EXPECT_EQ("drop 0x2000", events[6]["name"].string_value());
+    EXPECT_EQ(2147483648.0 + 8, events[6]["ts"].number_value());
+}
+
+/// <summary>
+/// Tests 'traceToJson' function with invalid trace files.
+/// </summary>
+TEST(TraceConverter, traceToJson_errors)
+{
+    TraceBuilder    builder;
+    int             actor;
+
+    builder.addSymbol((void*)0x1000, "Main.alarm");
+    builder.addEvent(10, 1, &actor, (void*)0x1000);
+
+    const string    valid = builder.build();
+    const unsigned  version1 = 1;
+
+    EXPECT_NO_THROW(traceToJson(valid));
+    EXPECT_THROW(traceToJson(valid.substr(0, 8) + string((const char*)&version1, 4) + valid.substr(12)), exception);
+    EXPECT_THROW(traceToJson(""), exception);
+    EXPECT_THROW(traceToJson("PCRTRAZE" + valid.substr(8)), exception);
+    EXPECT_THROW(traceToJson(valid.substr(0, valid.size() - 1)), exception);
+
+    TraceBuilder    badType;
+
+    badType.addEvent(10, 9, &actor, (void*)0x1000);
+    EXPECT_THROW(traceToJson(badType.build()), exception);
+}
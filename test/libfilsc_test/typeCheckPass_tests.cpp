@@ -174,6 +174,54 @@ TEST(TypeCheck, ifTypeCheck)
     EXPECT_EQ(ETYPE_WRONG_IF_CONDITION_TYPE_1, r.errors[0].type());
 }
 
+/// <summary>Tests 'selectTypeCheck' function.</summary>
+TEST(TypeCheck, selectTypeCheck)
+{
+    auto check = [](const char* code) {
+        string fullCode = string("function f(a:int, b:uint8) {\n") + code + "\n}";
+        return semAnalysisCheck(fullCode.c_str());
+    };
+
+    auto r = check("const x = select (a) {1: 3; 2, 3: 4; else: 5}");
+    ASSERT_SEM_OK(r);
+    auto node = findNode(r.result, AST_SELECT);
+    EXPECT_DATATYPE_STR("int", node->getDataType());
+
+    //Without 'else' case, it has no value.
+    r = check("select (a) {1: 3; -2: 4}");
+    ASSERT_SEM_OK(r);
+    node = findNode(r.result, AST_SELECT);
+    EXPECT_DATATYPE_STR("()", node->getDataType());
+
+    r = check("select (true) {1: 3; else: 5}");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_WRONG_SELECT_TYPE_1, r.errors[0].type());
+
+    r = check("select (a) {b: 3; else: 5}");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_INVALID_CASE_VALUE_1, r.errors[0].type());
+
+    r = check("select (b) {256: 3; else: 5}");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_INVALID_CASE_VALUE_1, r.errors[0].type());
+
+    r = check("select (a) {1, 2: 3; 2: 5}");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_DUPLICATED_CASE_VALUE_1, r.errors[0].type());
+
+    //Constants initialized with integer literals are also valid case values.
+    r = check("const S1 = 1\nconst S2 = 0x10\nselect (a) {S1: 3; S2, -2: 4}");
+    ASSERT_SEM_OK(r);
+
+    r = check("const S1 = 1\nselect (a) {S1: 3; 1: 4}");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_DUPLICATED_CASE_VALUE_1, r.errors[0].type());
+
+    r = check("var v = 1\nselect (a) {v: 3; else: 5}");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_INVALID_CASE_VALUE_1, r.errors[0].type());
+}
+
 /// <summary>Tests 'returnTypeAssign' function.</summary>
 TEST(TypeCheck, returnTypeAssign)
 {
@@ -327,6 +375,40 @@ TEST(TypeCheck, binaryOpTypeCheck)
     //EXPECT_EQ(0, AstNode::nodeCount());
 }
 
+/// <summary>
+/// Tests type checking of sized integer types: promotion rules and assignment.
+/// </summary>
+TEST(TypeCheck, sizedIntTypeCheck)
+{
+    auto check = [](const string& codeFragment) {
+        return semAnalysisCheck(("function test():() {\n" + codeFragment + "\n};\n").c_str());
+    };
+
+    EXPECT_SEM_OK(check(
+        "var a:int8\n var b:uint8\n var c:int16\n var d:uint16\n var e:int32\n var f:uint32\n"
+        "a = -128; b = 255; c = a; c = b; d = b; e = d; f = d; f = 0xffffffff;\n"
+        "a = a + 1; b = b * 2; c = a + c; e = c - a; b = b << 3"
+    ));
+
+    EXPECT_SEM_ERROR(check("var a:int8 = 128"));
+    EXPECT_SEM_ERROR(check("var b:uint8 = -1"));
+    EXPECT_SEM_ERROR(check("var a:int16\n var b:int8 = a"));
+    EXPECT_SEM_ERROR(check("var a:int8\n var b:uint16 = a"));
+    EXPECT_SEM_ERROR(check("var a:uint32\n var b:int = a"));
+    EXPECT_SEM_ERROR(check("var a:int8\n var b:uint8\n a = a + b"));
+    EXPECT_SEM_ERROR(check("var a:int\n var b:uint32\n a == b"));
+
+    auto r = check("var a:uint8\n var b:int16\n const c = a + 1\n const d = a * b");
+    ASSERT_SEM_OK(r);
+
+    auto decls = findNodes(r.result, [](auto node) {
+        return node->getType() == AST_DECLARATION;
+    });
+
+    ASSERT_EQ(4, decls.size());
+    EXPECT_DATATYPE_STR("uint8", decls[2]->getDataType());
+    EXPECT_DATATYPE_STR("int16", decls[3]->getDataType());
+}
 
 /// <summary>Tests prefix operators type checking</summary>
 TEST(TypeCheck, prefixOpTypeCheck)
@@ -644,6 +726,24 @@ TEST(TypeCheck, arrayAccessTypeCheck)
     );
     ASSERT_SEM_ERROR(r);
     EXPECT_EQ(ETYPE_INVALID_ARRAY_INDEX, r.errors[0].type());
+
+    r = semAnalysisCheck(
+        "function test(){\n"
+        "  var arr[5]:int\n"
+        "  arr[5] = 1\n"
+        "}\n"
+    );
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_ARRAY_INDEX_OUT_OF_RANGE_2, r.errors[0].type());
+
+    r = semAnalysisCheck(
+        "function test(){\n"
+        "  var arr[5]:int\n"
+        "  arr[-1] = 1\n"
+        "}\n"
+    );
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_ARRAY_INDEX_OUT_OF_RANGE_2, r.errors[0].type());
 }
 
 /// <summary>
@@ -684,4 +784,52 @@ TEST(TypeCheck, tupleItemAccessTypeCheck)
     );
     ASSERT_SEM_ERROR(r);
     EXPECT_EQ(ETYPE_TUPLE_INDEX_OUT_OF_RANGE_2, r.errors[0].type());
+}
+
+/// <summary>
+/// Tests 'for' and 'for each' loops type checking.
+/// </summary>
+TEST(TypeCheck, forTypeCheck)
+{
+    auto check = [](const string& codeFragment) {
+        return semAnalysisCheck(("function test():() {\n" + codeFragment + "\n};\n").c_str());
+    };
+
+    EXPECT_SEM_OK(check(
+        "var a[8]:int\n var s = 0\n"
+        "for (var i = 0; i < 8; ++i) a[i] = i\n"
+        "for (x in a) s = s + x\n"
+        "for (;;) s = 0"
+    ));
+
+    auto r = check("for (var i = 0; i + 8; ++i) i");
+    ASSERT_SEM_ERROR(r);
+    EXPECT_EQ(ETYPE_WRONG_TYPE_2, r.errors[0].type());
+
+    EXPECT_SEM_ERROR(check("var a = 5\n for (x in a) x"));
+}
+
+/// <summary>
+/// Tests 'elementWiseOpTypeCheck' and 'assignArrayCheck' functions.
+/// </summary>
+TEST(TypeCheck, elementWiseOpTypeCheck)
+{
+    auto check = [](const string& codeFragment) {
+        return semAnalysisCheck(("function test():() {\n"
+            "var a[8]:int\n var b[8]:int\n var c[4]:int\n var d[8]:uint8\n var e[8]:int16\n"
+            + codeFragment + "\n};\n").c_str());
+    };
+
+    EXPECT_SEM_OK(check("a = b * 2; a = a + b; a = 3 - (a & b); a = b << 2"));
+    EXPECT_SEM_OK(check("d = d + 255; e = d; a = e; d = d >> a"));
+    EXPECT_SEM_OK(check("var f = a * b\n a = f"));
+
+    EXPECT_SEM_ERROR(check("a = a + c"));
+    EXPECT_SEM_ERROR(check("a = c"));
+    EXPECT_SEM_ERROR(check("a = a + d"));
+    EXPECT_SEM_ERROR(check("d = d + 256"));
+    EXPECT_SEM_ERROR(check("d = e"));
+    EXPECT_SEM_ERROR(check("a = a + true"));
+    EXPECT_SEM_ERROR(check("a < b"));
+    EXPECT_SEM_ERROR(check("a == b"));
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+/// <summary>
+/// Minimal system layer for PCR benchmarks.
+/// Implements 'system_interface.h' without timers nor real interrupts, and adds
+/// a high resolution clock to take measurements.
+/// </summary>
+/// <remarks>
+/// Benchmarks include 'pcr.c' directly, in order to be able to call the
+/// internal scheduler functions.
+/// </remarks>
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <intrin.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef __linux__
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "../../src/pcr/system_interface.h"
+
+/// <summary>
+/// Gets current time, in nanoseconds, from an arbitrary origin.
+/// </summary>
+static unsigned long long bench_now_ns()
+{
+#ifdef _WIN32
+    LARGE_INTEGER   freq;
+    LARGE_INTEGER   counter;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+
+    return (unsigned long long)(counter.QuadPart * (1000000000.0 / freq.QuadPart));
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+/// <summary>
+/// Spins for some iterations, to simulate the work done by a message handler.
+/// </summary>
+static unsigned bench_work(unsigned iterations)
+{
+    volatile unsigned   acc = 0;
+    unsigned            i;
+
+    for (i = 0; i < iterations; ++i)
+        acc += i * 7;
+
+    return acc;
+}
+
+/// <summary>
+/// Opens a hardware counter of L1 data cache read misses for the calling thread.
+/// The counter starts disabled.
+/// </summary>
+/// <returns>A counter handle, or -1 if not supported (or not allowed) on this system.</returns>
+static int bench_open_cache_counter()
+{
+#ifdef __linux__
+    struct perf_event_attr  attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_L1D
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+/// <summary>
+/// Resets and enables a cache miss counter.
+/// </summary>
+static void bench_start_counter(int counter)
+{
+#ifdef __linux__
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+/// <summary>
+/// Stops a cache miss counter, and reads its value.
+/// </summary>
+/// <returns>Counter value, or -1 if not available.</returns>
+static long long bench_stop_counter(int counter)
+{
+#ifdef __linux__
+    long long value = -1;
+
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &value, sizeof(value)) != sizeof(value))
+            value = -1;
+    }
+    return value;
+#else
+    return -1;
+#endif
+}
+
+void system_disableInterrupts()
+{
+}
+
+void system_enableInterrupts()
+{
+}
+
+void system_stop(int code)
+{
+    exit(code);
+}
+
+void system_init()
+{
+}
+
+void system_yield_CPU()
+{
+}
+
+TimerInfo* timer_getFirst()
+{
+    return NULL;
+}
+
+void timer_stop_id(int id)
+{
+}
+
+void timer_schedule(TimerInfo* timer)
+{
+}
+
+unsigned current_time()
+{
+    return (unsigned)(bench_now_ns() / 1000000);
+}
+
+unsigned current_time_us()
+{
+    return (unsigned)(bench_now_ns() / 1000);
+}
+
+unsigned long long system_cycles()
+{
+#if defined(_WIN32) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return bench_now_ns();
+#endif
+}
+
+void gpio_write(int address, int value)
+{
+    printf("o%d=%d\n", address, value);
+}
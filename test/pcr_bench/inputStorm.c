@@ -0,0 +1,123 @@
+/// <summary>
+/// Benchmark: input storm on a normal and on a conflating input.
+///
+/// A simulated interrupt posts many value changes to an input, while its handler
+/// runs. With a normal input, every stale value is queued and processed. With
+/// a conflating input, the pending message is overwritten, so the queue usage is
+/// bounded and the handler only sees the newest value.
+/// </summary>
+/// <remarks>
+/// Build & run, for example:
+///     cl /O2 inputStorm.c && inputStorm
+///     gcc -O2 -o inputStorm inputStorm.c && ./inputStorm
+/// </remarks>
+
+#define SYSTEM_QUEUE_SIZE   65536
+
+#include "../../src/pcr/pcr.c"
+#include "benchPlatform.h"
+
+#define STORM_POSTS         50      //Value changes posted during each handler execution.
+#define STORM_ROUNDS        20      //Number of storms.
+#define WORK_ITERATIONS     20000   //Work done by each handler execution.
+
+/// <summary>
+/// Benchmark actor state.
+/// </summary>
+typedef struct {
+    EndPointId          input;
+    int                 input_pending;
+    unsigned            handled;
+    unsigned            rounds;
+    int                 lastValue;
+    int                 stale;
+    int                 maxUsed;
+}Reader;
+
+static Reader   g_reader;
+static int      g_value = 0;
+
+/// <summary>
+/// Gets the number of bytes in use in the low priority queue.
+/// </summary>
+static int queueUsage()
+{
+    const SystemMsgQueue* q = &g_msgQueues[0];
+
+    if (q->readIdx < 0)
+        return 0;
+    return (q->writeIdx - q->readIdx + SYSTEM_QUEUE_SIZE) % SYSTEM_QUEUE_SIZE;
+}
+
+static void readHandler(void* actor, void* params)
+{
+    Reader*     reader = (Reader*)actor;
+    const int   value = *(const int*)params;
+    int         i;
+
+    if (value != g_value)
+        ++reader->stale;
+
+    reader->lastValue = value;
+    ++reader->handled;
+    bench_work(WORK_ITERATIONS);
+
+    if (reader->rounds < STORM_ROUNDS)
+    {
+        //Simulated interrupts.
+        ++reader->rounds;
+        for (i = 0; i < STORM_POSTS; ++i)
+        {
+            ++g_value;
+            postMessage(reader->input, &g_value, sizeof(g_value));
+        }
+
+        if (queueUsage() > reader->maxUsed)
+            reader->maxUsed = queueUsage();
+    }
+}
+
+/// <summary>
+/// Runs the benchmark, with a normal or conflating input.
+/// </summary>
+static void runBenchmark(int conflate)
+{
+    unsigned long long  t0, t1;
+    PcrInputInfo        input = { (void*)readHandler, 0, -1 };
+
+    if (conflate)
+        input.pendingOffset = offsetof(Reader, input_pending);
+
+    memset(&g_reader, 0, sizeof(g_reader));
+    g_reader.input_pending = -1;
+    g_value = 0;
+
+    initPcr();
+    g_reader.input = pcr_registerActor(&g_reader, &input, 1);
+    postMessage(g_reader.input, &g_value, sizeof(g_value));
+
+    t0 = bench_now_ns();
+    dispatchActorMessages();
+    t1 = bench_now_ns();
+
+    printf("%-10s: %6u handler calls, %6d stale values, max queue usage %6d bytes, %8.1f ms\n",
+        conflate ? "Conflating" : "Normal",
+        g_reader.handled,
+        g_reader.stale,
+        g_reader.maxUsed,
+        (t1 - t0) / 1e6);
+}
+
+void initActors()
+{
+}
+
+int main()
+{
+    printf("Storms: %d, posts per storm: %d\n", STORM_ROUNDS, STORM_POSTS);
+
+    runBenchmark(0);
+    runBenchmark(1);
+
+    return 0;
+}
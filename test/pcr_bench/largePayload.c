@@ -0,0 +1,269 @@
+/// <summary>
+/// Benchmark: posting large messages by copy ('postMessage'), built in place in the 
+/// queue ('pcr_reserveMessage') and by reference, in a pool block ('postBlockMessage').
+///
+/// A producer builds payloads of several sizes and posts them to a consumer actor, which
+/// reads the whole payload. Copied payloads are written twice (into a local structure
+/// and into the queue). Reserved payloads are written once, in the queue. Block payloads 
+/// are built in place, and only a pointer travels through the queue. Queue high water 
+/// marks are reported.
+/// The benchmark also checks that every block returns to the pool, and that a conflating
+/// input keeps only the newest message when posts alternate between pool blocks and the 
+/// queue, as the pool gets exhausted.
+/// </summary>
+/// <remarks>
+/// Build & run, for example:
+///     gcc -O2 -o largePayload largePayload.c && ./largePayload
+/// </remarks>
+
+#define SYSTEM_QUEUE_SIZE   16384
+#define PCR_BLOCK_SIZE      1024
+#define PCR_BLOCK_COUNT     16
+
+#include "../../src/pcr/pcr.c"
+#include "benchPlatform.h"
+
+#define MESSAGE_COUNT       1000000
+#define BURST               8           //Messages posted between dispatches.
+
+/// <summary>
+/// Largest benchmark payload.
+/// </summary>
+typedef struct {
+    unsigned    seq;
+    unsigned    data[PCR_BLOCK_SIZE / sizeof(unsigned) - 1];
+}Payload;
+
+/// <summary>
+/// How messages are posted.
+/// </summary>
+enum PostMode
+{
+    POST_COPY,
+    POST_RESERVE,
+    POST_BLOCK,
+    POST_MODES
+};
+
+static const char*      g_modeNames[POST_MODES] = { "copy", "reserve", "block" };
+
+static EndPointId       g_consumer;
+static unsigned         g_payloadWords;
+static unsigned         g_received;
+static unsigned         g_errors;
+static unsigned         g_checksum;
+
+static void consumerHandler(void* actor, void* params)
+{
+    const Payload*  payload = (const Payload*)params;
+    unsigned        acc = 0;
+    unsigned        i;
+
+    for (i = 0; i < g_payloadWords; ++i)
+        acc += payload->data[i];
+
+    if (payload->seq != g_received || acc != payload->seq * g_payloadWords)
+        ++g_errors;
+
+    ++g_received;
+    g_checksum += acc;
+}
+
+/// <summary>
+/// Fills a payload, as the generated code does with message parameters.
+/// </summary>
+static void fillPayload(Payload* payload, unsigned seq)
+{
+    unsigned i;
+
+    payload->seq = seq;
+    for (i = 0; i < g_payloadWords; ++i)
+        payload->data[i] = seq;
+}
+
+/// <summary>
+/// Runs the benchmark for a payload size.
+/// </summary>
+/// <param name="size">Payload size in bytes.</param>
+/// <param name="mode">How messages are posted ('PostMode').</param>
+/// <param name="highWater">Receives the maximum number of queue bytes used.</param>
+/// <returns>Messages per second.</returns>
+static double runBenchmark(unsigned size, int mode, int* highWater)
+{
+    const size_t        paramsSize = offsetof(Payload, data) + size - sizeof(unsigned);
+    unsigned long long  t0, t1;
+    unsigned            seq = 0;
+    Payload             local;
+    const PcrInputInfo  consumerInput = { (void*)consumerHandler, 0, -1 };
+
+    initPcr();
+    g_consumer = pcr_registerActor(&g_consumer, &consumerInput, 1);
+    g_payloadWords = size / sizeof(unsigned) - 1;
+    g_received = 0;
+    g_errors = 0;
+
+    t0 = bench_now_ns();
+    while (seq < MESSAGE_COUNT)
+    {
+        int i;
+
+        for (i = 0; i < BURST; ++i, ++seq)
+        {
+            if (mode == POST_BLOCK)
+            {
+                Payload* block = (Payload*)pcr_allocBlock(paramsSize);
+
+                fillPayload(block, seq);
+                postBlockMessage(g_consumer, block);
+            }
+            else if (mode == POST_RESERVE)
+            {
+                Payload* reserved = (Payload*)pcr_reserveMessage(g_consumer, paramsSize);
+
+                fillPayload(reserved, seq);
+                pcr_commitMessage(reserved);
+            }
+            else
+            {
+                fillPayload(&local, seq);
+                postMessage(g_consumer, &local, paramsSize);
+            }
+        }
+
+        dispatchActorMessages();
+    }
+    t1 = bench_now_ns();
+
+    if (g_errors != 0 || g_received != MESSAGE_COUNT)
+        printf("ERROR: %u messages received, %u corrupted\n", g_received, g_errors);
+    if (g_blocksUsed != 0)
+        printf("ERROR: %d blocks not returned to the pool\n", g_blocksUsed);
+
+    *highWater = g_msgQueues[0].highWater;
+    return MESSAGE_COUNT / ((t1 - t0) / 1e9);
+}
+
+/// <summary>
+/// Actor with a conflating input, for 'checkConflation'.
+/// </summary>
+typedef struct {
+    int         pendingIdx;
+    unsigned    received;
+    unsigned    lastSeq;
+    unsigned    errors;
+}ConflatingActor;
+
+static void conflatingHandler(void* actor, void* params)
+{
+    ConflatingActor*    self = (ConflatingActor*)actor;
+    const Payload*      payload = (const Payload*)params;
+    unsigned            i;
+
+    for (i = 0; i < g_payloadWords; ++i)
+    {
+        if (payload->data[i] != payload->seq)
+            ++self->errors;
+    }
+
+    ++self->received;
+    self->lastSeq = payload->seq;
+}
+
+/// <summary>
+/// Posts a message as the generated code does: in a pool block if there is one
+/// available, or in the queue.
+/// </summary>
+static void postConflating(EndPointId endPoint, size_t paramsSize, unsigned seq)
+{
+    Payload* params = (Payload*)pcr_reserveBlockMessage(endPoint, paramsSize);
+
+    fillPayload(params, seq);
+    pcr_commitBlockMessage(endPoint, params);
+}
+
+/// <summary>
+/// Checks a conflating input with large parameters, posted in pool blocks or in the 
+/// queue depending on the available blocks. Each batch of posts shall be delivered
+/// as a single message, with the parameters of the last one.
+/// </summary>
+/// <returns>Number of errors found.</returns>
+static int checkConflation()
+{
+    static ConflatingActor  actor;
+    const size_t            paramsSize = sizeof(Payload) / 2;
+    const PcrInputInfo      input = { (void*)conflatingHandler, 0, offsetof(ConflatingActor, pendingIdx) };
+    void*                   held[PCR_BLOCK_COUNT];
+    EndPointId              endPoint;
+    int                     errors = 0;
+    int                     i;
+
+    initPcr();
+    endPoint = pcr_registerActor(&actor, &input, 1);
+    actor.pendingIdx = -1;
+    g_payloadWords = (unsigned)(paramsSize / sizeof(unsigned)) - 1;
+
+    //Block post, replaced by a queue post once the pool is exhausted.
+    postConflating(endPoint, paramsSize, 1);
+    for (i = 0; i < PCR_BLOCK_COUNT - 1; ++i)
+        held[i] = pcr_allocBlock(paramsSize);
+    postConflating(endPoint, paramsSize, 2);
+    postConflating(endPoint, paramsSize, 3);
+    dispatchActorMessages();
+
+    errors += actor.received != 1 || actor.lastSeq != 3;
+    errors += g_blocksUsed != PCR_BLOCK_COUNT - 1;
+
+    //Queue post, replaced by a block post once a block is released.
+    postConflating(endPoint, paramsSize, 4);
+    pcr_freeBlock(held[--i]);
+    postConflating(endPoint, paramsSize, 5);
+    dispatchActorMessages();
+
+    errors += actor.received != 2 || actor.lastSeq != 5;
+    errors += g_blocksUsed != PCR_BLOCK_COUNT - 2;
+
+    while (i > 0)
+        pcr_freeBlock(held[--i]);
+
+    errors += actor.errors != 0 || g_blocksUsed != 0;
+    errors += g_msgQueues[0].readIdx >= 0;
+
+    if (errors != 0)
+        printf("ERROR: conflating input with block and queue posts: %d errors\n", errors);
+
+    return errors;
+}
+
+void initActors()
+{
+}
+
+int main()
+{
+    static const unsigned   sizes[] = { 16, 64, 128, 256, 512, 1024 };
+    int                     i, mode;
+
+    if (checkConflation() != 0)
+        return 1;
+
+    printf("Messages: %d, burst: %d, queue: %d bytes\n", MESSAGE_COUNT, BURST, SYSTEM_QUEUE_SIZE);
+    printf("%8s", "bytes");
+    for (mode = 0; mode < POST_MODES; ++mode)
+        printf("  %8s msg/s  queue", g_modeNames[mode]);
+    printf("\n");
+
+    for (i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); ++i)
+    {
+        printf("%8u", sizes[i]);
+        for (mode = 0; mode < POST_MODES; ++mode)
+        {
+            int             highWater;
+            const double    rate = runBenchmark(sizes[i], mode, &highWater);
+
+            printf("  %14.0f  %5d", rate, highWater);
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
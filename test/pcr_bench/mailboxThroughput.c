@@ -0,0 +1,113 @@
+/// <summary>
+/// Benchmark: dispatch throughput and data cache misses, with a single shared
+/// queue and with per-actor mailboxes.
+///
+/// Several actors, whose states together do not fit in L1 data cache, receive
+/// messages interleaved in the queue. Each message handler touches every cache
+/// line of its actor state (in an order which defeats hardware prefetching) and
+/// posts a new message to the same actor, to keep the load.
+/// </summary>
+/// <remarks>
+/// The dispatch mode is selected at compile time. Build & run both, for example:
+///     gcc -O2 -o mbQueue mailboxThroughput.c && ./mbQueue
+///     gcc -O2 -DPCR_ACTOR_MAILBOXES -o mbMailbox mailboxThroughput.c && ./mbMailbox
+/// Cache misses are read from Linux performance counters. They may require
+/// 'kernel.perf_event_paranoid' to be 2 or lower.
+/// </remarks>
+
+#define SYSTEM_QUEUE_SIZE   16384
+
+#include "../../src/pcr/pcr.c"
+#include "benchPlatform.h"
+
+#define ACTOR_COUNT         16
+#define CACHE_LINE_WORDS    16
+#define ACTOR_STATE_LINES   128
+#define ACTOR_STATE_WORDS   (ACTOR_STATE_LINES * CACHE_LINE_WORDS)   //8 Kb of state per actor.
+#define MESSAGES_PER_ACTOR  8           //Messages kept in the queue for each actor.
+#define MESSAGE_COUNT       2000000
+
+/// <summary>
+/// Benchmark actor state.
+/// </summary>
+typedef struct {
+    EndPointId          input;
+    unsigned            state[ACTOR_STATE_WORDS];
+}Worker;
+
+static Worker   g_workers[ACTOR_COUNT];
+static unsigned g_posted = 0;
+static unsigned g_checksum = 0;
+
+static void workHandler(void* actor, void* params)
+{
+    Worker*     worker = (Worker*)actor;
+    unsigned    acc = 0;
+    int         i;
+
+    //37 is coprime with the number of lines, so all of them are visited.
+    for (i = 0; i < ACTOR_STATE_LINES; ++i)
+        acc += worker->state[((i * 37) % ACTOR_STATE_LINES) * CACHE_LINE_WORDS]++;
+
+    g_checksum += acc;
+
+    if (g_posted < MESSAGE_COUNT)
+    {
+        ++g_posted;
+        postMessage(worker->input, NULL, 0);
+    }
+}
+
+void initActors()
+{
+    static const PcrInputInfo   input = { (void*)workHandler, 0, -1 };
+    int                         i;
+
+    for (i = 0; i < ACTOR_COUNT; ++i)
+        g_workers[i].input = pcr_registerActor(&g_workers[i], &input, 1);
+}
+
+int main()
+{
+    int                 counter = bench_open_cache_counter();
+    int                 i, j;
+    unsigned long long  t0, t1;
+    long long           misses;
+    int                 dispatched;
+
+    initPcr();
+
+    //Interleaved initial load.
+    for (i = 0; i < MESSAGES_PER_ACTOR; ++i)
+    {
+        for (j = 0; j < ACTOR_COUNT; ++j)
+        {
+            ++g_posted;
+            postMessage(g_workers[j].input, NULL, 0);
+        }
+    }
+
+    bench_start_counter(counter);
+    t0 = bench_now_ns();
+    dispatched = dispatchActorMessages();
+    t1 = bench_now_ns();
+    misses = bench_stop_counter(counter);
+
+#ifdef PCR_ACTOR_MAILBOXES
+    printf("Mode: actor mailboxes (batch: %d)\n", PCR_MAILBOX_BATCH);
+#else
+    printf("Mode: single queue\n");
+#endif
+    printf("Actors: %d, state: %d bytes, messages: %d (checksum %u)\n",
+        ACTOR_COUNT, (int)sizeof(g_workers[0].state), dispatched, g_checksum);
+    printf("Throughput: %.0f messages/s, %.1f ns/message\n",
+        dispatched * 1e9 / (t1 - t0),
+        (double)(t1 - t0) / dispatched);
+
+    if (misses >= 0)
+        printf("L1D read misses: %lld, %.1f per message\n", misses, (double)misses / dispatched);
+    else
+        printf("L1D read misses: not available\n");
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/// <summary>
+/// Benchmark: worst-case dispatch latency of a high priority input under load.
+///
+/// A 'worker' actor keeps the low priority queue always loaded with messages.
+/// At the beginning of some of its messages, an 'alarm' message is posted (as
+/// an interrupt service routine would do). The time between the alarm post and
+/// the start of the alarm handler is measured.
+///
+/// The test is run twice: with the alarm at the same priority than the load
+/// (the behaviour of a single FIFO queue), and with the alarm at the highest priority.
+/// </summary>
+/// <remarks>
+/// Build & run, for example:
+///     cl /O2 priorityLatency.c && priorityLatency
+///     gcc -O2 -o priorityLatency priorityLatency.c && ./priorityLatency
+/// </remarks>
+
+#define SYSTEM_QUEUE_SIZE   2048
+
+#include "../../src/pcr/pcr.c"
+#include "benchPlatform.h"
+
+#define LOAD_MESSAGES       12      //Low priority messages kept in the queue.
+#define WORK_ITERATIONS     20000   //Work done by each low priority message.
+#define ALARM_PERIOD        50      //Low priority messages between alarms.
+#define ALARM_COUNT         200     //Number of alarms measured on each run.
+
+/// <summary>
+/// Parameters of the alarm message.
+/// </summary>
+typedef struct {
+    unsigned long long  postTime;
+    unsigned            postCount;
+}AlarmParams;
+
+/// <summary>
+/// Benchmark actor state.
+/// </summary>
+typedef struct {
+    EndPointId          workInput;     //'alarmInput' follows it.
+    EndPointId          alarmInput;
+    unsigned            processed;
+    unsigned            alarms;
+    unsigned long long  maxLatency;
+    unsigned long long  totalLatency;
+    unsigned            maxMsgsWaited;
+}Worker;
+
+static void workHandler(void* actor, void* params)
+{
+    Worker* worker = (Worker*)actor;
+
+    if (worker->alarms >= ALARM_COUNT)
+        return;
+
+    //Simulated interrupt.
+    if (worker->processed % ALARM_PERIOD == 0)
+    {
+        AlarmParams alarm;
+
+        alarm.postTime = bench_now_ns();
+        alarm.postCount = worker->processed;
+        postMessage(worker->alarmInput, &alarm, sizeof(alarm));
+    }
+
+    bench_work(WORK_ITERATIONS);
+    ++worker->processed;
+
+    //Keep the queue loaded.
+    postMessage(worker->workInput, NULL, 0);
+}
+
+static void alarmHandler(void* actor, void* params)
+{
+    Worker*             worker = (Worker*)actor;
+    const AlarmParams*  alarm = (const AlarmParams*)params;
+    unsigned long long  latency = bench_now_ns() - alarm->postTime;
+    unsigned            waited = worker->processed - alarm->postCount;
+
+    if (latency > worker->maxLatency)
+        worker->maxLatency = latency;
+    if (waited > worker->maxMsgsWaited)
+        worker->maxMsgsWaited = waited;
+
+    worker->totalLatency += latency;
+    ++worker->alarms;
+}
+
+/// <summary>
+/// Runs the benchmark with the given priority for the alarm input.
+/// </summary>
+static void runBenchmark(int alarmPriority)
+{
+    static Worker   worker;
+    PcrInputInfo    inputs[] = {
+        { (void*)workHandler, 0, -1 },
+        { (void*)alarmHandler, alarmPriority, -1 }
+    };
+    int             i;
+
+    memset(&worker, 0, sizeof(worker));
+
+    initPcr();
+    worker.workInput = pcr_registerActor(&worker, inputs, 2);
+    worker.alarmInput = worker.workInput + 1;
+    for (i = 0; i < LOAD_MESSAGES; ++i)
+        postMessage(worker.workInput, NULL, 0);
+
+    //It returns when the worker stops posting messages.
+    dispatchActorMessages();
+
+    printf("Alarm priority %d: max latency %8.1f us, avg latency %8.1f us, max messages waited %u\n",
+        alarmPriority,
+        worker.maxLatency / 1000.0,
+        worker.totalLatency / 1000.0 / worker.alarms,
+        worker.maxMsgsWaited);
+}
+
+void initActors()
+{
+}
+
+int main()
+{
+    printf("Load: %d messages. Priority levels: %d\n", LOAD_MESSAGES, PCR_PRIORITY_LEVELS);
+
+    runBenchmark(0);
+    runBenchmark(PCR_PRIORITY_LEVELS - 1);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/// <summary>
+/// Benchmark: queue overflow policies and telemetry.
+///
+/// A 'burst' of messages, bigger than the queue, is posted at once (as a storm
+/// of interrupts would do) with each overflow policy. The number of delivered and
+/// dropped messages, the delivered sequence range and the queue high water mark 
+/// are reported.
+/// </summary>
+/// <remarks>
+/// Build & run, for example:
+///     cl /O2 /DPCR_TELEMETRY queueOverflow.c && queueOverflow
+///     gcc -O2 -DPCR_TELEMETRY -o queueOverflow queueOverflow.c && ./queueOverflow
+/// </remarks>
+
+#define SYSTEM_QUEUE_SIZE   1024
+#define PCR_BLOCK_RETRIES   10
+
+#include "../../src/pcr/pcr.c"
+#include "benchPlatform.h"
+
+#define BURST_SIZE          100     //Messages posted on each burst.
+
+/// <summary>
+/// Benchmark actor state.
+/// </summary>
+typedef struct {
+    EndPointId          input;
+    int                 received;
+    int                 first;
+    int                 last;
+}Sink;
+
+static Sink     g_sink;
+
+static void sinkHandler(void* actor, void* params)
+{
+    Sink*       sink = (Sink*)actor;
+    const int   seq = *(const int*)params;
+
+    if (sink->received++ == 0)
+        sink->first = seq;
+    sink->last = seq;
+}
+
+/// <summary>
+/// Runs the benchmark with the given overflow policy.
+/// </summary>
+static void runBenchmark(int policy, const char* name)
+{
+    static const PcrInputInfo   input = { (void*)sinkHandler, 0, -1 };
+    int                         i;
+
+    memset(&g_sink, 0, sizeof(g_sink));
+
+    initPcr();
+    g_sink.input = pcr_registerActor(&g_sink, &input, 1);
+    g_overflowPolicy = policy;
+
+    for (i = 0; i < BURST_SIZE; ++i)
+        postMessage(g_sink.input, &i, sizeof(i));
+
+    dispatchActorMessages();
+
+    printf("%-12s: delivered %3d (sequence %2d..%2d), dropped %3u, high water %4d bytes\n",
+        name,
+        g_sink.received,
+        g_sink.first,
+        g_sink.last,
+        g_msgQueues[0].dropped,
+        g_msgQueues[0].highWater);
+}
+
+void initActors()
+{
+}
+
+int main()
+{
+    printf("Queue size: %d bytes, burst: %d messages\n", SYSTEM_QUEUE_SIZE, BURST_SIZE);
+
+    runBenchmark(PCR_OVERFLOW_DROP_NEWEST, "drop newest");
+    runBenchmark(PCR_OVERFLOW_DROP_OLDEST, "drop oldest");
+    runBenchmark(PCR_OVERFLOW_BLOCK, "block");
+
+    pcr_dumpTelemetry();
+
+    return 0;
+}
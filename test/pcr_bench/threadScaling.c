@@ -0,0 +1,139 @@
+/// <summary>
+/// Benchmark: threaded scheduler scaling over actor counts and worker threads.
+///
+/// Each actor runs a chain of messages: its handler does some work and posts the
+/// next message to itself, with a sequence number. The total number of messages is
+/// the same in all runs. With a single actor, the chain is serial, so adding workers
+/// cannot help. With more actors than workers, throughput should grow with the number
+/// of cores.
+/// The benchmark also checks that messages of an actor are dispatched in order, and
+/// that its handler never runs in two workers at the same time.
+/// </summary>
+/// <remarks>
+/// Linux (POSIX threads) only. Build & run, for example:
+///     gcc -O2 -pthread -DPCR_THREADS -DPCR_WORKERS=16 -o threadScaling threadScaling.c && ./threadScaling
+/// </remarks>
+
+#ifndef PCR_THREADS
+#error "Build this benchmark with -DPCR_THREADS"
+#endif
+
+#define PCR_MAX_ACTORS      256
+
+#include "../../src/pcr/pcr.c"
+#include "benchPlatform.h"
+
+#include <unistd.h>
+
+#define MAX_BENCH_ACTORS    64
+#define TOTAL_MESSAGES      400000
+#define WORK_ITERATIONS     2000        //Work done by each message handler.
+
+/// <summary>
+/// Benchmark actor state.
+/// </summary>
+typedef struct {
+    EndPointId          input;
+    int                 running;        //Set while the handler runs.
+    unsigned            received;
+    unsigned            target;
+    unsigned            outOfOrder;
+    unsigned            overlaps;
+}ChainActor;
+
+static ChainActor   g_actors[MAX_BENCH_ACTORS];
+static int          g_activeChains = 0;
+
+static void chainHandler(void* actor, void* params)
+{
+    ChainActor*     chain = (ChainActor*)actor;
+    const unsigned  seq = *(const unsigned*)params;
+    unsigned        next;
+
+    if (__atomic_exchange_n(&chain->running, 1, __ATOMIC_ACQUIRE) != 0)
+        __atomic_add_fetch(&chain->overlaps, 1, __ATOMIC_RELAXED);
+
+    if (seq != chain->received)
+        ++chain->outOfOrder;
+    ++chain->received;
+
+    bench_work(WORK_ITERATIONS);
+
+    next = chain->received;
+    __atomic_store_n(&chain->running, 0, __ATOMIC_RELEASE);
+
+    if (next < chain->target)
+        postMessage(chain->input, &next, sizeof(next));
+    else if (__atomic_sub_fetch(&g_activeChains, 1, __ATOMIC_ACQ_REL) == 0)
+        stopWorkers();
+}
+
+/// <summary>
+/// Runs the benchmark with the given number of actors and workers.
+/// </summary>
+/// <returns>Messages per second.</returns>
+static double runBenchmark(int actorCount, int workerCount)
+{
+    unsigned long long  t0, t1;
+    unsigned            outOfOrder = 0;
+    unsigned            overlaps = 0;
+    unsigned            zero = 0;
+    const PcrInputInfo  input = { (void*)chainHandler, 0, -1 };
+    int                 i;
+
+    g_workerCount = workerCount;
+    initPcr();
+
+    memset(g_actors, 0, sizeof(g_actors));
+    g_activeChains = actorCount;
+
+    for (i = 0; i < actorCount; ++i)
+    {
+        g_actors[i].input = pcr_registerActor(&g_actors[i], &input, 1);
+        g_actors[i].target = TOTAL_MESSAGES / actorCount;
+        postMessage(g_actors[i].input, &zero, sizeof(zero));
+    }
+
+    t0 = bench_now_ns();
+    runWorkers();
+    t1 = bench_now_ns();
+
+    for (i = 0; i < actorCount; ++i)
+    {
+        outOfOrder += g_actors[i].outOfOrder;
+        overlaps += g_actors[i].overlaps;
+    }
+
+    if (outOfOrder != 0 || overlaps != 0)
+        printf("ERROR: %u messages out of order, %u concurrent handler executions\n", outOfOrder, overlaps);
+
+    return (TOTAL_MESSAGES / actorCount) * (double)actorCount / ((t1 - t0) / 1e9);
+}
+
+void initActors()
+{
+}
+
+int main()
+{
+    static const int    actorCounts[] = { 1, 4, 16, 64 };
+    const int           cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int                 a, w;
+
+    printf("Cores: %d, max workers: %d, messages: %d, work per message: %d iterations\n",
+        cores, PCR_WORKERS, TOTAL_MESSAGES, WORK_ITERATIONS);
+    printf("%8s", "actors");
+    for (w = 1; w <= PCR_WORKERS; w *= 2)
+        printf("  %6d wk", w);
+    printf("   (messages / s)\n");
+
+    for (a = 0; a < (int)(sizeof(actorCounts) / sizeof(actorCounts[0])); ++a)
+    {
+        printf("%8d", actorCounts[a]);
+        for (w = 1; w <= PCR_WORKERS; w *= 2)
+            printf("  %9.0f", runBenchmark(actorCounts[a], w));
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+/// <summary>
+/// Benchmark: cost of runtime tracing.
+///
+/// An actor posts a message to itself, with an empty handler, so the time per
+/// message is mostly scheduler overhead. Each message records 3 trace events
+/// (post, dispatch start and dispatch end).
+/// </summary>
+/// <remarks>
+/// Build & run with and without tracing, for example:
+///     gcc -O2 -o traceOff traceOverhead.c && ./traceOff
+///     gcc -O2 -DPCR_TRACE -o traceOn traceOverhead.c && ./traceOn
+/// With tracing, the last events are written to 'pcr_trace.bin', which can be
+/// converted with 'filsc --trace2json pcr_trace.bin trace.json'.
+/// </remarks>
+
+#include "../../src/pcr/pcr.c"
+#include "benchPlatform.h"
+
+#define MESSAGE_COUNT       5000000
+
+/// <summary>
+/// Benchmark actor state.
+/// </summary>
+typedef struct {
+    EndPointId          input;
+    unsigned            count;
+}Looper;
+
+static Looper   g_looper;
+
+static void loopHandler(void* actor, void* params)
+{
+    Looper* looper = (Looper*)actor;
+
+    if (++looper->count < MESSAGE_COUNT)
+        postMessage(looper->input, NULL, 0);
+}
+
+#ifdef PCR_TRACE
+const PcrTraceSymbol pcr_traceSymbols[] = {
+    { (void*)loopHandler, "Looper.loop" },
+    { NULL, NULL }
+};
+#endif
+
+void initActors()
+{
+    static const PcrInputInfo   input = { (void*)loopHandler, 0, -1 };
+
+    g_looper.input = pcr_registerActor(&g_looper, &input, 1);
+    postMessage(g_looper.input, NULL, 0);
+}
+
+int main()
+{
+    unsigned long long  t0, t1;
+    int                 dispatched;
+
+    initPcr();
+
+    t0 = bench_now_ns();
+    dispatched = dispatchActorMessages();
+    t1 = bench_now_ns();
+
+#ifdef PCR_TRACE
+    printf("Tracing: on (%d events ring)\n", PCR_TRACE_EVENTS);
+    pcr_writeTrace();
+#else
+    printf("Tracing: off\n");
+#endif
+    printf("Messages: %d, %.1f ns/message\n", dispatched, (double)(t1 - t0) / dispatched);
+
+    return 0;
+}
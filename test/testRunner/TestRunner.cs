@@ -148,8 +148,10 @@ namespace testRunner
         /// </summary>
         /// <param name="exePath"></param>
         /// <param name="args"></param>
+        /// <param name="virtualTime">Run the process in virtual time mode (timers expire
+        /// without waiting for them).</param>
         /// <returns></returns>
-        private static ProcessResult launchProcess(string exePath, string args)
+        private static ProcessResult launchProcess(string exePath, string args, bool virtualTime = false)
         {
             var result = new ProcessResult();
             try
@@ -158,6 +160,8 @@ namespace testRunner
 
                 pi.RedirectStandardOutput = true;
                 pi.UseShellExecute = false;
+                if (virtualTime)
+                    pi.EnvironmentVariables["FILS_VIRTUAL_TIME"] = "1";
 
                 var proc = Process.Start(pi);
 
@@ -185,7 +189,7 @@ namespace testRunner
             string name = Path.GetFileName(path);
             string exePath = Path.Combine(path, "bin\\" + name + ".exe");
 
-            var result = launchProcess(exePath, "");
+            var result = launchProcess(exePath, "", true);
 
             if (!result.launched)
             {